@@ -1,10 +1,10 @@
 #pragma once
 
-#include <bits/stdc++.h>
-using namespace std;
+#include "../graphs/scc.hpp"
 
 /**
  * Solve 2-SAT in linear time and find strongly connected components.
+ * A variable is true if its true literal comes later in topological order.
  *
  * Complexity: O(N)
  * Reference: kactl
@@ -39,52 +39,14 @@ struct twosat_scc {
 
     void set(int u) { either(u, u); }
 
-    vector<int> index, lowlink;
-    vector<bool> onstack;
-    stack<int> S;
-    int depth;
-
-    void tarjan(int u) {
-        index[u] = lowlink[u] = depth++;
-        S.push(u), onstack[u] = true;
-
-        for (int v : adj[u]) {
-            if (!index[v]) {
-                tarjan(v);
-                lowlink[u] = min(lowlink[u], lowlink[v]);
-            } else if (onstack[v]) {
-                lowlink[u] = min(lowlink[u], index[v]);
-            }
-        }
-
-        if (index[u] == lowlink[u]) {
-            int v, c = C++;
-            do {
-                v = S.top(), S.pop(), onstack[v] = false;
-                cmap[v] = c;
-                if (assignment[v >> 1] == -1)
-                    assignment[v >> 1] = v & 1;
-            } while (u != v);
-        }
-    }
-
     bool solve() {
+        auto scc = build_scc(adj); // components in reverse topological order
+        C = scc.C, cmap = move(scc.cmap);
         assignment.assign(N, -1);
-        cmap.assign(2 * N, 0);
-        index.assign(2 * N, 0);
-        lowlink.assign(2 * N, 0);
-        onstack.assign(2 * N, false);
-        S = stack<int>();
-        depth = 1, C = 0;
-
-        for (int u = 0; u < 2 * N; u++) {
-            if (!index[u])
-                tarjan(u);
-        }
         for (int u = 0; u < N; u++) {
-            assert(assignment[u] >= 0);
             if (cmap[2 * u] == cmap[2 * u + 1])
                 return false;
+            assignment[u] = cmap[2 * u + 1] < cmap[2 * u];
         }
         return true;
     }
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "flow_network.hpp"
+
+/**
+ * Boykov-Kolmogorov search trees, shared by bk_flow and bk_grid_flow
+ * A source tree and a sink tree are grown over the residual network. When they touch
+ * the path is augmented, the nodes cut off from their tree become orphans and look for
+ * a new parent in the same tree, so both trees are reused across augmentations.
+ * Terminal residuals are kept per node in tr[u]: >0 is residual from s, <0 residual to t.
+ * Arcs provides the arc range [first(u),last(u)), head(a), rev(a) and res(a).
+ * Complexity: O(V^2 E |f|), much faster than that on vision-like grids
+ */
+template <typename Flow, typename FlowSum, typename Arcs>
+struct boykov_kolmogorov {
+    static constexpr int TERMINAL = -1, ORPHAN = -2, NONE = -3;
+    enum Tree : int8_t { FREE, SOURCE, SINK };
+
+    int V;
+    Arcs g;
+    vector<FlowSum> tr;
+    vector<Tree> tree;
+    vector<int> parent, next, ts, dist, orphans; // parent[u] is the arc u->parent
+    int qhead = -1, qtail = -1, TIME = 0;
+
+    boykov_kolmogorov(int V, Arcs g) : V(V), g(move(g)), tr(V) {}
+
+    void activate(int u) {
+        if (next[u] == -1) {
+            next[u] = u; // the tail of the queue points to itself
+            (qtail == -1 ? qhead : next[qtail]) = u;
+            qtail = u;
+        }
+    }
+
+    int next_active() {
+        while (qhead != -1) {
+            int u = qhead;
+            qhead = next[u] == u ? -1 : next[u];
+            qtail = qhead == -1 ? -1 : qtail;
+            next[u] = -1;
+            if (tree[u] != FREE) {
+                return u;
+            }
+        }
+        return -1;
+    }
+
+    void make_orphan(int u) { parent[u] = ORPHAN, orphans.push_back(u); }
+
+    void push(int a, FlowSum df) { g.res(a) -= df, g.res(g.rev(a)) += df; }
+
+    // Grow the tree of p by one layer, returns an arc source tree -> sink tree or -1
+    int grow(int p) {
+        for (int a = g.first(p), end = g.last(p); a < end; a++) {
+            int r = tree[p] == SOURCE ? a : g.rev(a);
+            if (g.res(r) == 0) {
+                continue;
+            }
+            int q = g.head(a);
+            if (tree[q] == FREE) {
+                tree[q] = tree[p], parent[q] = g.rev(a);
+                ts[q] = ts[p], dist[q] = dist[p] + 1;
+                activate(q);
+            } else if (tree[q] != tree[p]) {
+                return r;
+            } else if (ts[q] <= ts[p] && dist[q] > dist[p]) {
+                parent[q] = g.rev(a), ts[q] = ts[p], dist[q] = dist[p] + 1;
+            }
+        }
+        return -1;
+    }
+
+    FlowSum augment(int m) {
+        int x = g.head(g.rev(m)), y = g.head(m), u;
+        FlowSum df = g.res(m);
+        for (u = x; parent[u] != TERMINAL; u = g.head(parent[u])) {
+            df = min(df, FlowSum(g.res(g.rev(parent[u]))));
+        }
+        df = min(df, tr[u]);
+        for (u = y; parent[u] != TERMINAL; u = g.head(parent[u])) {
+            df = min(df, FlowSum(g.res(parent[u])));
+        }
+        df = min(df, -tr[u]);
+
+        push(m, df);
+        for (u = x; parent[u] != TERMINAL;) {
+            int a = parent[u], w = g.head(a);
+            push(g.rev(a), df);
+            if (g.res(g.rev(a)) == 0) {
+                make_orphan(u);
+            }
+            u = w;
+        }
+        if ((tr[u] -= df) == 0) {
+            make_orphan(u);
+        }
+        for (u = y; parent[u] != TERMINAL;) {
+            int a = parent[u], w = g.head(a);
+            push(a, df);
+            if (g.res(a) == 0) {
+                make_orphan(u);
+            }
+            u = w;
+        }
+        if ((tr[u] += df) == 0) {
+            make_orphan(u);
+        }
+        return df;
+    }
+
+    // Distance from q to its terminal through valid parents, caching it with TIME
+    int trace(int q) {
+        int d = 0, j = q;
+        while (true) {
+            if (ts[j] == TIME) {
+                d += dist[j];
+                break;
+            }
+            int pa = parent[j];
+            d++;
+            if (pa == TERMINAL) {
+                ts[j] = TIME, dist[j] = 1;
+                break;
+            } else if (pa == ORPHAN) {
+                return INT_MAX;
+            }
+            j = g.head(pa);
+        }
+        for (int k = q, e = d; ts[k] != TIME; k = g.head(parent[k])) {
+            ts[k] = TIME, dist[k] = e--;
+        }
+        return d;
+    }
+
+    void adopt(int p) {
+        Tree side = tree[p];
+        int best = NONE, dmin = INT_MAX;
+        for (int a = g.first(p), end = g.last(p); a < end; a++) {
+            int q = g.head(a);
+            if (tree[q] == side && g.res(side == SOURCE ? g.rev(a) : a) > 0) {
+                if (int d = trace(q); d < dmin) {
+                    best = a, dmin = d;
+                }
+            }
+        }
+        if (best != NONE) {
+            parent[p] = best, ts[p] = TIME, dist[p] = dmin + 1;
+            return;
+        }
+        for (int a = g.first(p), end = g.last(p); a < end; a++) {
+            int q = g.head(a);
+            if (tree[q] == side) {
+                if (g.res(side == SOURCE ? g.rev(a) : a) > 0) {
+                    activate(q);
+                }
+                if (parent[q] >= 0 && g.head(parent[q]) == p) {
+                    make_orphan(q);
+                }
+            }
+        }
+        tree[p] = FREE, parent[p] = NONE;
+    }
+
+    FlowSum run() {
+        tree.assign(V, FREE), parent.assign(V, NONE), next.assign(V, -1);
+        ts.assign(V, 0), dist.assign(V, 0);
+        qhead = qtail = -1, TIME = 0;
+        for (int u = 0; u < V; u++) {
+            if (tr[u] != 0) {
+                tree[u] = tr[u] > 0 ? SOURCE : SINK, parent[u] = TERMINAL, dist[u] = 1;
+                activate(u);
+            }
+        }
+        FlowSum flow = 0;
+        for (int p = -1;;) {
+            if ((p == -1 || tree[p] == FREE) && (p = next_active()) == -1) {
+                break;
+            }
+            int m = grow(p);
+            if (m == -1) {
+                p = -1;
+                continue;
+            }
+            TIME++;
+            flow += augment(m);
+            for (int i = 0; i < int(orphans.size()); i++) {
+                adopt(orphans[i]);
+            }
+            orphans.clear();
+        }
+        return flow;
+    }
+};
+
+/**
+ * Boykov-Kolmogorov max flow on a general network, same interface as dinitz_flow
+ * The arcs of s and t are folded into the terminal residuals for the search and written
+ * back afterwards, so the terminals are never scanned.
+ * Best on the low diameter, short path instances of computer vision.
+ */
+template <typename Flow = long, typename FlowSum = Flow>
+struct bk_flow {
+    struct csr_arcs {
+        flow_network<Flow>* net;
+        int first(int u) const { return net->off[u]; }
+        int last(int u) const { return net->off[u + 1]; }
+        int head(int a) const { return net->head[a]; }
+        int rev(int a) const { return net->rev[a]; }
+        Flow& res(int a) { return net->res[a]; }
+    };
+
+    int V, s = -1, t = -1;
+    flow_network<Flow> net;
+    boykov_kolmogorov<Flow, FlowSum, csr_arcs> bk;
+
+    explicit bk_flow(int V) : V(V), net(V), bk(V, csr_arcs{nullptr}) {}
+
+    int add(int u, int v, Flow capacity) { return net.add(u, v, capacity); }
+
+    FlowSum maxflow(int source, int sink) {
+        assert(source != sink);
+        s = source, t = sink;
+        net.freeze();
+        bk.g.net = &net;
+        auto &off = net.off, &head = net.head, &rev = net.rev;
+        auto& res = net.res;
+
+        FlowSum flow = 0;
+        vector<FlowSum> src(V), snk(V);
+        vector<pair<int, Flow>> saved;
+        for (int a = off[s]; a < off[s + 1]; a++) {
+            if (head[a] == t) {
+                flow += res[a], res[rev[a]] += res[a], res[a] = 0;
+            } else if (head[a] != s) {
+                src[head[a]] += res[a];
+            }
+        }
+        for (int b = off[t]; b < off[t + 1]; b++) {
+            if (head[b] != s && head[b] != t) {
+                snk[head[b]] += res[rev[b]];
+            }
+        }
+        for (int u : {s, t}) {
+            for (int a = off[u]; a < off[u + 1]; a++) {
+                saved.push_back({a, res[a]}), saved.push_back({rev[a], res[rev[a]]});
+                res[a] = res[rev[a]] = 0;
+            }
+        }
+        for (int v = 0; v < V; v++) {
+            flow += min(src[v], snk[v]), bk.tr[v] = src[v] - snk[v];
+        }
+
+        flow += bk.run();
+
+        // terminal flows: the terminal side with residual left is not saturated
+        for (auto it = saved.rbegin(); it != saved.rend(); it++) {
+            res[it->first] = it->second;
+        }
+        for (int v = 0; v < V; v++) {
+            FlowSum left = bk.tr[v];
+            src[v] -= max(left, FlowSum(0)), snk[v] -= max(-left, FlowSum(0));
+        }
+        for (int a = off[s]; a < off[s + 1]; a++) {
+            if (int v = head[a]; v != s && v != t) {
+                Flow df = min(src[v], FlowSum(res[a]));
+                res[a] -= df, res[rev[a]] += df, src[v] -= df;
+            }
+        }
+        for (int b = off[t]; b < off[t + 1]; b++) {
+            if (int v = head[b]; v != s && v != t) {
+                Flow df = min(snk[v], FlowSum(res[rev[b]]));
+                res[rev[b]] -= df, res[b] += df, snk[v] -= df;
+            }
+        }
+        return flow;
+    }
+
+    Flow get_flow(int e) const { return net.get_flow(e); }
+    bool left_of_mincut(int u) const {
+        return u == s || (u != t && bk.tree[u] == bk.SOURCE);
+    }
+};
+
+/**
+ * Boykov-Kolmogorov max flow on an implicit XxYxZ grid (Z=1 for 2D), nodes numbered like
+ * calc_grid3(). Only the 4/6 neighbour arcs exist and they are found by arithmetic on a
+ * grid padded with a ring of dead nodes, so no adjacency is stored: the network is the
+ * residual array, 2^k slots per node. Terminal arcs are added with add_source/add_sink.
+ */
+template <typename Flow = long, typename FlowSum = Flow>
+struct bk_grid_flow {
+    struct grid_arcs {
+        int shift, K;
+        array<int, 8> delta = {};
+        vector<Flow> r;
+        int first(int u) const { return u << shift; }
+        int last(int u) const { return (u << shift) + K; }
+        int head(int a) const { return (a >> shift) + delta[a & ((1 << shift) - 1)]; }
+        int rev(int a) const { return head(a) << shift | ((a & ((1 << shift) - 1)) ^ 1); }
+        Flow& res(int a) { return r[a]; }
+    };
+
+    int X, Y, Z, PX, PY, PZ;
+    FlowSum direct = 0; // flow through a single node s->u->t
+    boykov_kolmogorov<Flow, FlowSum, grid_arcs> bk;
+
+    bk_grid_flow(int X, int Y, int Z = 1)
+        : X(X), Y(Y), Z(Z), PX(X + 2), PY(Y + 2), PZ(Z > 1 ? Z + 2 : 1),
+          bk(PX * PY * PZ, make_arcs()) {}
+
+    grid_arcs make_arcs() const {
+        int shift = Z > 1 ? 3 : 2, K = Z > 1 ? 6 : 4;
+        return grid_arcs{shift, K, {1, -1, PX, -PX, PX * PY, -PX * PY, 0, 0},
+                         vector<Flow>(size_t(PX) * PY * PZ << shift)};
+    }
+
+    int pad(int u) const {
+        int x = u % X, y = u / X % Y, z = u / X / Y;
+        return (x + 1) + PX * ((y + 1) + PY * (z + (Z > 1)));
+    }
+
+    // v must be a grid neighbour of u
+    void add(int u, int v, Flow capacity) {
+        int pu = pad(u), pv = pad(v);
+        for (int d = 0; d < bk.g.K; d++) {
+            if (pu + bk.g.delta[d] == pv) {
+                bk.g.r[(pu << bk.g.shift) + d] += capacity;
+                return;
+            }
+        }
+        assert(false && "not a grid neighbour");
+    }
+
+    void add_source(int u, Flow capacity) {
+        FlowSum& tr = bk.tr[pad(u)];
+        direct += max(min(FlowSum(capacity), -tr), FlowSum(0)), tr += capacity;
+    }
+
+    void add_sink(int u, Flow capacity) {
+        FlowSum& tr = bk.tr[pad(u)];
+        direct += max(min(FlowSum(capacity), tr), FlowSum(0)), tr -= capacity;
+    }
+
+    FlowSum maxflow() { return direct + bk.run(); }
+
+    bool left_of_mincut(int u) const { return bk.tree[pad(u)] == bk.SOURCE; }
+};
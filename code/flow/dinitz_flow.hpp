@@ -1,31 +1,31 @@
 #pragma once
 
-#include <bits/stdc++.h>
-using namespace std;
+#include "flow_network.hpp"
 
 /**
  * Dinitz's blocking flows
+ * Solves can be warm started: after set_capacity() or add() the next maxflow() with the
+ * same s and t repairs the current flow and augments from it.
  * Complexity: O(V^2 E), close to push relabel in practice
  */
 template <typename Flow = long, typename FlowSum = Flow>
 struct dinitz_flow {
-    struct Edge {
-        int node[2];
-        Flow cap, flow = 0;
-    };
-    int V, E = 0;
-    vector<vector<int>> res;
-    vector<Edge> edge;
+    int V;
+    flow_network<Flow> net;
 
-    explicit dinitz_flow(int V) : V(V), res(V) {}
+    explicit dinitz_flow(int V) : V(V), net(V) {}
 
-    void add(int u, int v, Flow capacity) {
-        assert(0 <= u && u < V && 0 <= v && v < V && capacity >= 0);
-        res[u].push_back(E++), edge.push_back({{u, v}, capacity, 0});
-        res[v].push_back(E++), edge.push_back({{v, u}, 0, 0});
+    int add(int u, int v, Flow capacity) { return net.add(u, v, capacity); }
+
+    void set_capacity(int e, Flow capacity) {
+        if (Flow removed = net.set_capacity(e, capacity); removed > 0) {
+            auto [u, v] = net.ends[e];
+            excess[u] += removed, excess[v] -= removed;
+        }
     }
 
     vector<int> level, arc, Q;
+    vector<FlowSum> excess; // in-out of the current flow, excess[t] is the flow value
     static constexpr Flow flowinf = numeric_limits<Flow>::max() / 2;
 
     bool bfs(int s, int t) {
@@ -35,9 +35,9 @@ struct dinitz_flow {
         int j = 0, S = 1;
         while (j < S) {
             int u = Q[j++];
-            for (int e : res[u]) {
-                int v = edge[e].node[1];
-                if (level[v] == -1 && edge[e].flow < edge[e].cap) {
+            for (int a = net.off[u]; a < net.off[u + 1]; a++) {
+                int v = net.head[a];
+                if (level[v] == -1 && net.res[a] > 0) {
                     level[v] = level[u] + 1;
                     Q[S++] = v;
                     if (v == t)
@@ -53,12 +53,12 @@ struct dinitz_flow {
             return mincap;
         }
         Flow preflow = 0;
-        for (int &i = arc[u], vsize = res[u].size(); i < vsize; i++) {
-            int e = res[u][i], v = edge[e].node[1];
-            if (edge[e].flow < edge[e].cap && level[u] < level[v]) {
-                Flow df = dfs(v, t, min(mincap, edge[e].cap - edge[e].flow));
-                edge[e].flow += df;
-                edge[e ^ 1].flow -= df;
+        for (int &a = arc[u], end = net.off[u + 1]; a < end; a++) {
+            int v = net.head[a];
+            if (net.res[a] > 0 && level[u] < level[v]) {
+                Flow df = dfs(v, t, min(mincap, net.res[a]));
+                net.res[a] -= df;
+                net.res[net.rev[a]] += df;
                 preflow += df;
                 mincap -= df;
                 if (mincap == 0)
@@ -69,16 +69,28 @@ struct dinitz_flow {
     }
 
     FlowSum maxflow(int s, int t) {
-        arc.assign(V, 0);
+        net.freeze();
+        arc.resize(V);
         Q.resize(V);
-        FlowSum max_flow = 0;
+        excess.resize(V, 0);
+        for (int u = 0; u < V; u++) {
+            if (u != s && u != t && excess[u] < 0) {
+                net.template reroute<false>(u, excess, s);
+            }
+        }
+        for (int u = 0; u < V; u++) {
+            if (u != s && u != t && excess[u] > 0) {
+                net.template reroute<true>(u, excess, t);
+            }
+        }
         while (bfs(s, t)) {
-            max_flow += dfs(s, t, flowinf);
-            fill(begin(arc), end(arc), 0);
+            copy(begin(net.off), end(net.off) - 1, begin(arc));
+            FlowSum df = dfs(s, t, flowinf);
+            excess[s] -= df, excess[t] += df;
         }
-        return max_flow;
+        return excess[t];
     }
 
-    Flow get_flow(int e) const { return edge[2 * e].flow; }
+    Flow get_flow(int e) const { return net.get_flow(e); }
     bool left_of_mincut(int u) const { return level[u] >= 0; }
 };
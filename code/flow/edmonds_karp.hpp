@@ -1,7 +1,6 @@
 #pragma once
 
-#include <bits/stdc++.h>
-using namespace std;
+#include "flow_network.hpp"
 
 /**
  * Edmonds-Karp augmenting paths
@@ -9,35 +8,26 @@ using namespace std;
  */
 template <typename Flow = long, typename FlowSum = Flow>
 struct edmonds_karp {
-    struct Edge {
-        int node[2];
-        Flow cap, flow = 0;
-    };
-    int V, E = 0;
-    vector<vector<int>> res;
-    vector<Edge> edge;
+    int V;
+    flow_network<Flow> net;
 
-    explicit edmonds_karp(int V) : V(V), res(V) {}
+    explicit edmonds_karp(int V) : V(V), net(V) {}
 
-    void add(int u, int v, Flow capacity) {
-        assert(0 <= u && u < V && 0 <= v && v < V && capacity >= 0);
-        res[u].push_back(E++), edge.push_back({{u, v}, capacity, 0});
-        res[v].push_back(E++), edge.push_back({{v, u}, 0, 0});
-    }
+    void add(int u, int v, Flow capacity) { net.add(u, v, capacity); }
 
     vector<int> pred, Q;
     static constexpr Flow flow_inf = numeric_limits<Flow>::max();
 
     bool bfs(int s, int t) {
         pred.assign(V, -1);
-        Q[0] = s, pred[s] = E;
+        Q[0] = s, pred[s] = net.A;
         int j = 0, S = 1;
         while (j < S && pred[t] == -1) {
             int u = Q[j++];
-            for (auto e : res[u]) {
-                int v = edge[e].node[1];
-                if (pred[v] == -1 && v != s && edge[e].flow < edge[e].cap) {
-                    pred[v] = e;
+            for (int a = net.off[u]; a < net.off[u + 1]; a++) {
+                int v = net.head[a];
+                if (pred[v] == -1 && v != s && net.res[a] > 0) {
+                    pred[v] = a;
                     Q[S++] = v;
                     if (v == t)
                         return true;
@@ -49,17 +39,18 @@ struct edmonds_karp {
 
     Flow augment(int t) {
         Flow aug_flow = flow_inf;
-        for (int e = pred[t]; e != E; e = pred[edge[e].node[0]]) {
-            aug_flow = min(aug_flow, edge[e].cap - edge[e].flow);
+        for (int a = pred[t]; a != net.A; a = pred[net.tail(a)]) {
+            aug_flow = min(aug_flow, net.res[a]);
         }
-        for (int e = pred[t]; e != E; e = pred[edge[e].node[0]]) {
-            edge[e].flow += aug_flow;
-            edge[e ^ 1].flow -= aug_flow;
+        for (int a = pred[t]; a != net.A; a = pred[net.tail(a)]) {
+            net.res[a] -= aug_flow;
+            net.res[net.rev[a]] += aug_flow;
         }
         return aug_flow;
     }
 
     FlowSum maxflow(int s, int t) {
+        net.freeze();
         Q.resize(V);
         FlowSum max_flow = 0;
         while (bfs(s, t)) {
@@ -68,6 +59,6 @@ struct edmonds_karp {
         return max_flow;
     }
 
-    Flow get_flow(int e) const { return edge[2 * e].flow; }
+    Flow get_flow(int e) const { return net.get_flow(e); }
     bool left_of_mincut(int u) const { return pred[u] >= 0; }
 };
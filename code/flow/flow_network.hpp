@@ -0,0 +1,122 @@
+#pragma once
+
+#include <bits/stdc++.h>
+using namespace std;
+
+/**
+ * Residual network shared by the maximum flow engines.
+ * Edges are recorded by add() and frozen into a CSR arc array sorted by tail: the arcs
+ * out of u are [off[u],off[u+1]), each with its head, its reverse arc and its residual
+ * capacity in separate arrays. Edge e is arc edge_arc[e], its reverse has residual = flow.
+ * Adding edges after a freeze is allowed, the next freeze keeps the current flow.
+ * Capacities can be changed in place, flow above the new capacity is removed and left
+ * as an imbalance at the edge's ends for the engine to reroute.
+ */
+template <typename Flow>
+struct flow_network {
+    int V, E = 0, A = 0;
+    vector<array<int, 2>> ends; // endpoints of each added edge
+    vector<Flow> cap;           // capacity of each added edge
+    vector<int> off, head, rev, edge_arc;
+    vector<Flow> res;
+    vector<int> prev, Q; // reroute bfs
+    bool frozen = false;
+
+    explicit flow_network(int V = 0) : V(V), off(V + 1) {}
+
+    int add(int u, int v, Flow capacity) {
+        assert(0 <= u && u < V && 0 <= v && v < V && capacity >= 0);
+        ends.push_back({u, v}), cap.push_back(capacity), frozen = false;
+        return E++;
+    }
+
+    void freeze() {
+        if (frozen) {
+            return;
+        }
+        vector<Flow> flow(E);
+        for (int e = 0; e < int(edge_arc.size()); e++) {
+            flow[e] = res[rev[edge_arc[e]]];
+        }
+        A = 2 * E;
+        off.assign(V + 1, 0), head.resize(A), rev.resize(A), res.resize(A);
+        edge_arc.resize(E);
+        for (auto [u, v] : ends) {
+            off[u]++, off[v]++;
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        for (int e = E - 1; e >= 0; e--) {
+            auto [u, v] = ends[e];
+            int a = --off[u], b = --off[v];
+            head[a] = v, rev[a] = b, res[a] = cap[e] - flow[e];
+            head[b] = u, rev[b] = a, res[b] = flow[e];
+            edge_arc[e] = a;
+        }
+        frozen = true;
+    }
+
+    void clear_flow() {
+        for (int e = 0; frozen && e < E; e++) {
+            int a = edge_arc[e];
+            res[a] = cap[e], res[rev[a]] = 0;
+        }
+    }
+
+    // Set the capacity of edge e, returns the flow removed from it
+    Flow set_capacity(int e, Flow capacity) {
+        assert(0 <= e && e < E && capacity >= 0);
+        freeze();
+        int a = edge_arc[e];
+        Flow removed = max(res[rev[a]] - capacity, Flow(0));
+        cap[e] = capacity, res[rev[a]] -= removed, res[a] = capacity - res[rev[a]];
+        return removed;
+    }
+
+    /**
+     * Fix the imbalance of x along shortest residual paths. forward: send excess[x] > 0
+     * to nodes with negative excess or the terminal. !forward: cover excess[x] < 0 from
+     * nodes with positive excess or the terminal. The imbalance must be fixable.
+     */
+    template <bool forward, typename FlowSum>
+    void reroute(int x, vector<FlowSum>& excess, int terminal) {
+        prev.resize(V, -1), Q.resize(V);
+        while (excess[x] != 0) {
+            int y = -1, S = 1;
+            Q[0] = x, prev[x] = A;
+            for (int i = 0; i < S && y == -1; i++) {
+                int u = Q[i];
+                for (int a = off[u]; a < off[u + 1]; a++) {
+                    int w = head[a];
+                    if (prev[w] == -1 && res[forward ? a : rev[a]] > 0) {
+                        prev[w] = a, Q[S++] = w;
+                        if (w == terminal || (forward ? excess[w] < 0 : excess[w] > 0)) {
+                            y = w;
+                            break;
+                        }
+                    }
+                }
+            }
+            assert(y != -1);
+            FlowSum df = forward ? excess[x] : -excess[x];
+            if (y != terminal) {
+                df = min(df, forward ? -excess[y] : excess[y]);
+            }
+            for (int w = y; w != x; w = tail(prev[w])) {
+                df = min(df, FlowSum(res[forward ? prev[w] : rev[prev[w]]]));
+            }
+            for (int w = y; w != x; w = tail(prev[w])) {
+                int r = forward ? prev[w] : rev[prev[w]];
+                res[r] -= df, res[rev[r]] += df;
+            }
+            excess[x] += forward ? -df : df, excess[y] += forward ? df : -df;
+            for (int i = 0; i < S; i++) {
+                prev[Q[i]] = -1;
+            }
+        }
+    }
+
+    int tail(int a) const { return head[rev[a]]; }
+    Flow get_flow(int e) const {
+        return e < int(edge_arc.size()) ? res[rev[edge_arc[e]]] : 0;
+    }
+};
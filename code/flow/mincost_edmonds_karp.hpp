@@ -6,9 +6,11 @@
  * Edmonds-Karp augmenting paths for simple mincost flow.
  * Complexity: O(V E^2 log V)
  * For min-cost flow problems with one source, one sink, no supplies or demands.
+ * The reduced costs are non-negative, so with integer costs MinHeap can be radix_int_heap.
  */
 template <typename Flow = long, typename Cost = long, typename FlowSum = Flow,
-          typename CostSum = Cost>
+          typename CostSum = Cost,
+          template <typename> typename MinHeap = binary_min_int_heap>
 struct mincost_edmonds_karp {
     struct Edge {
         int node[2];
@@ -29,7 +31,7 @@ struct mincost_edmonds_karp {
 
     vector<CostSum> dist, pi;
     vector<int> prev;
-    binary_int_heap<less_container<vector<CostSum>>> heap;
+    MinHeap<vector<CostSum>> heap;
     static inline constexpr Flow flowinf = numeric_limits<Flow>::max() / 2;
     static inline constexpr FlowSum flowsuminf = numeric_limits<FlowSum>::max() / 2;
     static inline constexpr CostSum costsuminf = numeric_limits<CostSum>::max() / 3;
@@ -75,7 +77,7 @@ struct mincost_edmonds_karp {
     pair<FlowSum, CostSum> mincost_flow(int s, int t, FlowSum F = flowsuminf,
                                         CostSum C = costsuminf) {
         pi.assign(V, 0);
-        heap = binary_int_heap<less_container<vector<CostSum>>>(V, dist);
+        heap = MinHeap<vector<CostSum>>(V, dist);
 
         FlowSum sflow = 0;
         CostSum scost = 0;
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "push_relabel.hpp"
+#include "../parallel/thread_pool.hpp" // thread_pool, run_on_each_thread, parallel_for
 
 /**
  * Cost scaling push relabel for general mincost single-commodity flow
  * Complexity: O(V^2 E log(VC))
  *
- * Currently no heuristics are implemented, and only lightly tested.
+ * Heuristics: arc fixing, arcs with |reduced cost| >= 2V epsilon on a circulation keep
+ * their flow and leave the residual lists; price refinement, a few Bellman-Ford passes
+ * look for prices that already make the circulation epsilon-optimal and skip the refine.
+ * With nthreads>1 a refine discharges all active nodes in synchronous rounds, a node only
+ * pushes into nodes that are not active in the round so their prices are stable.
+ * reoptimize() keeps the flow and prices after set_cost/set_capacity/set_supply and
+ * starts scaling from the epsilon they still satisfy.
  *
  * Uses push_relabel from maximum_flow.hpp for feasibility checking.
  * The initial maxflow computation is not required.
@@ -28,12 +35,27 @@ struct mincost_push_relabel {
     explicit mincost_push_relabel(int V = 0) : V(V), res(V), supply(V) {}
     mincost_push_relabel(int V, vector<FlowSum> sup) : V(V), res(V), supply(move(sup)) {}
 
-    void add(int u, int v, Flow capacity, Cost cost) {
-        assert(0 <= u && u < V && 0 <= v && v < V && u != v && capacity > 0 && cost >= 0);
+    int add(int u, int v, Flow capacity, Cost cost) {
+        assert(0 <= u && u < V && 0 <= v && v < V && u != v);
+        assert(capacity >= 0 && cost >= 0);
         res[u].push_back(E++), edge.push_back({{u, v}, capacity, 0, cost});
         res[v].push_back(E++), edge.push_back({{v, u}, 0, 0, -cost});
+        return E / 2 - 1;
     }
 
+    void set_cost(int e, Cost cost) {
+        assert(cost >= 0);
+        edge[2 * e].cost = cost, edge[2 * e + 1].cost = -cost;
+    }
+    void set_capacity(int e, Flow capacity) {
+        assert(capacity >= 0);
+        edge[2 * e].cap = capacity;
+        if (edge[2 * e].flow > capacity) {
+            edge[2 * e].flow = capacity, edge[2 * e + 1].flow = -capacity;
+        }
+    }
+    void set_supply(int u, FlowSum s) { supply[u] = s; }
+
     bool balanced() const {
         auto total = accumulate(begin(supply), end(supply), FlowSum(0));
         return total == 0;
@@ -76,12 +98,21 @@ struct mincost_push_relabel {
         return maxflow == total_supply;
     }
 
-    vector<CostSum> pi;
+    vector<CostSum> pi, new_pi, dist;
     vector<FlowSum> excess;
-    vector<int> arc;
+    vector<int> arc, live; // res[u][0,live[u]) are the arcs of u that are not fixed
     queue<int> active;
     Cost epsilon = 0; // scaling
     static inline constexpr CostSum costsumninf = numeric_limits<CostSum>::min() / 3;
+    static constexpr int GRAIN = 64, PRICE_REFINE_PASSES = 4;
+
+    // parallel refine
+    vector<int> is_active;
+    vector<atomic<FlowSum>> added;
+    vector<atomic<int>> mark; // stamp of the last round that discovered the node
+    vector<vector<int>> found;
+    vector<vector<pair<int, Flow>>> pushes;
+    int stamp = 0;
 
     CostSum reduced_cost(int e) const {
         auto [u, v] = edge[e].node;
@@ -116,34 +147,32 @@ struct mincost_push_relabel {
         excess[v] += send;
     }
 
-    void relabel(int u) {
-        auto good = pi[u] - epsilon;
+    // New price of u, lowered from p until an arc is admissible, which becomes arc[u]
+    CostSum relabel(int u, CostSum p) {
+        auto good = p - epsilon;
         auto pmax = costsumninf;
-        int vsize = res[u].size();
-        for (int i = 0; i < vsize; i++) {
+        for (int i = 0; i < live[u]; i++) {
             int e = res[u][i], v = edge[e].node[1];
             if (edge[e].flow < edge[e].cap) {
                 if (pmax < pi[v] - edge[e].cost) {
                     pmax = pi[v] - edge[e].cost;
                     if (good < pmax) {
-                        pi[u] = good;
                         arc[u] = i;
-                        return;
+                        return good;
                     }
                 }
             }
         }
         assert(pmax > costsumninf); // oops, infeasible!
-        pi[u] = pmax - epsilon;
         arc[u] = 0;
+        return pmax - epsilon;
     }
 
     void discharge(int u) {
-        int vsize = res[u].size();
         int& i = arc[u];
         while (excess[u] > 0) {
-            if (i == vsize) {
-                relabel(u);
+            if (i == live[u]) {
+                pi[u] = relabel(u, pi[u]);
             }
             int e = res[u][i];
             if (admissible(e)) {
@@ -153,8 +182,83 @@ struct mincost_push_relabel {
         }
     }
 
+    // Discharge u against the prices of the previous round, deferring the reverse arcs
+    void discharge_round(int t, int u) {
+        FlowSum ex = excess[u];
+        CostSum p = pi[u];
+        int& i = arc[u];
+        bool blocked = false;
+        while (ex > 0) {
+            if (i == live[u]) {
+                if (blocked) {
+                    i = 0; // admissible arcs into active nodes, retry next round
+                    break;
+                }
+                p = relabel(u, p);
+            }
+            int e = res[u][i], v = edge[e].node[1];
+            if (edge[e].flow < edge[e].cap && edge[e].cost + p - pi[v] < 0) {
+                if (!is_active[v]) {
+                    Flow send = min(ex, FlowSum(edge[e].cap - edge[e].flow));
+                    edge[e].flow += send, ex -= send;
+                    pushes[t].push_back({e, send});
+                    added[v].fetch_add(send, memory_order_relaxed);
+                    if (mark[v].exchange(stamp, memory_order_relaxed) != stamp) {
+                        found[t].push_back(v);
+                    }
+                } else {
+                    blocked = true;
+                }
+            }
+            i += ex > 0;
+        }
+        new_pi[u] = p, excess[u] = ex;
+        if (ex > 0 && mark[u].exchange(stamp, memory_order_relaxed) != stamp) {
+            found[t].push_back(u);
+        }
+    }
+
+    void discharge_rounds(thread_pool* pool, int T) {
+        vector<int> nodes;
+        for (; !active.empty(); active.pop()) {
+            if (int u = active.front(); excess[u] > 0 && !is_active[u]) {
+                nodes.push_back(u), is_active[u] = true;
+            }
+        }
+        while (!nodes.empty()) {
+            stamp++;
+            parallel_for(pool, T, nodes.size(), GRAIN,
+                         [&](int t, int i) { discharge_round(t, nodes[i]); });
+            run_on_each_thread(pool, T, [&](int t) {
+                for (auto [e, send] : pushes[t]) {
+                    edge[e ^ 1].flow -= send;
+                }
+                for (int v : found[t]) {
+                    excess[v] += added[v].exchange(0, memory_order_relaxed);
+                }
+                pushes[t].clear();
+            });
+            for (int u : nodes) {
+                pi[u] = new_pi[u], is_active[u] = false;
+            }
+            nodes.clear();
+            for (int t = 0; t < T; t++) {
+                for (int v : found[t]) {
+                    if (excess[v] > 0) {
+                        nodes.push_back(v), is_active[v] = true;
+                    }
+                }
+                found[t].clear();
+            }
+        }
+    }
+
     void init_excess() {
         excess = supply;
+        for (int e = 0; e < E; e += 2) {
+            auto [u, v] = edge[e].node;
+            excess[u] -= edge[e].flow, excess[v] += edge[e].flow;
+        }
         for (int u = 0; u < V; u++) {
             if (excess[u] > 0) {
                 active.push(u);
@@ -162,19 +266,68 @@ struct mincost_push_relabel {
         }
     }
 
-    void refine() {
-        // saturate admissible edges and init active nodes
+    // Smallest epsilon for which the current flow and prices are epsilon-optimal
+    CostSum current_epsilon() const {
+        CostSum eps = 0;
         for (int e = 0; e < E; e++) {
-            if (admissible(e)) {
-                push(e, edge[e].cap - edge[e].flow);
+            if (edge[e].flow < edge[e].cap) {
+                eps = max(eps, -reduced_cost(e));
+            }
+        }
+        return eps;
+    }
+
+    void fix_arcs() {
+        CostSum bound = 2 * CostSum(V) * epsilon;
+        for (int u = 0; u < V; u++) {
+            for (int i = 0; i < live[u]; i++) {
+                if (abs(reduced_cost(res[u][i])) >= bound) {
+                    swap(res[u][i--], res[u][--live[u]]);
+                }
+            }
+        }
+    }
+
+    bool price_refine() {
+        dist.assign(V, 0);
+        for (int pass = 0; pass < PRICE_REFINE_PASSES; pass++) {
+            bool changed = false;
+            for (int e = 0; e < E; e++) {
+                auto [u, v] = edge[e].node;
+                if (edge[e].flow < edge[e].cap) {
+                    if (CostSum d = dist[u] + reduced_cost(e) + epsilon; d < dist[v]) {
+                        dist[v] = d, changed = true;
+                    }
+                }
+            }
+            if (!changed) {
+                for (int u = 0; u < V; u++) {
+                    pi[u] += dist[u];
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void refine(thread_pool* pool, int T) {
+        // saturate admissible edges and init active nodes
+        for (int u = 0; u < V; u++) {
+            for (int i = 0; i < live[u]; i++) {
+                if (int e = res[u][i]; admissible(e)) {
+                    push(e, edge[e].cap - edge[e].flow);
+                }
             }
         }
 
         // there are no admissible arcs, every active node must be relabeled
         for (int u = 0; u < V; u++) {
-            arc[u] = res[u].size();
+            arc[u] = live[u];
         }
 
+        if (T > 1) {
+            discharge_rounds(pool, T);
+        }
         while (!active.empty()) {
             int u = active.front();
             active.pop();
@@ -182,25 +335,52 @@ struct mincost_push_relabel {
         }
     }
 
-    void optimize() {
+    void optimize(thread_pool* pool, int T) {
         constexpr long alpha = 5;
-        Cost C = 0;
-        for (int e = 0; e < E; e++) {
-            C = max(C, edge[e].cost);
-        }
-        epsilon = (V + 1) * C;
         do {
+            bool circulation = all_of(begin(excess), end(excess),
+                                      [](FlowSum x) { return x == 0; });
+            if (circulation) {
+                fix_arcs(); // the circulation is epsilon-optimal for the last epsilon
+            }
             epsilon = max(epsilon / alpha, 1L);
-            refine();
+            if (!circulation || !price_refine()) {
+                refine(pool, T);
+            }
         } while (epsilon != 1);
     }
 
-    CostSum mincost_circulation() {
-        pi.assign(V, 0);
-        arc.assign(V, 0);
+    CostSum solve(bool cold, int nthreads) {
+        int T = nthreads;
+        optional_thread_pool pool(T);
+        if (T > 1) {
+            new_pi.assign(V, 0), is_active.assign(V, false);
+            added = vector<atomic<FlowSum>>(V);
+            mark = vector<atomic<int>>(V);
+            found.assign(T, {}), pushes.assign(T, {}), stamp = 0;
+        }
+        arc.assign(V, 0), live.resize(V);
+        for (int u = 0; u < V; u++) {
+            live[u] = res[u].size();
+        }
+        if (cold) {
+            pi.assign(V, 0);
+            for (int e = 0; e < E; e++) {
+                edge[e].flow = 0;
+            }
+        }
         init_excess();
         scale();
-        optimize();
+        if (cold) {
+            Cost C = 0;
+            for (int e = 0; e < E; e++) {
+                C = max(C, edge[e].cost);
+            }
+            epsilon = C;
+        } else {
+            epsilon = current_epsilon();
+        }
+        optimize(pool.get(), T);
         unscale();
 
         CostSum total_cost = 0;
@@ -210,5 +390,10 @@ struct mincost_push_relabel {
         return total_cost;
     }
 
+    CostSum mincost_circulation(int nthreads = 1) { return solve(true, nthreads); }
+
+    // Solve again from the flow and prices of the last solve
+    CostSum reoptimize(int nthreads = 1) { return solve(false, nthreads); }
+
     Flow get_flow(int e) const { return edge[2 * e].flow; }
 };
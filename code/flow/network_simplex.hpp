@@ -1,6 +1,7 @@
 #pragma once
 
-#include "../struct/integer_lists.hpp" // linked_lists
+#include <bits/stdc++.h>
+using namespace std;
 
 /**
  * Network simplex for minimum cost circulation with fixed supply/demand at nodes
@@ -10,6 +11,19 @@
  * Cost type should be large enough to hold costs and potentials (usually >=64 bits)
  * CostSum type should be large enough to hold inner product of capacities and costs
  *
+ * Arcs are stored as separate arrays (source, target, cap, cost, flow, state), the last
+ * V arcs are the artificial root arcs. The spanning tree is kept in thread form: parent,
+ * pred, a preorder thread with its reverse, subtree sizes and the last node of each
+ * subtree in the thread. The join node is found by climbing from the smaller subtree and
+ * a pivot only rewires the thread around the stem from u_in to u_out, potentials are
+ * shifted by walking the thread of the moved subtree.
+ *
+ * Pivot rules:
+ *   BLOCK_SEARCH: scan blocks of sqrt(E) arcs, take the best arc of the first block
+ *                 that has an eligible arc.
+ *   CANDIDATE_LIST: multiple partial pricing, a major iteration collects a list of
+ *                   eligible arcs, minor iterations pivot on the best arc of the list.
+ *
  * Complexity: O(V) expected per pivot, O(E) worst case
  * Always faster than push relabel for sparse graphs.
  *
@@ -31,147 +45,159 @@
  */
 template <typename Flow = long, typename Cost = long, typename CostSum = int64_t>
 struct network_simplex {
-    explicit network_simplex(int V) : V(V), node(V + 1) {}
+    enum PivotRule { BLOCK_SEARCH, CANDIDATE_LIST };
+
+    explicit network_simplex(int V) : V(V), supply(V), pi(V + 1) {}
 
     void add(int u, int v, Flow lower, Flow upper, Cost cost) {
         assert(0 <= u && u < V && 0 <= v && v < V);
-        edge.push_back({{u, v}, lower, upper, cost}), E++;
+        source.push_back(u), target.push_back(v), low.push_back(lower);
+        cap.push_back(upper), arc_cost.push_back(cost), flow.push_back(0);
+        state.push_back(STATE_LOWER), E++;
     }
 
-    void add_supply(int u, Flow supply) { node[u].supply += supply; }
-    void add_demand(int u, Flow demand) { node[u].supply -= demand; }
-    auto get_supply(int u) const { return node[u].supply; }
+    void add_supply(int u, Flow s) { supply[u] += s; }
+    void add_demand(int u, Flow demand) { supply[u] -= demand; }
+    auto get_supply(int u) const { return supply[u]; }
 
-    auto get_potential(int u) const { return node[u].pi; }
-    auto get_flow(int e) const { return edge[e].flow; }
-    auto reduced_cost(int e) const {
-        auto [u, v] = edge[e].node;
-        return edge[e].cost + node[u].pi - node[v].pi;
-    }
+    auto get_potential(int u) const { return pi[u]; }
+    auto get_flow(int e) const { return flow[e]; }
+    auto reduced_cost(int e) const { return arc_cost[e] + pi[source[e]] - pi[target[e]]; }
 
     auto get_circulation_cost() const {
         CostSum sum = 0;
         for (int e = 0; e < E; e++) {
-            sum += edge[e].flow * CostSum(edge[e].cost);
+            sum += flow[e] * CostSum(arc_cost[e]);
         }
         return sum;
     }
 
     void verify() const {
         for (int e = 0; e < E; e++) {
-            assert(edge[e].lower <= edge[e].flow && edge[e].flow <= edge[e].upper);
-            assert(edge[e].flow == edge[e].lower || reduced_cost(e) <= 0);
-            assert(edge[e].flow == edge[e].upper || reduced_cost(e) >= 0);
+            assert(low[e] <= flow[e] && flow[e] <= cap[e]);
+            assert(flow[e] == low[e] || reduced_cost(e) <= 0);
+            assert(flow[e] == cap[e] || reduced_cost(e) >= 0);
         }
     }
 
-    bool mincost_circulation() {
+    long pivots = 0; // pivots made by the last mincost_circulation()
+
+    bool mincost_circulation(PivotRule rule = BLOCK_SEARCH) {
         static constexpr bool INFEASIBLE = false, OPTIMAL = true;
 
         Flow sum_supply = 0;
         for (int u = 0; u < V; u++) {
-            sum_supply += node[u].supply;
+            sum_supply += supply[u];
         }
         if (sum_supply != 0) {
             return INFEASIBLE;
         }
         for (int e = 0; e < E; e++) {
-            if (edge[e].lower > edge[e].upper) {
+            if (low[e] > cap[e]) {
                 return INFEASIBLE;
             }
         }
 
         init();
-        int in_arc = select_pivot_edge();
-        while (in_arc != -1) {
-            pivot(in_arc);
-            in_arc = select_pivot_edge();
+        pivots = 0;
+        auto select = [&]() {
+            return rule == BLOCK_SEARCH ? block_search() : candidate_list_search();
+        };
+        for (int in_arc = select(); in_arc != -1; in_arc = select()) {
+            pivot(in_arc), pivots++;
         }
 
         for (int e = 0; e < E; e++) {
-            auto [u, v] = edge[e].node;
-            edge[e].flow += edge[e].lower;
-            edge[e].upper += edge[e].lower;
-            node[u].supply += edge[e].lower;
-            node[v].supply -= edge[e].lower;
+            flow[e] += low[e];
+            cap[e] += low[e];
+            supply[source[e]] += low[e];
+            supply[target[e]] -= low[e];
         }
+        bool feasible = true;
         for (int e = E; e < E + V; e++) {
-            if (edge[e].flow != 0) {
-                edge.resize(E);
-                return INFEASIBLE;
-            }
+            feasible &= flow[e] == 0;
         }
-        edge.resize(E);
-        return OPTIMAL;
+        source.resize(E), target.resize(E), cap.resize(E);
+        arc_cost.resize(E), flow.resize(E), state.resize(E);
+        return feasible ? OPTIMAL : INFEASIBLE;
     }
 
   private:
     enum ArcState : int8_t { STATE_UPPER = -1, STATE_TREE = 0, STATE_LOWER = 1 };
+    enum ArcDir : int8_t { DIR_DOWN = -1, DIR_UP = 1 }; // pred arc leaves/enters parent
+
+    int V, E = 0, root = 0;
+    vector<int> source, target;
+    vector<Flow> low, cap, flow, supply;
+    vector<Cost> arc_cost, pi;
+    vector<ArcState> state;
 
-    struct Node {
-        int parent, pred;
-        Flow supply;
-        Cost pi;
-    };
-    struct Edge {
-        int node[2];
-        Flow lower, upper;
-        Cost cost;
-        Flow flow = 0;
-        ArcState state = STATE_LOWER;
-    };
-    int V, E = 0, next_arc = 0, block_size = 0;
-    vector<Node> node;
-    vector<Edge> edge;
-    linked_lists children;
-    vector<int> bfs; // scratchpad for bfs and upwards walk
+    // spanning tree
+    vector<int> parent, pred, thread, rev_thread, succ_num, last_succ, dirty_revs;
+    vector<ArcDir> pred_dir;
+
+    // pivot state
+    int next_arc = 0, block_size = 0, list_length = 0, minor_limit = 0;
+    int curr_length = 0, minor_count = 0;
+    vector<int> candidates;
+    int join = 0, u_in = 0, v_in = 0, u_out = 0;
+
+    Cost eligibility(int e) const { return state[e] * reduced_cost(e); }
 
     void init() {
         // Remove non-zero lower bounds and compute artif_cost as sum of all costs
         Cost artif_cost = 1;
         for (int e = 0; e < E; e++) {
-            auto [u, v] = edge[e].node;
-            edge[e].flow = 0;
-            edge[e].state = STATE_LOWER;
-            edge[e].upper -= edge[e].lower;
-            node[u].supply -= edge[e].lower;
-            node[v].supply += edge[e].lower;
-            artif_cost += edge[e].cost < 0 ? -edge[e].cost : edge[e].cost;
+            flow[e] = 0;
+            state[e] = STATE_LOWER;
+            cap[e] -= low[e];
+            supply[source[e]] -= low[e];
+            supply[target[e]] += low[e];
+            artif_cost += arc_cost[e] < 0 ? -arc_cost[e] : arc_cost[e];
         }
 
-        edge.resize(E + V);
-        bfs.resize(V + 1);
-        children.assign(V + 1, V + 1);
-        next_arc = 0;
+        int N = V + 1, A = E + V;
+        source.resize(A), target.resize(A), cap.resize(A);
+        arc_cost.resize(A), flow.resize(A), state.resize(A);
+        parent.resize(N), pred.resize(N), thread.resize(N), rev_thread.resize(N);
+        succ_num.resize(N), last_succ.resize(N), pred_dir.resize(N);
 
         // Add root<->node artificial edges with initial supply for feasible flow
-        int root = V;
-        node[root] = {-1, -1, 0, 0};
+        root = V;
+        parent[root] = -1, pred[root] = -1, pi[root] = 0;
+        thread[root] = 0, rev_thread[0] = root;
+        succ_num[root] = N, last_succ[root] = root - 1;
 
         for (int u = 0, e = E; u < V; u++, e++) {
-            node[u].parent = root, node[u].pred = e;
-            children.push_back(root, u);
-            auto supply = node[u].supply;
-            if (supply >= 0) {
-                node[u].pi = -artif_cost;
-                edge[e] = {{u, root}, 0, supply, artif_cost, supply, STATE_TREE};
+            parent[u] = root, pred[u] = e;
+            thread[u] = u + 1, rev_thread[u + 1] = u;
+            succ_num[u] = 1, last_succ[u] = u;
+            state[e] = STATE_TREE, arc_cost[e] = artif_cost;
+            if (supply[u] >= 0) {
+                pred_dir[u] = DIR_UP, pi[u] = -artif_cost;
+                source[e] = u, target[e] = root, cap[e] = flow[e] = supply[u];
             } else {
-                node[u].pi = artif_cost;
-                edge[e] = {{root, u}, 0, -supply, artif_cost, -supply, STATE_TREE};
+                pred_dir[u] = DIR_DOWN, pi[u] = artif_cost;
+                source[e] = root, target[e] = u, cap[e] = flow[e] = -supply[u];
             }
         }
 
-        block_size = max(int(ceil(sqrt(E + V))), min(10, V + 1));
+        next_arc = 0;
+        block_size = max(int(ceil(sqrt(A))), min(10, N));
+        list_length = max(int(0.25 * sqrt(A)), 10);
+        minor_limit = max(int(0.1 * list_length), 3);
+        curr_length = minor_count = 0;
+        candidates.resize(list_length);
     }
 
-    int select_pivot_edge() {
+    int block_search() {
         // lemon-like block search, check block_size edges and pick the best one
         Cost minimum = 0;
         int in_arc = -1;
         int count = block_size, seen_edges = E + V;
         for (int &e = next_arc; seen_edges-- > 0; e = e + 1 == E + V ? 0 : e + 1) {
-            if (minimum > edge[e].state * reduced_cost(e)) {
-                minimum = edge[e].state * reduced_cost(e);
+            if (Cost c = eligibility(e); minimum > c) {
+                minimum = c;
                 in_arc = e;
             }
             if (--count == 0 && minimum < 0) {
@@ -183,104 +209,233 @@ struct network_simplex {
         return in_arc;
     }
 
-    void pivot(int in_arc) {
-        // Find join node (lca)
-        auto [u_in, v_in] = edge[in_arc].node;
-        int a = u_in, b = v_in;
-        while (a != b) {
-            a = node[a].parent == -1 ? v_in : node[a].parent;
-            b = node[b].parent == -1 ? u_in : node[b].parent;
+    int candidate_list_search() {
+        Cost minimum = 0;
+        int in_arc = -1;
+
+        // Minor iteration: pivot on the best arc still eligible in the candidate list
+        if (curr_length > 0 && minor_count < minor_limit) {
+            minor_count++;
+            for (int i = 0; i < curr_length; i++) {
+                int e = candidates[i];
+                if (Cost c = eligibility(e); c < minimum) {
+                    minimum = c, in_arc = e;
+                } else if (c >= 0) {
+                    candidates[i--] = candidates[--curr_length];
+                }
+            }
+            if (in_arc != -1) {
+                return in_arc;
+            }
         }
-        int join = a;
-
-        // Orient edge so that we add flow to source->target
-        int source = edge[in_arc].state == STATE_LOWER ? u_in : v_in;
-        int target = edge[in_arc].state == STATE_LOWER ? v_in : u_in;
-
-        enum OutArcSide { SAME_EDGE, SOURCE_SIDE, TARGET_SIDE };
-        Flow flow_delta = edge[in_arc].upper;
-        OutArcSide side = SAME_EDGE;
-        int u_out = -1;
-
-        // Go up the cycle from source to the join node
-        for (int u = source; u != join && flow_delta; u = node[u].parent) {
-            int e = node[u].pred;
-            bool edge_down = u == edge[e].node[1];
-            Flow d = edge_down ? edge[e].upper - edge[e].flow : edge[e].flow;
-            if (flow_delta > d) {
-                flow_delta = d;
-                u_out = u;
-                side = SOURCE_SIDE;
+
+        // Major iteration: collect a new candidate list
+        curr_length = 0;
+        for (int &e = next_arc, seen_edges = E + V; seen_edges-- > 0;
+             e = e + 1 == E + V ? 0 : e + 1) {
+            if (Cost c = eligibility(e); c < 0) {
+                candidates[curr_length++] = e;
+                if (c < minimum) {
+                    minimum = c, in_arc = e;
+                }
+                if (curr_length == list_length) {
+                    break;
+                }
+            }
+        }
+        minor_count = 1;
+        return in_arc;
+    }
+
+    void find_join_node(int in_arc) {
+        int u = source[in_arc], v = target[in_arc];
+        while (u != v) {
+            if (succ_num[u] < succ_num[v]) {
+                u = parent[u];
+            } else {
+                v = parent[v];
             }
         }
+        join = u;
+    }
 
-        // Go up the cycle from target to the join node
-        for (int u = target; u != join && (flow_delta || side != TARGET_SIDE);
-             u = node[u].parent) {
-            int e = node[u].pred;
-            bool edge_up = u == edge[e].node[0];
-            Flow d = edge_up ? edge[e].upper - edge[e].flow : edge[e].flow;
-            if (flow_delta >= d) {
-                flow_delta = d;
-                u_out = u;
-                side = TARGET_SIDE;
+    // Find the blocking arc of the cycle, returns false if it is in_arc itself
+    bool find_leaving_arc(int in_arc, Flow& delta) {
+        // Orient the cycle so that we add flow to first->second
+        int first = state[in_arc] == STATE_LOWER ? source[in_arc] : target[in_arc];
+        int second = state[in_arc] == STATE_LOWER ? target[in_arc] : source[in_arc];
+        delta = cap[in_arc];
+        int side = 0;
+
+        // Go up the cycle from first to the join node, the cycle goes down these arcs
+        for (int u = first; u != join; u = parent[u]) {
+            int e = pred[u];
+            Flow d = pred_dir[u] == DIR_DOWN ? cap[e] - flow[e] : flow[e];
+            if (d < delta) {
+                delta = d, u_out = u, side = 1;
+            }
+        }
+        // Go up the cycle from second to the join node, the cycle goes up these arcs
+        for (int u = second; u != join; u = parent[u]) {
+            int e = pred[u];
+            Flow d = pred_dir[u] == DIR_UP ? cap[e] - flow[e] : flow[e];
+            if (d <= delta) {
+                delta = d, u_out = u, side = 2;
             }
         }
 
         // Put u_in on the same side as u_out
-        u_in = side == SOURCE_SIDE ? source : target;
-        v_in = side == SOURCE_SIDE ? target : source;
-
-        // Augment along the cycle
-        if (flow_delta) {
-            auto delta = edge[in_arc].state * flow_delta;
-            edge[in_arc].flow += delta;
-            for (int u = edge[in_arc].node[0]; u != join; u = node[u].parent) {
-                int e = node[u].pred;
-                edge[e].flow += (u == edge[e].node[0] ? -1 : +1) * delta;
+        u_in = side == 1 ? first : second;
+        v_in = side == 1 ? second : first;
+        return side != 0;
+    }
+
+    void change_flow(int in_arc, Flow delta, bool change) {
+        if (delta > 0) {
+            Flow val = state[in_arc] * delta;
+            flow[in_arc] += val;
+            for (int u = source[in_arc]; u != join; u = parent[u]) {
+                flow[pred[u]] -= pred_dir[u] * val;
+            }
+            for (int u = target[in_arc]; u != join; u = parent[u]) {
+                flow[pred[u]] += pred_dir[u] * val;
+            }
+        }
+        if (change) {
+            state[in_arc] = STATE_TREE;
+            state[pred[u_out]] = flow[pred[u_out]] == 0 ? STATE_LOWER : STATE_UPPER;
+        } else {
+            state[in_arc] = ArcState(-state[in_arc]);
+        }
+    }
+
+    // Hang the subtree of u_out from v_in through in_arc, reversing the stem u_in..u_out
+    void update_tree(int in_arc) {
+        int old_rev_thread = rev_thread[u_out];
+        int old_succ_num = succ_num[u_out];
+        int old_last_succ = last_succ[u_out];
+        int v_out = parent[u_out];
+
+        if (u_in == u_out) {
+            parent[u_in] = v_in;
+            pred[u_in] = in_arc;
+            pred_dir[u_in] = u_in == source[in_arc] ? DIR_UP : DIR_DOWN;
+
+            // Move the subtree of u_in right after v_in in the thread
+            if (thread[v_in] != u_out) {
+                int after = thread[old_last_succ];
+                thread[old_rev_thread] = after;
+                rev_thread[after] = old_rev_thread;
+                after = thread[v_in];
+                thread[v_in] = u_out;
+                rev_thread[u_out] = v_in;
+                thread[old_last_succ] = after;
+                rev_thread[after] = old_last_succ;
+            }
+        } else {
+            // If old_rev_thread is v_in then join and v_out coincide
+            int thread_continue = old_rev_thread == v_in ? thread[old_last_succ]
+                                                         : thread[v_in];
+
+            // Relink the thread and the parents along the stem from u_in to u_out
+            int stem = u_in, par_stem = v_in;
+            int last = last_succ[u_in], after = thread[last];
+            thread[v_in] = u_in;
+            dirty_revs.clear();
+            dirty_revs.push_back(v_in);
+            while (stem != u_out) {
+                // Insert the next stem node into the thread
+                int next_stem = parent[stem];
+                thread[last] = next_stem;
+                dirty_revs.push_back(last);
+
+                // Remove the subtree of stem from the thread
+                int before = rev_thread[stem];
+                thread[before] = after;
+                rev_thread[after] = before;
+
+                parent[stem] = par_stem;
+                par_stem = stem;
+                stem = next_stem;
+
+                last = last_succ[stem] == last_succ[par_stem] ? rev_thread[par_stem]
+                                                              : last_succ[stem];
+                after = thread[last];
+            }
+            parent[u_out] = par_stem;
+            thread[last] = thread_continue;
+            rev_thread[thread_continue] = last;
+            last_succ[u_out] = last;
+
+            // Remove the subtree of u_out from the thread unless it is already done
+            if (old_rev_thread != v_in) {
+                thread[old_rev_thread] = after;
+                rev_thread[after] = old_rev_thread;
             }
-            for (int u = edge[in_arc].node[1]; u != join; u = node[u].parent) {
-                int e = node[u].pred;
-                edge[e].flow += (u == edge[e].node[0] ? +1 : -1) * delta;
+            for (int u : dirty_revs) {
+                rev_thread[thread[u]] = u;
             }
+
+            // Reverse pred, pred_dir, last_succ and succ_num along the stem
+            int sc = 0, ls = last_succ[u_out];
+            for (int u = u_out, p = parent[u]; u != u_in; u = p, p = parent[u]) {
+                pred[u] = pred[p];
+                pred_dir[u] = ArcDir(-pred_dir[p]);
+                sc += succ_num[u] - succ_num[p];
+                succ_num[u] = sc;
+                last_succ[p] = ls;
+            }
+            pred[u_in] = in_arc;
+            pred_dir[u_in] = u_in == source[in_arc] ? DIR_UP : DIR_DOWN;
+            succ_num[u_in] = old_succ_num;
         }
 
-        if (side == SAME_EDGE) {
-            edge[in_arc].state = ArcState(-edge[in_arc].state);
-            return;
+        // Update last_succ from v_in towards the root
+        int up_limit_out = last_succ[join] == v_in ? join : -1;
+        int last_succ_out = last_succ[u_out];
+        for (int u = v_in; u != -1 && last_succ[u] == v_in; u = parent[u]) {
+            last_succ[u] = last_succ_out;
         }
 
-        // Replace out_arc with in_arc in the spanning tree
-        int out_arc = node[u_out].pred;
-        edge[in_arc].state = STATE_TREE;
-        edge[out_arc].state = edge[out_arc].flow ? STATE_UPPER : STATE_LOWER;
+        // Update last_succ from v_out towards the root
+        if (join != old_rev_thread && v_in != old_rev_thread) {
+            for (int u = v_out; u != up_limit_out && last_succ[u] == old_last_succ;
+                 u = parent[u]) {
+                last_succ[u] = old_rev_thread;
+            }
+        } else if (last_succ_out != old_last_succ) {
+            for (int u = v_out; u != up_limit_out && last_succ[u] == old_last_succ;
+                 u = parent[u]) {
+                last_succ[u] = last_succ_out;
+            }
+        }
 
-        // Walk up from u_in to u_out, then fix parent/pred/child pointers backwrads
-        int i = 0, S = 0;
-        for (int u = u_in; u != u_out; u = node[u].parent) {
-            bfs[S++] = u;
+        // Update succ_num from v_in and v_out to join
+        for (int u = v_in; u != join; u = parent[u]) {
+            succ_num[u] += old_succ_num;
+        }
+        for (int u = v_out; u != join; u = parent[u]) {
+            succ_num[u] -= old_succ_num;
         }
-        for (i = S - 1; i >= 0; i--) {
-            int u = bfs[i], p = node[u].parent;
-            children.erase(p);
-            children.push_back(u, p);
-            node[p].parent = u;
-            node[p].pred = node[u].pred;
+    }
+
+    // Shift the potentials of the subtree of u_in so that in_arc has reduced cost 0
+    void update_potentials(int in_arc) {
+        Cost sigma = pi[v_in] - pi[u_in] - pred_dir[u_in] * arc_cost[in_arc];
+        int end = thread[last_succ[u_in]];
+        for (int u = u_in; u != end; u = thread[u]) {
+            pi[u] += sigma;
         }
-        children.erase(u_in);
-        children.push_back(v_in, u_in);
-        node[u_in].parent = v_in;
-        node[u_in].pred = in_arc;
-
-        // Adjust potentials in the subtree of u_in (pi_delta is not 0).
-        Cost current_pi = reduced_cost(in_arc);
-        Cost pi_delta = (u_in == edge[in_arc].node[0] ? -1 : +1) * current_pi;
-
-        bfs[0] = u_in;
-        for (i = 0, S = 1; i < S; i++) {
-            int u = bfs[i];
-            node[u].pi += pi_delta;
-            FOR_EACH_IN_LINKED_LIST (v, u, children) { bfs[S++] = v; }
+    }
+
+    void pivot(int in_arc) {
+        find_join_node(in_arc);
+        Flow delta;
+        bool change = find_leaving_arc(in_arc, delta);
+        change_flow(in_arc, delta, change);
+        if (change) {
+            update_tree(in_arc);
+            update_potentials(in_arc);
         }
     }
 };
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "flow_network.hpp"
+#include "../parallel/thread_pool.hpp" // thread_pool, run_on_each_thread, parallel_for
+
+/**
+ * Synchronous parallel push relabel (Baumstark, Blelloch, Shun)
+ * Each round discharges every active node at once against the labels of the previous
+ * round. A push along u->v into an active v is only made if u wins against v, so no arc
+ * is pushed on from both sides, the loser retries next round. Reverse residuals and
+ * excesses are applied in a second phase, so a node only writes its own arcs while
+ * discharging. Global relabels are level synchronous parallel bfs from the sink.
+ * Only the flow value and the minimum cut are computed, the preflow is not converted.
+ * Complexity: O(V^2 E), the number of rounds is usually small
+ */
+template <typename Flow = long, typename FlowSum = Flow>
+struct parallel_push_relabel {
+    int V;
+    flow_network<Flow> net;
+
+    explicit parallel_push_relabel(int V) : V(V), net(V) {}
+
+    void add(int u, int v, Flow capacity) { net.add(u, v, capacity); }
+
+    static constexpr int GRAIN = 64;
+
+    vector<int> height, new_height, arc, active, is_active;
+    vector<FlowSum> excess;
+    vector<atomic<FlowSum>> added;
+    vector<atomic<int>> mark; // stamp of the last round/bfs that discovered the node
+    vector<vector<int>> found;
+    vector<vector<pair<int, Flow>>> pushes;
+    vector<long> work;
+    int stamp = 0;
+
+    bool wins(int u, int v) const {
+        int hu = height[u], hv = height[v];
+        return hu == hv + 1 || hu < hv - 1 || (hu == hv && u < v);
+    }
+
+    void discharge(int tid, int u) {
+        FlowSum e = excess[u];
+        int h = height[u];
+        int& a = arc[u];
+        bool blocked = false;
+        while (e > 0) {
+            if (a == net.off[u + 1]) {
+                if (blocked) {
+                    break; // an active neighbour wins this arc, retry next round
+                }
+                work[tid] += net.off[u + 1] - net.off[u] + 12;
+                h = 2 * V;
+                for (int b = net.off[u]; b < net.off[u + 1]; b++) {
+                    int v = net.head[b];
+                    if (net.res[b] > 0 && v != u && h > height[v] + 1) {
+                        h = height[v] + 1, a = b;
+                    }
+                }
+                if (h >= V) {
+                    break;
+                }
+            }
+            int v = net.head[a];
+            if (net.res[a] > 0 && v != u && h == height[v] + 1) {
+                if (!is_active[v] || wins(u, v)) {
+                    Flow df = min(e, FlowSum(net.res[a]));
+                    net.res[a] -= df, e -= df;
+                    pushes[tid].push_back({a, df});
+                    added[v].fetch_add(df, memory_order_relaxed);
+                    if (mark[v].exchange(stamp, memory_order_relaxed) != stamp) {
+                        found[tid].push_back(v);
+                    }
+                } else {
+                    blocked = true;
+                }
+            }
+            a += e > 0;
+        }
+        new_height[u] = h, excess[u] = e;
+        if (e > 0 && h < V && mark[u].exchange(stamp, memory_order_relaxed) != stamp) {
+            found[tid].push_back(u);
+        }
+    }
+
+    void round(thread_pool& pool, int T, int t) {
+        stamp++;
+        parallel_for(&pool, T, active.size(), GRAIN,
+                     [&](int tid, int i) { discharge(tid, active[i]); });
+
+        run_on_each_thread(&pool, T, [&](int tid) {
+            for (auto [a, df] : pushes[tid]) {
+                net.res[net.rev[a]] += df;
+            }
+            for (int v : found[tid]) {
+                excess[v] += added[v].exchange(0, memory_order_relaxed);
+            }
+            pushes[tid].clear();
+        });
+
+        for (int u : active) {
+            height[u] = new_height[u], is_active[u] = false;
+        }
+        active.clear();
+        for (int tid = 0; tid < T; tid++) {
+            for (int v : found[tid]) {
+                if (v != t && height[v] < V) {
+                    active.push_back(v), is_active[v] = true;
+                }
+            }
+            found[tid].clear();
+        }
+    }
+
+    void global_relabel(thread_pool& pool, int T, int s, int t) {
+        stamp++;
+        fill(begin(height), end(height), V);
+        vector<int> frontier = {t};
+        height[t] = 0, mark[t] = stamp, mark[s] = stamp;
+        for (int level = 1; !frontier.empty(); level++) {
+            parallel_for(&pool, T, frontier.size(), GRAIN, [&](int tid, int i) {
+                int v = frontier[i];
+                for (int a = net.off[v]; a < net.off[v + 1]; a++) {
+                    int u = net.head[a];
+                    if (net.res[net.rev[a]] > 0 &&
+                        mark[u].exchange(stamp, memory_order_relaxed) != stamp) {
+                        height[u] = level;
+                        found[tid].push_back(u);
+                    }
+                }
+            });
+            frontier.clear();
+            for (int tid = 0; tid < T; tid++) {
+                frontier.insert(end(frontier), begin(found[tid]), end(found[tid]));
+                found[tid].clear();
+            }
+        }
+        for (int u : active) {
+            is_active[u] = false;
+        }
+        active.clear();
+        for (int u = 0; u < V; u++) {
+            arc[u] = net.off[u];
+            if (u != s && u != t && excess[u] > 0 && height[u] < V) {
+                active.push_back(u), is_active[u] = true;
+            }
+        }
+    }
+
+    FlowSum maxflow(int s, int t, int nthreads = 1) {
+        assert(s != t && nthreads > 0);
+        net.freeze();
+        int T = nthreads;
+        thread_pool pool(T);
+
+        height.assign(V, 0), new_height.assign(V, 0), is_active.assign(V, false);
+        arc.assign(begin(net.off), end(net.off) - 1);
+        excess.assign(V, 0);
+        added = vector<atomic<FlowSum>>(V);
+        mark = vector<atomic<int>>(V);
+        found.assign(T, {}), pushes.assign(T, {}), work.assign(T, 0);
+        active.clear(), stamp = 0;
+
+        for (int a = net.off[s]; a < net.off[s + 1]; a++) {
+            if (net.res[a] > 0 && net.head[a] != s) {
+                excess[net.head[a]] += net.res[a];
+                net.res[net.rev[a]] += net.res[a], net.res[a] = 0;
+            }
+        }
+
+        const long threshold = 6L * V + net.A / 2;
+        global_relabel(pool, T, s, t);
+        while (!active.empty()) {
+            round(pool, T, t);
+            long total = accumulate(begin(work), end(work), 0L);
+            if (active.empty() || total >= threshold) {
+                global_relabel(pool, T, s, t); // final relabel also fixes the cut
+                fill(begin(work), end(work), 0);
+            }
+        }
+
+        pool.finish();
+        return excess[t];
+    }
+
+    bool left_of_mincut(int u) const { return height[u] >= V; }
+};
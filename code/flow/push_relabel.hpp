@@ -1,28 +1,29 @@
 #pragma once
 
+#include "flow_network.hpp"
 #include "../struct/integer_lists.hpp" // linked_lists
 
 /**
  * Push relabel with highest label selection rule, gap and global relabeling heuristics
  * Also known as Preflow-Push (GAP)
+ * Solves can be warm started: after set_capacity() or add() the next maxflow() with the
+ * same s and t covers the deficits left by set_capacity() and resumes from the preflow.
  * Complexity: O(V^2 E^1/2)
  */
 template <typename Flow = long, typename FlowSum = Flow>
 struct push_relabel {
-    struct Edge {
-        int node[2];
-        Flow cap, flow = 0;
-    };
-    int V, E = 0;
-    vector<vector<int>> res;
-    vector<Edge> edge;
-
-    explicit push_relabel(int V) : V(V), res(V) {}
-
-    void add(int u, int v, Flow capacity) {
-        assert(0 <= u && u < V && 0 <= v && v < V && capacity >= 0);
-        res[u].push_back(E++), edge.push_back({{u, v}, capacity, 0});
-        res[v].push_back(E++), edge.push_back({{v, u}, 0, 0});
+    int V;
+    flow_network<Flow> net;
+
+    explicit push_relabel(int V) : V(V), net(V) {}
+
+    int add(int u, int v, Flow capacity) { return net.add(u, v, capacity); }
+
+    void set_capacity(int e, Flow capacity) {
+        if (Flow removed = net.set_capacity(e, capacity); removed > 0) {
+            auto [u, v] = net.ends[e];
+            excess[u] += removed, excess[v] -= removed;
+        }
     }
 
     vector<int> height, arc, bfs;
@@ -32,16 +33,16 @@ struct push_relabel {
     static constexpr FlowSum flowsuminf = numeric_limits<FlowSum>::max() / 2;
 
     int global_relabel_threshold() const {
-        return 1 + 5 * int(ceil(log2(E + 1) / log2(V + 1) * V));
+        return 1 + 5 * int(ceil(log2(net.E + 1) / log2(V + 1) * V));
     }
 
     auto reverse_bfs(vector<int>& height_map) {
         int j = 0, S = 1;
         while (j < S) {
             int v = bfs[j++];
-            for (int e : res[v]) {
-                int u = edge[e].node[1], r = e ^ 1;
-                if (edge[r].flow < edge[r].cap && height_map[u] == 2 * V) {
+            for (int a = net.off[v]; a < net.off[v + 1]; a++) {
+                int u = net.head[a];
+                if (net.res[net.rev[a]] > 0 && height_map[u] == 2 * V) {
                     height_map[u] = height_map[v] + 1;
                     bfs[S++] = u;
                 }
@@ -72,7 +73,7 @@ struct push_relabel {
         for (int i = 0; i < S; i++) {
             int u = bfs[i];
             height[u] = new_height[u];
-            if (excess[u] > 0) {
+            if (excess[u] > 0 && u != s) {
                 active.erase(u), active.push_back(height[u], u);
             }
             if (sink && 0 < height[u] && height[u] < V) {
@@ -81,15 +82,15 @@ struct push_relabel {
         }
     }
 
-    void push(int e) {
-        auto [u, v] = edge[e].node;
-        Flow df = min(excess[u], FlowSum(edge[e].cap - edge[e].flow));
+    void push(int u, int a) {
+        int v = net.head[a];
+        Flow df = min(excess[u], FlowSum(net.res[a]));
         assert(df > 0);
         if (excess[v] == 0) {
             active.push_back(height[v], v);
         }
-        edge[e].flow += df;
-        edge[e ^ 1].flow -= df;
+        net.res[a] -= df;
+        net.res[net.rev[a]] += df;
         excess[u] -= df;
         excess[v] += df;
     }
@@ -102,11 +103,11 @@ struct push_relabel {
         }
         assert(height[u] == b);
         height[u] = 2 * V;
-        for (int i = 0, vsize = res[u].size(); i < vsize; i++) {
-            int e = res[u][i], v = edge[e].node[1];
-            if (edge[e].flow < edge[e].cap && height[u] > height[v] + 1) {
+        for (int a = net.off[u]; a < net.off[u + 1]; a++) {
+            int v = net.head[a];
+            if (net.res[a] > 0 && height[u] > height[v] + 1) {
                 height[u] = height[v] + 1;
-                arc[u] = i;
+                arc[u] = a;
             }
         }
         if (sink && height[u] < V) {
@@ -126,43 +127,55 @@ struct push_relabel {
             } else {
                 labeled.push_back(height[u], u);
             }
+        } else if (sink) {
+            active.push_back(height[u], u); // left for the recover phase
         }
         b = height[u];
     }
 
     template <bool sink> // 1=push phase (heights<V), 0=recover phase (heights>V)
     void discharge(int u) {
-        int& i = arc[u];
-        int vsize = res[u].size();
+        int& a = arc[u];
+        int end = net.off[u + 1];
         while (excess[u] > 0) {
-            if (i == vsize) {
+            if (a == end) {
                 relabel<sink>(u);
                 if (sink && height[u] >= V) {
                     return;
                 }
             }
-            int e = res[u][i], v = edge[e].node[1];
-            if (edge[e].flow < edge[e].cap && height[u] > height[v]) {
-                push(e);
+            if (net.res[a] > 0 && height[u] > height[net.head[a]]) {
+                push(u, a);
             }
-            i += excess[u] > 0;
+            a += excess[u] > 0;
         }
     }
 
     FlowSum maxflow(int s, int t, bool value_only = true) {
+        net.freeze();
         bfs.assign(V, -1);
-        excess.assign(V, 0);
-        arc.assign(V, 0);
+        excess.resize(V, 0);
+        arc.assign(begin(net.off), end(net.off) - 1);
         active.assign(2 * V + 1, V);
         labeled.assign(V, V);
 
+        for (int u = 0; u < V; u++) {
+            if (u != s && u != t && excess[u] < 0) {
+                net.template reroute<false>(u, excess, s);
+            }
+        }
         init_bfs(s, t);
         relabel_count = 0;
 
+        for (int u = 0; u < V; u++) {
+            if (u != s && u != t && excess[u] > 0) {
+                active.push_back(height[u], u);
+            }
+        }
         excess[s] = flowsuminf;
-        for (int e : res[s]) {
-            if (edge[e].cap > 0)
-                push(e);
+        for (int a = net.off[s]; a < net.off[s + 1]; a++) {
+            if (net.res[a] > 0)
+                push(s, a);
         }
         const int threshold = global_relabel_threshold();
 
@@ -183,9 +196,15 @@ struct push_relabel {
             discharge<1>(u);
         }
 
-        if (value_only)
+        if (value_only) { // exact labels, nodes that cannot reach t get 2V
+            height.assign(V, 2 * V), height[t] = 0, bfs[0] = t;
+            reverse_bfs(height);
             return excess[t];
+        }
 
+        // the gap heuristic parks nodes at height V, lift them above the source
+        relabel_count = 0;
+        global_relabel<0>(s, t);
         b = 2 * V - 1;
         while (true) {
             if (relabel_count >= threshold) {
@@ -193,9 +212,9 @@ struct push_relabel {
                 global_relabel<0>(s, t);
                 b = 2 * V - 1;
             }
-            while (b > V && active.empty(b))
+            while (b >= V && active.empty(b)) // parked nodes can still receive excess
                 b--;
-            if (b <= V)
+            if (b < V)
                 break;
             int u = active.head(b);
             active.pop_front(b);
@@ -205,6 +224,6 @@ struct push_relabel {
         return excess[t];
     }
 
-    Flow get_flow(int e) const { return edge[2 * e].flow; }
+    Flow get_flow(int e) const { return net.get_flow(e); }
     bool left_of_mincut(int u) const { return height[u] >= V; }
 };
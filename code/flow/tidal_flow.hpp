@@ -1,7 +1,6 @@
 #pragma once
 
-#include <bits/stdc++.h>
-using namespace std;
+#include "flow_network.hpp"
 
 /**
  * Simple tidal flow algorithm
@@ -11,44 +10,36 @@ using namespace std;
  */
 template <typename Flow = long, typename FlowSum = Flow>
 struct tidal_flow {
-    struct Edge {
-        int node[2];
-        Flow cap, flow = 0;
-    };
-    int V, E = 0;
-    vector<vector<int>> res;
-    vector<Edge> edge;
+    int V;
+    flow_network<Flow> net;
 
-    explicit tidal_flow(int V) : V(V), res(V) {}
+    explicit tidal_flow(int V) : V(V), net(V) {}
 
-    void add(int u, int v, Flow capacity) {
-        assert(0 <= u && u < V && 0 <= v && v < V && capacity >= 0);
-        res[u].push_back(E++), edge.push_back({{u, v}, capacity, 0});
-        res[v].push_back(E++), edge.push_back({{v, u}, 0, 0});
-    }
+    void add(int u, int v, Flow capacity) { net.add(u, v, capacity); }
 
-    vector<int> level, edges, Q;
+    vector<int> level, Q;
+    vector<array<int, 2>> arcs; // (tail, arc) of the level graph in bfs order
     vector<Flow> p;
     vector<FlowSum> h, l;
     static constexpr FlowSum flowsuminf = numeric_limits<FlowSum>::max() / 2;
 
     bool bfs(int s, int t) {
         level.assign(V, -1);
-        edges.clear();
+        arcs.clear();
         level[s] = 0;
         Q[0] = s;
         int i = 0, S = 1;
         while (i < S && level[Q[i]] != level[t]) {
             int u = Q[i++];
-            for (int e : res[u]) {
-                int v = edge[e].node[1];
-                if (edge[e].flow < edge[e].cap) {
+            for (int a = net.off[u]; a < net.off[u + 1]; a++) {
+                int v = net.head[a];
+                if (net.res[a] > 0) {
                     if (level[v] == -1) {
                         level[v] = level[u] + 1;
                         Q[S++] = v;
                     }
                     if (level[v] == level[u] + 1) {
-                        edges.push_back(e);
+                        arcs.push_back({u, a});
                     }
                 }
             }
@@ -59,40 +50,41 @@ struct tidal_flow {
     FlowSum tide(int s, int t) {
         fill(begin(h), end(h), 0);
         h[s] = flowsuminf;
-        for (int e : edges) {
-            auto [w, v] = edge[e].node;
-            p[e] = min(FlowSum(edge[e].cap - edge[e].flow), h[w]);
-            h[v] = h[v] + p[e];
+        for (int i = 0, S = arcs.size(); i < S; i++) {
+            auto [w, a] = arcs[i];
+            p[i] = min(FlowSum(net.res[a]), h[w]);
+            h[net.head[a]] += p[i];
         }
         if (h[t] == 0) {
             return 0;
         }
         fill(begin(l), end(l), 0);
         l[t] = h[t];
-        for (auto it = edges.rbegin(); it != edges.rend(); it++) {
-            int e = *it;
-            auto [w, v] = edge[e].node;
-            p[e] = min(FlowSum(p[e]), min(h[w] - l[w], l[v]));
-            l[v] -= p[e];
-            l[w] += p[e];
+        for (int i = int(arcs.size()) - 1; i >= 0; i--) {
+            auto [w, a] = arcs[i];
+            int v = net.head[a];
+            p[i] = min(FlowSum(p[i]), min(h[w] - l[w], l[v]));
+            l[v] -= p[i];
+            l[w] += p[i];
         }
         fill(begin(h), end(h), 0);
         h[s] = l[s];
-        for (auto e : edges) {
-            auto [w, v] = edge[e].node;
-            p[e] = min(FlowSum(p[e]), h[w]);
-            h[w] -= p[e];
-            h[v] += p[e];
-            edge[e].flow += p[e];
-            edge[e ^ 1].flow -= p[e];
+        for (int i = 0, S = arcs.size(); i < S; i++) {
+            auto [w, a] = arcs[i];
+            p[i] = min(FlowSum(p[i]), h[w]);
+            h[w] -= p[i];
+            h[net.head[a]] += p[i];
+            net.res[a] -= p[i];
+            net.res[net.rev[a]] += p[i];
         }
         return h[t];
     }
 
     FlowSum maxflow(int s, int t) {
+        net.freeze();
         h.assign(V, 0);
         l.assign(V, 0);
-        p.assign(E, 0);
+        p.assign(net.A, 0);
         Q.resize(V);
         FlowSum max_flow = 0, df;
         while (bfs(s, t)) {
@@ -104,6 +96,6 @@ struct tidal_flow {
         return max_flow;
     }
 
-    Flow get_flow(int e) const { return edge[2 * e].flow; }
+    Flow get_flow(int e) const { return net.get_flow(e); }
     bool left_of_mincut(int u) const { return level[u] >= 0; }
 };
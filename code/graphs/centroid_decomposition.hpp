@@ -1,57 +1,100 @@
 #pragma once
 
-#include "../struct/y_combinator.hpp"
+#include "../parallel/thread_pool.hpp" // thread_pool, parallel_for
 
 /**
- * Centroid decomposition (1-indexed)
+ * Centroid decomposition of a forest (0-indexed, any unused vertex is a lone tree)
+ * Iterative, pieces are processed level by level. The pieces of a level are disjoint
+ * subtrees separated by centroids already found, so they are processed in parallel: a
+ * bfs from the piece's root computes the subtree sizes and the centroid is found by
+ * walking down towards the heavy child. The unmarked neighbours of the centroids are the
+ * roots of the next level's pieces.
+ * The vertices are first relabeled in dfs preorder into flat adjacency arrays, so that
+ * most pieces are contiguous in memory.
+ * Returns the centroid parent (-1 for the top centroid of each tree) and the centroid
+ * depth of every vertex.
+ * Complexity: O(V log V)
  */
-auto build_tree_centroid_decomposition(const vector<vector<int>>& tree) {
-    int V = tree.size();
-    vector<int> subsize(V);
-    vector<int> cparent(V);
-    vector<int> parent(V);
-    vector<int> bfs(V);
-    vector<bool> mark(V, false);
+auto build_tree_centroid_decomposition(const vector<vector<int>>& tree,
+                                       int nthreads = 1) {
+    int V = tree.size(), T = nthreads;
+    assert(T > 0);
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
 
-    for (int s = 1; s < V; s++) {
-        while (!mark[s]) {
-            parent[s] = -1;
-            bfs[0] = s;
-            int i = 0, S = 1, link = -1;
-
-            while (i < S) {
-                int u = bfs[i++];
+    // level 0 has one piece {root, centroid parent} per tree
+    vector<int> id(V, -1), of(V), off(V + 1), adj, parent(V, -1), subsize(V);
+    vector<array<int, 2>> pieces, next;
+    vector<vector<int>> bfs(T);
+    for (int s = 0, timer = 0; s < V; s++) {
+        if (id[s] == -1) {
+            pieces.push_back({timer, -1});
+            auto& stack = bfs[0];
+            stack.assign(1, s);
+            while (!stack.empty()) {
+                int u = stack.back();
+                stack.pop_back();
+                of[timer] = u, id[u] = timer++;
                 for (int v : tree[u]) {
-                    if (v != parent[u] && !mark[v]) {
-                        parent[v] = u;
-                        bfs[S++] = v;
-                    } else if (mark[v]) {
-                        link = v;
+                    if (v != parent[u]) {
+                        parent[v] = u, stack.push_back(v);
                     }
                 }
             }
+        }
+    }
+    adj.reserve(2 * V);
+    for (int i = 0; i < V; i++) {
+        for (int v : tree[of[i]]) {
+            adj.push_back(id[v]);
+        }
+        off[i + 1] = adj.size();
+    }
 
-            for (i = S - 1; i >= 0; i--) {
-                int u = bfs[i];
+    vector<int> cparent(V, -1), cdepth(V, -1), found;
+    vector<char> mark(V, false);
+    for (int depth = 0; !pieces.empty(); depth++) {
+        int N = pieces.size(), grain = max(1, N / (16 * T));
+        found.resize(N);
+        parallel_for(P, T, N, grain, [&](int t, int k) {
+            auto [root, up] = pieces[k];
+            auto& q = bfs[t];
+            q.assign(1, root), parent[root] = -1;
+            for (int i = 0; i < int(q.size()); i++) {
+                int u = q[i];
                 subsize[u] = 1;
-                bool is = true;
-                for (int v : tree[u]) {
-                    if (v != parent[u] && !mark[v]) {
-                        subsize[u] += subsize[v];
-                        is &= subsize[v] <= S / 2;
+                for (int e = off[u]; e < off[u + 1]; e++) {
+                    if (int v = adj[e]; !mark[v] && v != parent[u]) {
+                        parent[v] = u, q.push_back(v);
                     }
                 }
-                is &= S - subsize[u] <= S / 2;
-                if (is) {
-                    mark[u] = true;
-                    cparent[u] = link;
-                    break;
+            }
+            int S = q.size(), c = root;
+            for (int i = S - 1; i > 0; i--) {
+                subsize[parent[q[i]]] += subsize[q[i]];
+            }
+            for (int e = off[c]; e < off[c + 1]; e++) {
+                if (int v = adj[e]; !mark[v] && v != parent[c] && subsize[v] > S / 2) {
+                    c = v, e = off[c] - 1;
+                }
+            }
+            mark[c] = true, cparent[c] = up, cdepth[c] = depth, found[k] = c;
+        });
+        next.clear();
+        for (int c : found) {
+            for (int e = off[c]; e < off[c + 1]; e++) {
+                if (!mark[adj[e]]) {
+                    next.push_back({adj[e], c});
                 }
             }
-
-            assert(i >= 0);
         }
+        swap(pieces, next);
     }
 
-    return cparent;
+    // back to the original labels
+    for (int i = 0; i < V; i++) {
+        parent[of[i]] = cparent[i] == -1 ? -1 : of[cparent[i]];
+        subsize[of[i]] = cdepth[i];
+    }
+    return make_pair(move(parent), move(subsize));
 }
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <bits/stdc++.h>
+using namespace std;
+
+/**
+ * Contraction hierarchies for repeated shortest path queries on a static directed graph
+ * with non-negative costs (Geisberger et al.)
+ *
+ * Preprocessing contracts the nodes in order of priority: edge difference (shortcuts
+ * added minus arcs removed) plus the number of contracted neighbours, updated lazily.
+ * Contracting v adds a shortcut u->x for every pair of arcs u->v->x unless a witness
+ * search from u that avoids v finds a path that is not longer. Witness searches stop
+ * once every head out of v is settled and settle at most WITNESS_SETTLE nodes, or
+ * SIMULATE_SETTLE when only counting shortcuts for the priority; a missed witness only
+ * costs an extra shortcut.
+ * A node keeps its arcs to higher ranked nodes: up[0] the outgoing ones, up[1] the
+ * incoming ones reversed.
+ *
+ * query(s,t): bidirectional dijkstra that only goes up, forwards from s on up[0] and
+ *     backwards from t on up[1], pruned once a side's smallest key reaches the best.
+ * many_to_many(S,T): backward searches from every target fill buckets at the nodes they
+ *     settle, then forward searches from every source scan the buckets of their nodes.
+ *     Returns the row-major |S|x|T| matrix.
+ *
+ * Usage:
+ *   contraction_hierarchy<int, long> ch(adj); // same adjacency format as dijkstra
+ *   auto d = ch.query(s, t);
+ */
+template <typename Cost = long, typename CostSum = Cost>
+struct contraction_hierarchy {
+    static constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
+    static constexpr int WITNESS_SETTLE = 500, SIMULATE_SETTLE = 50;
+
+    int V;
+    vector<int> rank, off[2];
+    vector<pair<int, CostSum>> up[2];
+    long shortcuts = 0;
+
+    explicit contraction_hierarchy(const vector<vector<pair<int, Cost>>>& adj)
+        : V(adj.size()), rank(V, -1), out(V), in(V), dist(V, inf), seen(V), target(V) {
+        for (int u = 0; u < V; u++) {
+            for (auto [v, w] : adj[u]) {
+                assert(0 <= v && v < V && w >= 0);
+                if (u != v) {
+                    add_arc(u, v, w);
+                }
+            }
+        }
+        contract_all();
+    }
+
+    CostSum query(int s, int t) {
+        next_query();
+        CostSum best = s == t ? 0 : inf;
+        reach(0, s, 0), reach(1, t, 0);
+        while (!heap[0].empty() || !heap[1].empty()) {
+            for (int side : {0, 1}) {
+                if (heap[side].empty()) {
+                    continue;
+                }
+                auto [d, u] = pop(side);
+                if (d >= best) {
+                    heap[side].clear(); // nothing better on this side
+                    continue;
+                }
+                if (d > get(side, u)) {
+                    continue;
+                }
+                if (CostSum other = get(!side, u); other < inf) {
+                    best = min(best, d + other);
+                }
+                relax_up(side, u, d);
+            }
+        }
+        return best;
+    }
+
+    auto many_to_many(const vector<int>& sources, const vector<int>& targets) {
+        int S = sources.size(), T = targets.size();
+        vector<CostSum> ans(1L * S * T, inf);
+        vector<vector<pair<int, CostSum>>> bucket(V);
+        vector<int> touched;
+        for (int j = 0; j < T; j++) {
+            upward_search(1, targets[j], [&](int v, CostSum d) {
+                if (bucket[v].empty()) {
+                    touched.push_back(v);
+                }
+                bucket[v].push_back({j, d});
+            });
+        }
+        for (int i = 0; i < S; i++) {
+            CostSum* row = &ans[1L * i * T];
+            upward_search(0, sources[i], [&](int v, CostSum d) {
+                for (auto [j, dt] : bucket[v]) {
+                    row[j] = min(row[j], d + dt);
+                }
+            });
+        }
+        for (int v : touched) {
+            bucket[v].clear();
+        }
+        return ans;
+    }
+
+  private:
+    // contraction graph, arcs between nodes not yet contracted
+    vector<vector<pair<int, CostSum>>> out, in;
+    vector<int> contracted_neighbours;
+
+    // searches, stamped and reset lazily
+    vector<CostSum> dist, query_dist[2];
+    vector<int> seen, target, query_seen[2];
+    vector<pair<CostSum, int>> heap[2];
+    int stamp = 0;
+
+    static void set_min(vector<pair<int, CostSum>>& list, int v, CostSum w) {
+        for (auto& [x, c] : list) {
+            if (x == v) {
+                c = min(c, w);
+                return;
+            }
+        }
+        list.push_back({v, w});
+    }
+
+    void add_arc(int u, int v, CostSum w) {
+        set_min(out[u], v, w), set_min(in[v], u, w);
+    }
+
+    static void erase_node(vector<pair<int, CostSum>>& list, int v) {
+        for (int i = 0, S = list.size(); i < S; i++) {
+            if (list[i].first == v) {
+                swap(list[i], list.back()), list.pop_back();
+                return;
+            }
+        }
+    }
+
+    void next_stamp() {
+        if (++stamp == INT_MAX) {
+            fill(begin(seen), end(seen), 0), fill(begin(target), end(target), 0);
+            for (int side : {0, 1}) {
+                fill(begin(query_seen[side]), end(query_seen[side]), 0);
+            }
+            stamp = 1;
+        }
+    }
+
+    // dijkstra from u avoiding v in the contraction graph, until the targets out of v are
+    // settled, the distance passes limit or cap nodes are settled
+    void witness_search(int u, int v, CostSum limit, int cap) {
+        next_stamp();
+        int targets = 0;
+        for (auto [x, w] : out[v]) {
+            targets += x != u && target[x] != stamp;
+            target[x] = stamp;
+        }
+        auto& Q = heap[0];
+        Q.clear();
+        seen[u] = stamp, dist[u] = 0, Q.push_back({0, u});
+        for (int settled = 0; !Q.empty() && settled < cap && targets > 0; settled++) {
+            pop_heap(begin(Q), end(Q), greater<>{});
+            auto [d, x] = Q.back();
+            Q.pop_back();
+            if (d > dist[x]) {
+                settled--;
+                continue;
+            }
+            if (d > limit) {
+                break;
+            }
+            targets -= x != u && target[x] == stamp;
+            for (auto [y, w] : out[x]) {
+                if (y != v && (seen[y] != stamp || d + w < dist[y])) {
+                    seen[y] = stamp, dist[y] = d + w;
+                    Q.push_back({d + w, y});
+                    push_heap(begin(Q), end(Q), greater<>{});
+                }
+            }
+        }
+    }
+
+    // shortcuts needed to contract v, added if apply else only counted
+    int contract(int v, bool apply) {
+        CostSum max_out = 0;
+        for (auto [x, w] : out[v]) {
+            max_out = max(max_out, w);
+        }
+        int added = 0;
+        for (auto [u, wu] : in[v]) {
+            witness_search(u, v, wu + max_out, apply ? WITNESS_SETTLE : SIMULATE_SETTLE);
+            for (auto [x, wx] : out[v]) {
+                if (x != u && (seen[x] != stamp || dist[x] > wu + wx)) {
+                    added++;
+                    if (apply) {
+                        add_arc(u, x, wu + wx), shortcuts++;
+                    }
+                }
+            }
+        }
+        return added;
+    }
+
+    int priority(int v) {
+        int removed = out[v].size() + in[v].size();
+        return contract(v, false) - removed + contracted_neighbours[v];
+    }
+
+    void contract_all() {
+        contracted_neighbours.assign(V, 0);
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<>> order;
+        for (int v = 0; v < V; v++) {
+            order.push({priority(v), v});
+        }
+        vector<vector<pair<int, CostSum>>> keep[2];
+        keep[0].resize(V), keep[1].resize(V);
+        for (int r = 0; r < V; r++) {
+            // lazy update, contract the top only if it is still the minimum
+            int v = order.top().second;
+            order.pop();
+            for (int p = priority(v); !order.empty() && p > order.top().first;) {
+                order.push({p, v});
+                v = order.top().second;
+                order.pop();
+                p = priority(v);
+            }
+            rank[v] = r;
+            contract(v, true);
+            for (auto [x, w] : out[v]) {
+                erase_node(in[x], v), contracted_neighbours[x]++;
+            }
+            for (auto [u, w] : in[v]) {
+                erase_node(out[u], v), contracted_neighbours[u]++;
+            }
+            keep[0][v] = move(out[v]), keep[1][v] = move(in[v]);
+        }
+        for (int side : {0, 1}) {
+            off[side].assign(V + 1, 0);
+            up[side].clear();
+            for (int v = 0; v < V; v++) {
+                up[side].insert(end(up[side]), begin(keep[side][v]), end(keep[side][v]));
+                off[side][v + 1] = up[side].size();
+            }
+            query_dist[side].assign(V, inf), query_seen[side].assign(V, 0);
+        }
+        out.clear(), in.clear(), out.shrink_to_fit(), in.shrink_to_fit();
+    }
+
+    void next_query() {
+        next_stamp();
+        heap[0].clear(), heap[1].clear();
+    }
+
+    CostSum get(int side, int v) const {
+        return query_seen[side][v] == stamp ? query_dist[side][v] : inf;
+    }
+
+    void reach(int side, int v, CostSum d) {
+        query_seen[side][v] = stamp, query_dist[side][v] = d;
+        heap[side].push_back({d, v});
+        push_heap(begin(heap[side]), end(heap[side]), greater<>{});
+    }
+
+    pair<CostSum, int> pop(int side) {
+        pop_heap(begin(heap[side]), end(heap[side]), greater<>{});
+        auto top = heap[side].back();
+        heap[side].pop_back();
+        return top;
+    }
+
+    void relax_up(int side, int u, CostSum d) {
+        for (int a = off[side][u]; a < off[side][u + 1]; a++) {
+            auto [v, w] = up[side][a];
+            if (d + w < get(side, v)) {
+                reach(side, v, d + w);
+            }
+        }
+    }
+
+    // complete upward search from s, fn(v, d) for every settled node
+    template <typename Fn>
+    void upward_search(int side, int s, Fn&& fn) {
+        next_query();
+        reach(side, s, 0);
+        while (!heap[side].empty()) {
+            auto [d, u] = pop(side);
+            if (d > get(side, u)) {
+                continue;
+            }
+            fn(u, d);
+            relax_up(side, u, d);
+        }
+    }
+};
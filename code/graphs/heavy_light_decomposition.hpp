@@ -1,49 +1,101 @@
 #pragma once
 
-#include "../struct/y_combinator.hpp"
+#include <bits/stdc++.h>
+using namespace std;
 
-auto build_tree_heavy_light_decomposition(vector<vector<int>>& tree, int root) {
-    int V = tree.size();
-    vector<int> subsize(V);
-    vector<int> heavy(V, -1);
-    vector<int> parent(V);
-    vector<int> depth(V);
-    vector<int> head(V);
-    vector<int> tin(V);
-    vector<int> tout(V);
-    int timer = 0;
-
-    auto dfs = y_combinator([&](auto self, int u, int p) -> void {
-        subsize[u] = 1;
-        int largest = 0;
-        for (int& v : tree[u]) {
-            if (v != p) {
-                parent[v] = u;
-                depth[v] = depth[u] + 1;
-                self(v, u);
-                subsize[u] += subsize[v];
-                if (largest < subsize[v]) {
-                    largest = subsize[v];
-                    heavy[u] = v;
-                    swap(tree[u][0], v);
-                }
+/**
+ * Heavy-light decomposition of a rooted tree, flat arrays (0-indexed)
+ * Vertices are laid out in a preorder that visits the heavy child first, so every heavy
+ * path and every subtree is a contiguous range of positions: subtree of u is [tin,tout).
+ * heavy[u] is the child of u with the largest subtree (-1 for leaves) and head[u] the top
+ * of u's heavy path.
+ */
+struct heavy_light_decomposition {
+    vector<int> parent, depth, heavy, head, tin, tout;
+
+    int lca(int u, int v) const {
+        while (head[u] != head[v]) {
+            if (depth[head[u]] < depth[head[v]]) {
+                swap(u, v);
+            }
+            u = parent[head[u]];
+        }
+        return depth[u] < depth[v] ? u : v;
+    }
+
+    /**
+     * Call fn(L,R) for each range of positions [L,R) covering the path u-v, O(log V)
+     * of them, bottom-up from either endpoint. With edges=true the lca is left out, so
+     * that a position stands for the edge to the parent.
+     */
+    template <typename Fn>
+    void for_each_path_segment(int u, int v, Fn&& fn, bool edges = false) const {
+        while (head[u] != head[v]) {
+            if (depth[head[u]] < depth[head[v]]) {
+                swap(u, v);
             }
+            fn(tin[head[u]], tin[u] + 1);
+            u = parent[head[u]];
+        }
+        if (depth[u] > depth[v]) {
+            swap(u, v);
         }
-    });
+        if (tin[u] + edges <= tin[v]) {
+            fn(tin[u] + edges, tin[v] + 1);
+        }
+    }
+};
 
-    auto decompose = y_combinator([&](auto self, int u, int h, int p) -> void {
-        head[u] = h;
-        tin[u] = timer++;
+/**
+ * Build the heavy-light decomposition without recursion and without touching the tree
+ * Complexity: O(V)
+ */
+auto build_tree_heavy_light_decomposition(const vector<vector<int>>& tree, int root) {
+    int V = tree.size();
+    heavy_light_decomposition hld;
+    auto& [parent, depth, heavy, head, tin, tout] = hld;
+    parent.assign(V, -1), depth.assign(V, 0), heavy.assign(V, -1);
+    head.assign(V, root), tin.assign(V, 0), tout.assign(V, 0);
+
+    // bfs order, then subtree sizes (kept in tout) and heavy children bottom-up
+    vector<int> order = {root};
+    order.reserve(V);
+    for (int i = 0; i < int(order.size()); i++) {
+        int u = order[i];
         for (int v : tree[u]) {
-            if (v != p) {
-                self(v, v == heavy[u] ? u : v, u);
+            if (v != parent[u]) {
+                parent[v] = u, depth[v] = depth[u] + 1, order.push_back(v);
+            }
+        }
+    }
+    int S = order.size();
+    for (int i = S - 1; i >= 0; i--) {
+        int u = order[i], p = parent[u];
+        tout[u] += 1;
+        if (p != -1) {
+            tout[p] += tout[u];
+            if (heavy[p] == -1 || tout[heavy[p]] < tout[u]) {
+                heavy[p] = u;
             }
         }
-        tout[u] = timer;
-    });
+    }
 
-    dfs(root, -1);
-    decompose(root, root, -1);
+    // preorder with an explicit stack, the heavy child is pushed last so it comes next
+    vector<int>& stack = order;
+    stack.assign(1, root);
+    for (int timer = 0; !stack.empty();) {
+        int u = stack.back();
+        stack.pop_back();
+        tin[u] = timer++, tout[u] += tin[u];
+        for (int v : tree[u]) {
+            if (v != parent[u] && v != heavy[u]) {
+                head[v] = v, stack.push_back(v);
+            }
+        }
+        if (heavy[u] != -1) {
+            head[heavy[u]] = head[u], stack.push_back(heavy[u]);
+        }
+    }
 
-    return make_tuple(move(parent), move(depth), move(head), move(tin), move(tout));
+    return hld;
 }
@@ -1,46 +1,282 @@
 #pragma once
 
 #include "../hash.hpp"
-#include "../linear/matrix.hpp"
+#include "../struct/y_combinator.hpp"
+#include "../parallel/thread_pool.hpp" // thread_pool, parallel_for
 
 using edges_t = vector<array<int, 2>>;
 
 /**
- * Compute topological hash of a general graph, based on number of paths of length V
- * between every pair of vertices.
- * Complexity: O(V^3 log(V)) time
- *             O(V^2) memory
+ * Canonical colour refinement (1-WL) by partition refinement
+ * The vertices sit in one array split into cells, a cell is named by its start position.
+ * A queue of splitter cells is processed in order: every cell is split by the number of
+ * neighbours its vertices have in the splitter, the parts are laid out by increasing
+ * count, and all the parts but the largest are queued (all of them if the cell was queued
+ * already). Touched cells are handled in position order, so the final partition and
+ * its cell names depend only on the graph, not on its labels: it is the coarsest
+ * equitable partition, with vertices of the same cell having the same neighbour counts
+ * in every cell.
+ * Multi-edges count with multiplicity.
+ * Complexity: O((V+E) log^2 V)
+ */
+struct color_refinement {
+    int V;
+    vector<int> off, adj;
+    vector<int> order, pos, cell, cell_end; // cell[v]: start of v's cell
+
+    color_refinement(int V, const edges_t& g)
+        : V(V), off(V + 1), adj(2 * g.size()), order(V), pos(V), cell(V, 0),
+          cell_end(V, V), queued(V), cnt(V) {
+        for (auto [u, v] : g) {
+            off[u + 1]++, off[v + 1]++;
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        vector<int> at(begin(off), end(off) - 1);
+        for (auto [u, v] : g) {
+            adj[at[u]++] = v, adj[at[v]++] = u;
+        }
+        iota(begin(order), end(order), 0);
+        iota(begin(pos), end(pos), 0);
+        if (V > 0) {
+            push(0), refine();
+        }
+    }
+
+    bool discrete() const {
+        for (int s = 0; s < V; s = cell_end[s]) {
+            if (cell_end[s] - s > 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // make v a cell of its own and refine again
+    void individualize(int v) {
+        int s = cell[v], e = cell_end[s];
+        if (e - s == 1) {
+            return;
+        }
+        swap_to(v, s);
+        cell_end[s] = s + 1, cell_end[s + 1] = e;
+        for (int i = s + 1; i < e; i++) {
+            cell[order[i]] = s + 1;
+        }
+        if (queued[s]) {
+            push(s + 1);
+        } else {
+            push(e - s == 2 ? s + 1 : s);
+        }
+        refine();
+    }
+
+    // hash of the cells and of the quotient graph, equal for isomorphic graphs
+    size_t invariant() const {
+        static hash<vector<int>> hasher;
+        size_t h = V;
+        vector<int> row;
+        for (int s = 0; s < V; s = cell_end[s]) {
+            row.clear();
+            for (int e = off[order[s]]; e < off[order[s] + 1]; e++) {
+                row.push_back(cell[adj[e]]);
+            }
+            sort(begin(row), end(row));
+            row.push_back(s), row.push_back(cell_end[s]);
+            h ^= hasher(row) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+
+    // hash of each vertex's cell, equal for vertices mapped by an isomorphism
+    auto vertex_hashes() const {
+        static hash<vector<int>> hasher;
+        vector<size_t> cell_hash(V), hashes(V);
+        vector<int> row;
+        for (int s = 0; s < V; s = cell_end[s]) {
+            row.clear();
+            for (int e = off[order[s]]; e < off[order[s] + 1]; e++) {
+                row.push_back(cell[adj[e]]);
+            }
+            sort(begin(row), end(row));
+            row.push_back(s), row.push_back(cell_end[s]);
+            cell_hash[s] = hasher(row);
+        }
+        for (int v = 0; v < V; v++) {
+            hashes[v] = cell_hash[cell[v]];
+        }
+        return hashes;
+    }
+
+  private:
+    vector<int> pending, touched, parts;
+    vector<char> queued;
+    vector<int> cnt;
+    int head = 0;
+
+    void push(int s) { queued[s] = 1, pending.push_back(s); }
+
+    void swap_to(int v, int i) {
+        int u = order[i], p = pos[v];
+        order[i] = v, pos[v] = i, order[p] = u, pos[u] = p;
+    }
+
+    void refine() {
+        while (head < int(pending.size())) {
+            int S = pending[head++];
+            queued[S] = 0;
+            touched.clear();
+            for (int i = S; i < cell_end[S]; i++) {
+                int v = order[i];
+                for (int e = off[v]; e < off[v + 1]; e++) {
+                    if (cnt[adj[e]]++ == 0) {
+                        touched.push_back(adj[e]);
+                    }
+                }
+            }
+            sort(begin(touched), end(touched), [&](int u, int v) {
+                return make_pair(cell[u], cnt[u]) < make_pair(cell[v], cnt[v]);
+            });
+            for (int a = 0, T = touched.size(); a < T;) {
+                int X = cell[touched[a]], b = a;
+                while (b < T && cell[touched[b]] == X) {
+                    b++;
+                }
+                split(X, a, b);
+                a = b;
+            }
+            for (int v : touched) {
+                cnt[v] = 0;
+            }
+        }
+        pending.clear(), head = 0;
+    }
+
+    // split cell X, touched[a,b) are its vertices with a neighbour in the splitter
+    void split(int X, int a, int b) {
+        int e = cell_end[X], k = b - a;
+        if (k == e - X && cnt[touched[a]] == cnt[touched[b - 1]]) {
+            return;
+        }
+        for (int j = 0; j < k; j++) {
+            swap_to(touched[a + j], e - k + j);
+        }
+        parts.clear();
+        if (e - k > X) {
+            parts.push_back(X);
+        }
+        for (int j = 0; j < k; j++) {
+            if (j == 0 || cnt[touched[a + j]] != cnt[touched[a + j - 1]]) {
+                parts.push_back(e - k + j);
+            }
+        }
+        parts.push_back(e);
+        int P = parts.size() - 1, largest = 0;
+        for (int i = 0; i < P; i++) {
+            int s = parts[i];
+            cell_end[s] = parts[i + 1];
+            for (int j = s; s != X && j < cell_end[s]; j++) {
+                cell[order[j]] = s;
+            }
+            if (cell_end[s] - s > cell_end[parts[largest]] - parts[largest]) {
+                largest = i;
+            }
+        }
+        bool was_queued = queued[X];
+        for (int i = 0; i < P; i++) {
+            if (was_queued ? i > 0 : i != largest) {
+                push(parts[i]);
+            }
+        }
+    }
+};
+
+/**
+ * Compute topological hash of each vertex of a general graph, from its cell in the
+ * colour refinement (isomorphic vertices get the same hash)
+ * Complexity: O((V+E) log^2 V)
  */
 auto hash_graph_vertices(int V, const edges_t& g) {
-    static hash<vector<size_t>> hasher;
-    mat<size_t> m({V, V});
-    for (auto [u, v] : g)
-        m[u][v] = m[v][u] = 1;
-    m = m ^ V;
-
-    vector<size_t> hashtable(V);
-    for (int n = 0; n < V; n++) {
-        vector<size_t> hashes(m[n], m[n + 1]);
-        sort(begin(hashes), end(hashes));
-        hashtable[n] = hasher(hashes);
-    }
-    return hashtable;
+    return color_refinement(V, g).vertex_hashes();
 }
 
 /**
  * Compute the topological hash of a graph, irrespective of its labels (0-indexed)
  */
 size_t hash_graph(int V, const edges_t& g) {
-    static hash<vector<size_t>> hasher;
-    auto hashtable = hash_graph_vertices(V, g);
-    sort(begin(hashtable), end(hashtable));
-    hashtable.push_back(V), hashtable.push_back(g.size());
-    return hasher(hashtable);
+    color_refinement cr(V, g);
+    return cr.invariant() ^ (g.size() << 32);
+}
+
+/**
+ * Hash many graphs (V, edges) in parallel, e.g. to deduplicate a corpus
+ */
+auto hash_graphs(const vector<pair<int, edges_t>>& graphs, int nthreads = 1) {
+    int T = nthreads, G = graphs.size();
+    assert(T > 0);
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
+    vector<size_t> hashes(G);
+    parallel_for(P, T, G, 1, [&](int, int i) {
+        hashes[i] = hash_graph(graphs[i].first, graphs[i].second);
+    });
+    return hashes;
 }
 
 /**
- * Isomorphism heuristic for two graphs (0-indexed)
+ * Exact isomorphism test of two graphs (0-indexed)
+ * The colour refinements are compared first. If they agree, search for an isomorphism by
+ * individualization-refinement: individualize the first vertex of the first non-trivial
+ * cell in the first graph against each vertex of that cell in the second, refine both and
+ * backtrack when the refinements differ. A discrete pair gives a candidate bijection,
+ * which is checked against the edges.
+ * Complexity: O((V+E) log^2 V) if the refinements differ, exponential worst case
  */
 bool isomorphic(int V, const edges_t& g1, const edges_t& g2) {
-    return g1.size() == g2.size() && hash_graph(V, g1) == hash_graph(V, g2);
+    if (g1.size() != g2.size()) {
+        return false;
+    }
+    color_refinement a(V, g1), b(V, g2);
+    if (a.invariant() != b.invariant()) {
+        return false;
+    }
+    vector<array<int, 2>> want;
+    for (auto [u, v] : g2) {
+        want.push_back({min(u, v), max(u, v)});
+    }
+    sort(begin(want), end(want));
+
+    auto check = [&](const color_refinement& x, const color_refinement& y) {
+        vector<int> to(V);
+        for (int i = 0; i < V; i++) {
+            to[x.order[i]] = y.order[i];
+        }
+        vector<array<int, 2>> got;
+        for (auto [u, v] : g1) {
+            got.push_back({min(to[u], to[v]), max(to[u], to[v])});
+        }
+        sort(begin(got), end(got));
+        return got == want;
+    };
+    auto search = y_combinator([&](auto self, const color_refinement& x,
+                                   const color_refinement& y) -> bool {
+        if (x.discrete()) {
+            return check(x, y);
+        }
+        int s = 0;
+        while (x.cell_end[s] - s == 1) {
+            s = x.cell_end[s];
+        }
+        color_refinement xi = x;
+        xi.individualize(x.order[s]);
+        size_t want_invariant = xi.invariant();
+        for (int i = s; i < y.cell_end[s]; i++) {
+            color_refinement yi = y;
+            yi.individualize(y.order[i]);
+            if (yi.invariant() == want_invariant && self(xi, yi)) {
+                return true;
+            }
+        }
+        return false;
+    });
+    return search(a, b);
 }
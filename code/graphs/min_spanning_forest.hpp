@@ -1,6 +1,7 @@
 #pragma once
 
-#include "../struct/disjoint_set.hpp" // disjoint_set
+#include "../struct/disjoint_set.hpp"  // disjoint_set, concurrent_disjoint_set
+#include "../parallel/thread_pool.hpp" // thread_pool, run_on_each_thread
 
 using edges_t = vector<array<int, 2>>;
 
@@ -70,3 +71,109 @@ long min_spanning_forest_dense(int V, const vector<vector<long>>& weight) {
     }
     return msf;
 }
+
+/**
+ * Label each node with the representative of its connected component.
+ * Labels are only meaningful when compared to each other.
+ * Complexity: O(V + E α(V))
+ */
+auto connected_components(int V, const edges_t& g) {
+    disjoint_set set(V);
+    for (auto [u, v] : g) {
+        set.join(u, v);
+    }
+    vector<int> comp(V);
+    for (int u = 0; u < V; u++) {
+        comp[u] = set.find(u);
+    }
+    return comp;
+}
+
+/**
+ * Same as connected_components, but the edges are split across nthreads threads that
+ * share a concurrent_disjoint_set.
+ */
+auto parallel_connected_components(int V, const edges_t& g, int nthreads) {
+    int E = g.size(), T = max(1, nthreads);
+    concurrent_disjoint_set set(V);
+    vector<int> comp(V);
+    thread_pool pool(T);
+
+    run_on_each_thread(&pool, T, [&](int t) {
+        for (int e = 1L * E * t / T, end = 1L * E * (t + 1) / T; e < end; e++) {
+            set.join(g[e][0], g[e][1]);
+        }
+    });
+    run_on_each_thread(&pool, T, [&](int t) {
+        for (int u = 1L * V * t / T, end = 1L * V * (t + 1) / T; u < end; u++) {
+            comp[u] = set.find(u);
+        }
+    });
+
+    pool.finish();
+    return comp;
+}
+
+/**
+ * Boruvka's algorithm, each round in two parallel phases: every thread scans its own
+ * list of live edges and proposes the lightest edge leaving each component (CAS on the
+ * component's best edge), then the proposed edges are joined in a concurrent dsu.
+ * Ties are broken by edge index, so all proposed edges belong to the same msf.
+ * Edges found inside a component are dropped from the thread's list for later rounds.
+ * Complexity: O(E log V / T)
+ */
+long min_spanning_forest_boruvka(int V, const edges_t& g, const vector<long>& weight,
+                                 int nthreads = 1) {
+    int E = g.size(), T = max(1, nthreads);
+    concurrent_disjoint_set set(V);
+    vector<atomic<int>> best(V);
+    vector<vector<int>> live(T);
+    vector<long> msf(T, 0);
+    atomic<bool> progress(true);
+    thread_pool pool(T);
+
+    auto lighter = [&](int a, int b) {
+        return b == -1 || weight[a] < weight[b] || (weight[a] == weight[b] && a < b);
+    };
+    auto propose = [&](int c, int e) {
+        int cur = best[c].load(memory_order_relaxed);
+        while (lighter(e, cur) && !best[c].compare_exchange_weak(cur, e)) {}
+    };
+
+    run_on_each_thread(&pool, T, [&](int t) {
+        for (int u = 1L * V * t / T, end = 1L * V * (t + 1) / T; u < end; u++) {
+            best[u].store(-1, memory_order_relaxed);
+        }
+        for (int e = 1L * E * t / T, end = 1L * E * (t + 1) / T; e < end; e++) {
+            live[t].push_back(e);
+        }
+    });
+
+    while (progress.exchange(false)) {
+        run_on_each_thread(&pool, T, [&](int t) {
+            int S = 0;
+            for (int e : live[t]) {
+                int cu = set.find(g[e][0]), cv = set.find(g[e][1]);
+                if (cu != cv) {
+                    propose(cu, e), propose(cv, e);
+                    live[t][S++] = e;
+                }
+            }
+            live[t].resize(S);
+        });
+        run_on_each_thread(&pool, T, [&](int t) {
+            for (int c = 1L * V * t / T, end = 1L * V * (t + 1) / T; c < end; c++) {
+                if (int e = best[c].load(memory_order_relaxed); e != -1) {
+                    if (set.join(g[e][0], g[e][1])) {
+                        msf[t] += weight[e];
+                        progress.store(true, memory_order_relaxed);
+                    }
+                    best[c].store(-1, memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    pool.finish();
+    return accumulate(begin(msf), end(msf), 0L);
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../hash.hpp"
+#include "../struct/disjoint_set.hpp"
+#include "../parallel/thread_pool.hpp" // thread_pool, run_on_each_thread, parallel_for
 
 using edges_t = vector<array<int, 2>>;
 using cut_t = vector<int>;
@@ -16,7 +18,7 @@ auto stoer_wagner(int V, const edges_t& g, const vector<long>& costs, int a = 0)
     for (int e = 0, E = g.size(); e < E; e++) {
         auto [u, v] = g[e];
         adj[u].insert(v), adj[v].insert(u);
-        cost[minmax(u, v)] = costs[e];
+        cost[minmax(u, v)] += costs[e];
     }
 
     using cut_range_t = pair<list<int>::iterator, list<int>::iterator>;
@@ -126,3 +128,388 @@ auto stoer_wagner(int V, vector<vector<long>> cost, int a = 0) {
     cut_t cut(best_cut.first, best_cut.second);
     return pair<long, cut_t>{best_cost, cut};
 }
+
+/**
+ * Weighted undirected graph in CSR form for the contraction based min cuts, each edge
+ * stored both ways, no parallel edges or loops. group maps every original node to the
+ * node holding it.
+ */
+struct cut_graph {
+    int V = 0;
+    vector<int> off, head, group;
+    vector<long> weight;
+
+    long degree(int u) const {
+        return accumulate(begin(weight) + off[u], begin(weight) + off[u + 1], 0L);
+    }
+};
+
+// merge the nodes with the same label in [0,n), summing parallel edges, dropping loops
+inline auto contract_cut_graph(const cut_graph& G, const vector<int>& label, int n) {
+    cut_graph H{n, vector<int>(n + 1), {}, G.group, {}};
+    for (int& x : H.group) {
+        x = label[x];
+    }
+    vector<int> start(n + 1), order(G.V), pos(n, -1);
+    for (int u = 0; u < G.V; u++) {
+        start[label[u] + 1]++;
+    }
+    partial_sum(begin(start), end(start), begin(start));
+    vector<int> at(begin(start), end(start) - 1);
+    for (int u = 0; u < G.V; u++) {
+        order[at[label[u]]++] = u;
+    }
+    for (int x = 0; x < n; x++) {
+        int first = H.head.size();
+        for (int i = start[x]; i < start[x + 1]; i++) {
+            int u = order[i];
+            for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+                int y = label[G.head[e]];
+                if (y == x) {
+                    continue;
+                } else if (pos[y] >= first) {
+                    H.weight[pos[y]] += G.weight[e];
+                } else {
+                    pos[y] = H.head.size();
+                    H.head.push_back(y), H.weight.push_back(G.weight[e]);
+                }
+            }
+        }
+        H.off[x + 1] = H.head.size();
+    }
+    return H;
+}
+
+inline auto make_cut_graph(int V, const edges_t& g, const vector<long>& costs) {
+    cut_graph G{V, vector<int>(V + 1), {}, vector<int>(V), {}};
+    iota(begin(G.group), end(G.group), 0);
+    for (auto [u, v] : g) {
+        if (u != v) {
+            G.off[u + 1]++, G.off[v + 1]++;
+        }
+    }
+    partial_sum(begin(G.off), end(G.off), begin(G.off));
+    G.head.resize(G.off[V]), G.weight.resize(G.off[V]);
+    vector<int> at(begin(G.off), end(G.off) - 1);
+    for (int e = 0, E = g.size(); e < E; e++) {
+        if (auto [u, v] = g[e]; u != v) {
+            G.head[at[u]] = v, G.weight[at[u]++] = costs[e];
+            G.head[at[v]] = u, G.weight[at[v]++] = costs[e];
+        }
+    }
+    // merge parallel edges, the reductions need each neighbour once
+    return contract_cut_graph(G, G.group, V);
+}
+
+inline auto compact_labels(disjoint_set& dsu) {
+    vector<int> label(dsu.N), id(dsu.N, -1);
+    int n = 0;
+    for (int u = 0; u < dsu.N; u++) {
+        int r = dsu.find(u);
+        label[u] = id[r] == -1 ? id[r] = n++ : id[r];
+    }
+    return make_pair(label, n);
+}
+
+// the original nodes held by the nodes with keep(x)
+template <typename Fn>
+void collect_cut(const cut_graph& G, cut_t& cut, Fn&& keep) {
+    cut.clear();
+    for (int u = 0, V = G.group.size(); u < V; u++) {
+        if (keep(G.group[u])) {
+            cut.push_back(u);
+        }
+    }
+}
+
+// lower best to the smallest weighted degree of G
+inline void trivial_cuts(const cut_graph& G, long& best, cut_t& cut) {
+    int x = -1;
+    for (int u = 0; u < G.V; u++) {
+        if (long d = G.degree(u); d < best) {
+            best = d, x = u;
+        }
+    }
+    if (x != -1) {
+        collect_cut(G, cut, [&](int y) { return y == x; });
+    }
+}
+
+/**
+ * Padberg-Rinaldi reductions. An edge uv is contracted if every cut separating u and v
+ * weighs at least best, by the tests
+ *   PR1  w(uv) >= best
+ *   PR3  w(uv) + sum of min(w(ux), w(vx)) over the common neighbours x >= best
+ * or if 2w(uv) >= deg(u): moving u to the side of v does not make a non trivial cut
+ * heavier (PR2). PR2 contractions are taken on a matching, so they hold together.
+ * The triangle test only scans neighbours of degree at most TRIANGLE_DEGREE.
+ * Repeats while a round shrinks the graph by at least 1%.
+ */
+inline auto padberg_rinaldi(cut_graph G, long& best, cut_t& cut,
+                            thread_pool* pool = nullptr, int nthreads = 1) {
+    constexpr int GRAIN = 256, TRIANGLE_DEGREE = 64;
+    int T = nthreads;
+    vector<vector<pair<int, int>>> found(T);
+
+    while (G.V > 1 && best > 0) {
+        trivial_cuts(G, best, cut);
+        vector<long> degree(G.V);
+        vector<vector<long>> weight_to(T);
+        vector<vector<int>> mark(T);
+        vector<int> stamp(T);
+        parallel_for(pool, T, G.V, GRAIN, [&](int, int u) { degree[u] = G.degree(u); });
+        parallel_for(pool, T, G.V, GRAIN, [&](int t, int u) {
+            if (mark[t].empty()) {
+                weight_to[t].assign(G.V, 0), mark[t].assign(G.V, 0);
+            }
+            auto& wt = weight_to[t];
+            auto& mk = mark[t];
+            int now = ++stamp[t];
+            for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+                mk[G.head[e]] = now, wt[G.head[e]] = G.weight[e];
+            }
+            for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+                int v = G.head[e];
+                long w = G.weight[e];
+                if (v < u) {
+                    continue;
+                }
+                bool join = w >= best || 2 * w >= min(degree[u], degree[v]);
+                if (!join && G.off[v + 1] - G.off[v] <= TRIANGLE_DEGREE) {
+                    long sum = w;
+                    for (int f = G.off[v]; f < G.off[v + 1]; f++) {
+                        if (int x = G.head[f]; mk[x] == now && x != u) {
+                            sum += min(wt[x], G.weight[f]);
+                        }
+                    }
+                    join = sum >= best;
+                }
+                if (join) {
+                    found[t].push_back({u, e});
+                }
+            }
+        });
+
+        disjoint_set dsu(G.V);
+        vector<bool> matched(G.V);
+        for (int t = 0; t < T; t++) {
+            for (auto [u, e] : found[t]) {
+                int v = G.head[e];
+                long w = G.weight[e];
+                if (w >= best) {
+                    dsu.join(u, v);
+                } else if (2 * w < min(degree[u], degree[v])) {
+                    dsu.join(u, v); // triangle test
+                } else if (!matched[u] && !matched[v]) {
+                    matched[u] = matched[v] = true, dsu.join(u, v);
+                }
+            }
+            found[t].clear();
+        }
+        if (dsu.S == G.V) {
+            break;
+        }
+        auto [label, n] = compact_labels(dsu);
+        bool progress = n <= G.V - G.V / 100 - 1;
+        G = contract_cut_graph(G, label, n);
+        if (!progress) {
+            break;
+        }
+    }
+    return G;
+}
+
+/**
+ * Max priority queue for the maximum adjacency ordering with keys capped at bound
+ * (VieCut's bounded priority queue), ordering among keys at the cap does not matter.
+ * Buckets with lazy deletion if the bound is small, else a binary heap.
+ */
+struct ma_queue {
+    long bound;
+    bool buckets;
+    vector<vector<int>> bucket;
+    priority_queue<pair<long, int>> heap;
+    long top = 0;
+
+    ma_queue(long bound, long max_buckets)
+        : bound(bound), buckets(bound <= max_buckets), bucket(buckets ? bound + 1 : 0) {}
+
+    void push(int u, long key) {
+        key = min(key, bound);
+        if (buckets) {
+            bucket[key].push_back(u), top = max(top, key);
+        } else {
+            heap.push({key, u});
+        }
+    }
+    bool empty() {
+        if (buckets) {
+            while (top > 0 && bucket[top].empty()) {
+                top--;
+            }
+            return bucket[top].empty();
+        }
+        return heap.empty();
+    }
+    pair<long, int> pop() { // call after !empty()
+        if (buckets) {
+            int u = bucket[top].back();
+            bucket[top].pop_back();
+            return {top, u};
+        }
+        auto [key, u] = heap.top();
+        heap.pop();
+        return {key, u};
+    }
+};
+
+/**
+ * One round of Nagamochi-Ibaraki: a maximum adjacency ordering with r(v) the weight from
+ * the scanned nodes to v, capped at best. Once r(v) reaches best, uv has connectivity at
+ * least best and u,v are merged. best is at most the smallest degree, so the last node
+ * scanned merges with someone and every round shrinks the graph.
+ * Returns the labels of the merged graph, or n=0 if the graph is not connected.
+ */
+inline auto nagamochi_ibaraki_round(const cut_graph& G, long& best, cut_t& cut) {
+    vector<long> r(G.V);
+    vector<bool> done(G.V);
+    ma_queue Q(best, G.V + G.off[G.V]);
+    disjoint_set dsu(G.V);
+    int scanned = 0;
+    Q.push(0, 0);
+    while (!Q.empty()) {
+        auto [key, u] = Q.pop();
+        if (done[u] || key != min(r[u], best)) {
+            continue;
+        }
+        done[u] = true, scanned++;
+        for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+            int v = G.head[e];
+            if (!done[v] && r[v] < best) {
+                if (r[v] + G.weight[e] >= best) {
+                    dsu.join(u, v);
+                }
+                r[v] += G.weight[e];
+                Q.push(v, r[v]);
+            }
+        }
+    }
+    if (scanned < G.V) {
+        best = 0;
+        collect_cut(G, cut, [&](int x) { return done[x]; });
+        return make_pair(vector<int>(), 0);
+    }
+    return compact_labels(dsu);
+}
+
+/**
+ * Exact minimum cut (Nagamochi, Ono, Ibaraki) on a sparse representation, optionally with
+ * Padberg-Rinaldi reductions before every round. Each round is a maximum adjacency
+ * ordering that merges every pair it certifies to be at least the best cut, O(V + E)
+ * with buckets when the best cut is at most V + E, else O(E log V).
+ * Returns the cut value and the nodes on one side.
+ * Complexity: O(VE log V) worst case, usually a handful of rounds
+ */
+auto nagamochi_ibaraki(int V, const edges_t& g, const vector<long>& costs,
+                       bool reduce = false) {
+    assert(V >= 2);
+    auto G = make_cut_graph(V, g, costs);
+    long best = LONG_MAX;
+    cut_t cut;
+    while (G.V > 1 && best > 0) {
+        if (reduce) {
+            G = padberg_rinaldi(move(G), best, cut);
+            if (G.V == 1 || best == 0) {
+                break;
+            }
+        }
+        trivial_cuts(G, best, cut);
+        if (best == 0) {
+            break;
+        }
+        auto [label, n] = nagamochi_ibaraki_round(G, best, cut);
+        if (n == 0) {
+            break;
+        }
+        G = contract_cut_graph(G, label, n);
+    }
+    return pair<long, cut_t>{best, cut};
+}
+
+/**
+ * Inexact parallel minimum cut (VieCut, Henzinger et al.) for large graphs. Rounds of
+ * parallel label propagation, each node taking the label it is most heavily connected
+ * to, cluster the graph; the clusters are contracted and reduced with Padberg-Rinaldi
+ * until at most exact_size nodes are left, which are solved by Nagamochi-Ibaraki.
+ * A cluster can straddle the minimum cut, so the value is an upper bound, exact when no
+ * cluster does (usually). The returned cut always has the returned weight.
+ * Complexity: O(E) per round, O(log V) rounds on typical graphs
+ */
+auto viecut(int V, const edges_t& g, const vector<long>& costs, int nthreads = 1,
+            int exact_size = 10'000) {
+    constexpr int GRAIN = 256, PROPAGATION_ROUNDS = 2;
+    assert(V >= 2);
+    int T = nthreads;
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
+
+    auto G = make_cut_graph(V, g, costs);
+    long best = LONG_MAX;
+    cut_t cut;
+    G = padberg_rinaldi(move(G), best, cut, P, T);
+
+    while (G.V > exact_size && best > 0) {
+        vector<atomic<int>> label(G.V);
+        for (int u = 0; u < G.V; u++) {
+            label[u].store(u, memory_order_relaxed);
+        }
+        vector<vector<long>> sum(T);
+        for (int round = 0; round < PROPAGATION_ROUNDS; round++) {
+            parallel_for(P, T, G.V, GRAIN, [&](int t, int u) {
+                if (sum[t].empty()) {
+                    sum[t].assign(G.V, 0);
+                }
+                auto& to = sum[t];
+                int own = label[u].load(memory_order_relaxed), pick = own;
+                for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+                    to[label[G.head[e]].load(memory_order_relaxed)] += G.weight[e];
+                }
+                for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+                    int x = label[G.head[e]].load(memory_order_relaxed);
+                    if (to[x] > to[pick] || (to[x] == to[pick] && x < pick)) {
+                        pick = x;
+                    }
+                }
+                for (int e = G.off[u]; e < G.off[u + 1]; e++) {
+                    to[label[G.head[e]].load(memory_order_relaxed)] = 0;
+                }
+                to[own] = 0;
+                label[u].store(pick, memory_order_relaxed);
+            });
+        }
+        vector<int> id(G.V, -1), cluster(G.V);
+        int n = 0;
+        for (int u = 0; u < G.V; u++) {
+            int x = label[u].load(memory_order_relaxed);
+            cluster[u] = id[x] == -1 ? id[x] = n++ : id[x];
+        }
+        if (n == 1 || n > G.V - G.V / 100 - 1) {
+            break; // clustering stalled, or would merge everything
+        }
+        G = contract_cut_graph(G, cluster, n);
+        G = padberg_rinaldi(move(G), best, cut, P, T);
+    }
+
+    while (G.V > 1 && best > 0) {
+        trivial_cuts(G, best, cut);
+        if (best == 0) {
+            break;
+        }
+        auto [label, n] = nagamochi_ibaraki_round(G, best, cut);
+        if (n == 0) {
+            break;
+        }
+        G = contract_cut_graph(G, label, n);
+    }
+    return pair<long, cut_t>{best, cut};
+}
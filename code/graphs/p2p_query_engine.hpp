@@ -0,0 +1,227 @@
+#pragma once
+
+#include <bits/stdc++.h>
+using namespace std;
+
+/**
+ * Point to point shortest path queries on a fixed graph with non-negative costs.
+ * The distance arrays are stamped per query and reset lazily and the heaps keep their
+ * storage, so a query only costs the region it explores.
+ *
+ *   unidirectional(s,t): dijkstra from s, stops when t is settled
+ *   bidirectional(s,t): dijkstra from s and backwards from t
+ *   bidirectional_astar(s,t,lb): bidirectional A*, lb(u,v) must be a lower bound of the
+ *       distance u->v that is feasible for both searches, lb(u,t)<=w(u,v)+lb(v,t) and
+ *       lb(s,v)<=lb(s,u)+w(u,v). The searches use the average potentials, with keys
+ *       doubled to stay integral: key_f(v)=2g_f(v)+p(v), key_r(v)=2g_r(v)-p(v) where
+ *       p(v)=lb(v,t)-lb(s,v), and stop once the two smallest keys reach 2*best.
+ *   alt(s,t): bidirectional A* with landmark bounds, after preprocess_landmarks(L).
+ *       Landmarks need every landmark distance to be finite (strongly connected graph).
+ *
+ * The graph is stored in CSR form forwards and backwards.
+ * Complexity: O(E log V) per query worst case, O(V log V + E) setup.
+ */
+template <typename Cost = long, typename CostSum = Cost>
+struct p2p_query_engine {
+    static constexpr CostSum inf = numeric_limits<CostSum>::max() / 4;
+    using heap_t = vector<pair<CostSum, int>>;
+
+    int V, L = 0;
+    vector<int> off[2];
+    vector<pair<int, Cost>> arcs[2];
+    vector<CostSum> dist[2], pot;
+    vector<int> seen[2], seen_pot;
+    heap_t heap[2];
+    vector<CostSum> lm_from, lm_to; // d(l,v) at [v*L+l], d(v,l) at [v*L+l]
+    int stamp = 0;
+    long settled = 0; // nodes settled by the last query
+
+    explicit p2p_query_engine(const vector<vector<pair<int, Cost>>>& adj)
+        : V(adj.size()), pot(V), seen_pot(V) {
+        for (int side : {0, 1}) {
+            off[side].assign(V + 1, 0);
+            dist[side].assign(V, inf), seen[side].assign(V, 0);
+        }
+        for (int u = 0; u < V; u++) {
+            for (auto [v, w] : adj[u]) {
+                assert(0 <= v && v < V && w >= 0);
+                off[0][u + 1]++, off[1][v + 1]++;
+            }
+        }
+        for (int side : {0, 1}) {
+            partial_sum(begin(off[side]), end(off[side]), begin(off[side]));
+            arcs[side].resize(off[side][V]);
+        }
+        vector<int> at[2] = {off[0], off[1]};
+        for (int u = 0; u < V; u++) {
+            for (auto [v, w] : adj[u]) {
+                arcs[0][at[0][u]++] = {v, w};
+                arcs[1][at[1][v]++] = {u, w};
+            }
+        }
+    }
+
+    CostSum unidirectional(int s, int t) {
+        next_query();
+        settled = 0;
+        reach(0, s, 0, 0);
+        while (!heap[0].empty()) {
+            auto [k, u] = pop(0);
+            if (k > 2 * dist[0][u]) {
+                continue;
+            }
+            settled++;
+            if (u == t) {
+                return dist[0][t];
+            }
+            for (int a = off[0][u]; a < off[0][u + 1]; a++) {
+                auto [v, w] = arcs[0][a];
+                if (dist[0][u] + w < get(0, v)) {
+                    reach(0, v, dist[0][u] + w, 0);
+                }
+            }
+        }
+        return inf;
+    }
+
+    CostSum bidirectional(int s, int t) {
+        return search(s, t, [](int, int) { return CostSum(0); });
+    }
+
+    template <typename Fn>
+    CostSum bidirectional_astar(int s, int t, Fn&& lb) {
+        return search(s, t, lb);
+    }
+
+    CostSum alt(int s, int t) {
+        assert(L > 0);
+        return search(s, t, [&](int u, int v) { return landmark_bound(u, v); });
+    }
+
+    /**
+     * Pick L landmarks by farthest selection from a random start and store the distances
+     * from and to each of them.
+     */
+    void preprocess_landmarks(int num_landmarks, int seed = 0) {
+        L = min(num_landmarks, V);
+        lm_from.assign(1L * V * L, inf), lm_to.assign(1L * V * L, inf);
+        vector<CostSum> closest(V, inf);
+        int l = mt19937(seed)() % V;
+        for (int i = 0; i < L; i++) {
+            for (int side : {0, 1}) {
+                auto& lm = side == 0 ? lm_from : lm_to;
+                full_search(side, l);
+                for (int v = 0; v < V; v++) {
+                    assert(dist[side][v] < inf); // strongly connected
+                    lm[1L * v * L + i] = dist[side][v];
+                }
+            }
+            for (int v = 0; v < V; v++) {
+                closest[v] = min(closest[v], lm_from[1L * v * L + i]);
+            }
+            l = max_element(begin(closest), end(closest)) - begin(closest);
+        }
+    }
+
+    CostSum landmark_bound(int u, int v) const {
+        CostSum bound = 0;
+        const CostSum *fu = &lm_from[1L * u * L], *fv = &lm_from[1L * v * L];
+        const CostSum *tu = &lm_to[1L * u * L], *tv = &lm_to[1L * v * L];
+        for (int i = 0; i < L; i++) {
+            bound = max(bound, max(fv[i] - fu[i], tu[i] - tv[i]));
+        }
+        return bound;
+    }
+
+  private:
+    void next_query() {
+        if (++stamp == INT_MAX) {
+            for (int side : {0, 1}) {
+                fill(begin(seen[side]), end(seen[side]), 0);
+            }
+            fill(begin(seen_pot), end(seen_pot), 0);
+            stamp = 1;
+        }
+        heap[0].clear(), heap[1].clear();
+    }
+
+    CostSum get(int side, int v) const {
+        return seen[side][v] == stamp ? dist[side][v] : inf;
+    }
+
+    void reach(int side, int v, CostSum d, CostSum p) {
+        seen[side][v] = stamp, dist[side][v] = d;
+        heap[side].push_back({2 * d + p, v});
+        push_heap(begin(heap[side]), end(heap[side]), greater<>{});
+    }
+
+    pair<CostSum, int> pop(int side) {
+        pop_heap(begin(heap[side]), end(heap[side]), greater<>{});
+        auto top = heap[side].back();
+        heap[side].pop_back();
+        return top;
+    }
+
+    // every node reached from s (side 0) or reaching s (side 1), into dist[side]
+    void full_search(int side, int s) {
+        next_query();
+        reach(side, s, 0, 0);
+        while (!heap[side].empty()) {
+            auto [k, u] = pop(side);
+            if (k > 2 * dist[side][u]) {
+                continue;
+            }
+            for (int a = off[side][u]; a < off[side][u + 1]; a++) {
+                auto [v, w] = arcs[side][a];
+                if (dist[side][u] + w < get(side, v)) {
+                    reach(side, v, dist[side][u] + w, 0);
+                }
+            }
+        }
+        for (int v = 0; v < V; v++) {
+            dist[side][v] = get(side, v);
+        }
+    }
+
+    template <typename Fn>
+    CostSum search(int s, int t, Fn&& lb) {
+        next_query();
+        settled = 0;
+        if (s == t) {
+            return 0;
+        }
+        // forward potential of v, the reverse potential is its negation
+        auto potential = [&](int v) {
+            if (seen_pot[v] != stamp) {
+                seen_pot[v] = stamp, pot[v] = lb(v, t) - lb(s, v);
+            }
+            return pot[v];
+        };
+        CostSum best = inf;
+        reach(0, s, 0, potential(s));
+        reach(1, t, 0, -potential(t));
+
+        while (!heap[0].empty() && !heap[1].empty()) {
+            if (heap[0][0].first + heap[1][0].first >= 2 * best) {
+                break;
+            }
+            int side = heap[0][0].first <= heap[1][0].first ? 0 : 1;
+            auto [k, u] = pop(side);
+            CostSum du = dist[side][u], sign = side == 0 ? 1 : -1;
+            if (k > 2 * du + sign * potential(u)) {
+                continue;
+            }
+            settled++;
+            for (int a = off[side][u]; a < off[side][u + 1]; a++) {
+                auto [v, w] = arcs[side][a];
+                if (du + w < get(side, v)) {
+                    reach(side, v, du + w, sign * potential(v));
+                    if (CostSum other = get(!side, v); other < inf) {
+                        best = min(best, du + w + other);
+                    }
+                }
+            }
+        }
+        return best;
+    }
+};
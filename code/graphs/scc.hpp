@@ -1,56 +1,284 @@
 #pragma once
 
-#include "../struct/y_combinator.hpp"
 #include "../hash.hpp"
+#include "../parallel/thread_pool.hpp" // thread_pool, run_on_each_thread, parallel_for
 
 /**
- * Find strongly connected components in reverse topological order (Tarjan)
+ * Strongly connected components, flat layout: the nodes of component c are
+ * nodes[off[c],off[c+1]) and cmap[u] is the component of u.
+ */
+struct scc_components {
+    int C = 0; // number of scc
+    vector<int> cmap, off, nodes;
+};
+
+inline auto group_scc(int C, vector<int> cmap) {
+    int V = cmap.size();
+    scc_components scc{C, move(cmap), vector<int>(C + 1), vector<int>(V)};
+    for (int u = 0; u < V; u++) {
+        scc.off[scc.cmap[u] + 1]++;
+    }
+    partial_sum(begin(scc.off), end(scc.off), begin(scc.off));
+    vector<int> at(begin(scc.off), end(scc.off) - 1);
+    for (int u = 0; u < V; u++) {
+        scc.nodes[at[scc.cmap[u]]++] = u;
+    }
+    return scc;
+}
+
+/**
+ * Iterative one-pass Tarjan (Pearce) over the nodes with cmap[u]=-1, numbering their
+ * components from C up in reverse topological order. A finished component gets an rindex
+ * counting down from V-1, above the rindex of every open node, so no onstack array or
+ * lowlink array is needed, only rindex and a root bit per node.
+ */
+inline void pearce_scc(const vector<vector<int>>& adj, vector<int>& cmap, int& C) {
+    int V = adj.size(), index = 1, c = V - 1;
+    vector<int> rindex(V), S;
+    vector<bool> root(V);
+    vector<pair<int, int>> call; // node, next arc
+
+    for (int s = 0; s < V; s++) {
+        if (cmap[s] != -1 || rindex[s]) {
+            continue;
+        }
+        root[s] = true, rindex[s] = index++;
+        call.push_back({s, 0});
+        while (!call.empty()) {
+            int v = call.back().first, deg = adj[v].size();
+            int& i = call.back().second;
+            for (; i < deg; i++) {
+                int w = adj[v][i];
+                if (cmap[w] != -1) {
+                    continue;
+                }
+                if (!rindex[w]) {
+                    break;
+                }
+                if (rindex[w] < rindex[v]) {
+                    rindex[v] = rindex[w], root[v] = false;
+                }
+            }
+            if (i < deg) { // descend, the arc is checked again on return
+                int w = adj[v][i];
+                root[w] = true, rindex[w] = index++;
+                call.push_back({w, 0});
+                continue;
+            }
+            call.pop_back();
+            if (root[v]) {
+                index--;
+                while (!S.empty() && rindex[v] <= rindex[S.back()]) {
+                    rindex[S.back()] = c, S.pop_back(), index--;
+                }
+                rindex[v] = c--;
+            } else {
+                S.push_back(v);
+            }
+        }
+    }
+    for (int u = 0; u < V; u++) {
+        if (cmap[u] == -1) {
+            cmap[u] = C + (V - 1 - rindex[u]);
+        }
+    }
+    C += V - 1 - c;
+}
+
+/**
+ * Find strongly connected components in reverse topological order (Tarjan, Pearce)
+ * Iterative, so deep graphs do not overflow the stack.
  * Nodes 0-indexed
  * Complexity: O(V + E), same for condensation
  */
 auto build_scc(const vector<vector<int>>& adj) {
-    int V = adj.size(), C = 0; // C = number of scc
-
-    vector<vector<int>> cset;
+    int V = adj.size(), C = 0;
     vector<int> cmap(V, -1);
-    vector<int> index(V);
-    vector<int> lowlink(V);
-    int timer = 1;
+    pearce_scc(adj, cmap, C);
+    return group_scc(C, move(cmap));
+}
 
-    stack<int> S;
+/**
+ * Parallel strongly connected components (Multistep, Slota et al.)
+ *   1. trim: nodes without live in or out arcs are singleton components, repeated while
+ *      rounds trim at least 1% of the live nodes
+ *   2. forward-backward: the component of the node with largest in*out degree is the set
+ *      of nodes reached from it that also reach it, usually the giant component
+ *   3. coloring: the largest label of a node reaching u is propagated to u; each label
+ *      root r then takes the nodes of label r that reach r as its component
+ *   4. serial Pearce once at most serial_cutoff nodes are left
+ * The components are not in topological order.
+ * Complexity: O((V + E) * rounds) work
+ */
+auto parallel_scc(const vector<vector<int>>& adj, int nthreads = 1,
+                  int serial_cutoff = 1 << 14) {
+    constexpr int GRAIN = 256;
 
-    auto dfs = y_combinator([&](auto self, int u) -> void {
-        index[u] = lowlink[u] = timer++;
-        S.push(u);
+    int V = adj.size(), T = nthreads, C = 0;
+    assert(T > 0);
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
 
+    vector<int> roff(V + 1), rin;
+    for (int u = 0; u < V; u++) {
         for (int v : adj[u]) {
-            if (index[v] && cmap[v] == -1) { // <-- skip cmap'd nodes
-                lowlink[u] = min(lowlink[u], index[v]);
-            } else if (!index[v]) {
-                self(v);
-                lowlink[u] = min(lowlink[u], lowlink[v]);
+            roff[v + 1]++;
+        }
+    }
+    partial_sum(begin(roff), end(roff), begin(roff));
+    rin.resize(roff[V]);
+    vector<int> at(begin(roff), end(roff) - 1);
+    for (int u = 0; u < V; u++) {
+        for (int v : adj[u]) {
+            rin[at[v]++] = u;
+        }
+    }
+
+    vector<int> cmap(V, -1), live(V);
+    iota(begin(live), end(live), 0);
+    vector<vector<int>> found(T);
+    vector<atomic<int>> mark(V), color(V);
+    int stamp = 0;
+
+    auto collect = [&]() {
+        vector<int> all;
+        for (int t = 0; t < T; t++) {
+            all.insert(end(all), begin(found[t]), end(found[t]));
+            found[t].clear();
+        }
+        return all;
+    };
+    auto drop_assigned = [&]() {
+        auto assigned = [&](int u) { return cmap[u] != -1; };
+        live.erase(remove_if(begin(live), end(live), assigned), end(live));
+    };
+    auto has_live = [&](int u, bool reverse) {
+        if (reverse) {
+            for (int a = roff[u]; a < roff[u + 1]; a++) {
+                if (rin[a] != u && cmap[rin[a]] == -1) {
+                    return true;
+                }
+            }
+        } else {
+            for (int v : adj[u]) {
+                if (v != u && cmap[v] == -1) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    // 1. trim
+    while (!live.empty()) {
+        parallel_for(P, T, live.size(), GRAIN, [&](int t, int i) {
+            int u = live[i];
+            if (!has_live(u, false) || !has_live(u, true)) {
+                found[t].push_back(u);
             }
+        });
+        auto trimmed = collect();
+        for (int u : trimmed) {
+            cmap[u] = C++;
         }
+        drop_assigned();
+        if (trimmed.size() <= live.size() / 100) {
+            break;
+        }
+    }
 
-        // found a strongly connected component
-        if (index[u] == lowlink[u]) {
-            int c = C++;
-            cset.push_back({});
-            int v;
-            do {
-                v = S.top(), S.pop();
-                cmap[v] = c, cset[c].push_back(v);
-            } while (u != v);
+    // 2. forward-backward from the pivot, the backward search stays in the forward set
+    if (!live.empty()) {
+        auto degree = [&](int u) { return 1L * adj[u].size() * (roff[u + 1] - roff[u]); };
+        int pivot = *max_element(begin(live), end(live),
+                                 [&](int u, int v) { return degree(u) < degree(v); });
+        int fw = ++stamp, bw = ++stamp;
+        for (int side : {0, 1}) {
+            int want = side == 0 ? fw : bw;
+            vector<int> frontier = {pivot};
+            mark[pivot] = want;
+            while (!frontier.empty()) {
+                parallel_for(P, T, frontier.size(), GRAIN, [&](int t, int i) {
+                    auto visit = [&](int v) {
+                        if (cmap[v] == -1 && (side == 0 || mark[v] == fw) &&
+                            mark[v].exchange(want, memory_order_relaxed) != want) {
+                            found[t].push_back(v);
+                        }
+                    };
+                    int u = frontier[i];
+                    if (side == 0) {
+                        for (int v : adj[u]) {
+                            visit(v);
+                        }
+                    } else {
+                        for (int a = roff[u]; a < roff[u + 1]; a++) {
+                            visit(rin[a]);
+                        }
+                    }
+                });
+                frontier = collect();
+            }
+        }
+        for (int u : live) {
+            if (mark[u] == bw) {
+                cmap[u] = C;
+            }
         }
-    });
+        C++, drop_assigned();
+    }
 
-    for (int u = 0; u < V; u++) {
-        if (!index[u]) {
-            dfs(u);
+    // 3. coloring
+    while (int(live.size()) > serial_cutoff) {
+        for (int u : live) {
+            color[u].store(u, memory_order_relaxed);
+        }
+        vector<int> frontier = live;
+        while (!frontier.empty()) {
+            int now = ++stamp;
+            parallel_for(P, T, frontier.size(), GRAIN, [&](int t, int i) {
+                int u = frontier[i], cu = color[u].load(memory_order_relaxed);
+                for (int v : adj[u]) {
+                    if (cmap[v] != -1) {
+                        continue;
+                    }
+                    int old = color[v].load(memory_order_relaxed);
+                    while (cu > old && !color[v].compare_exchange_weak(
+                                           old, cu, memory_order_relaxed)) {}
+                    if (cu > old && mark[v].exchange(now, memory_order_relaxed) != now) {
+                        found[t].push_back(v);
+                    }
+                }
+            });
+            frontier = collect();
         }
+        vector<int> roots;
+        for (int u : live) {
+            if (color[u].load(memory_order_relaxed) == u) {
+                roots.push_back(u);
+            }
+        }
+        // each root searches backwards in its own color, so the searches are disjoint
+        parallel_for(P, T, roots.size(), 1, [&](int t, int i) {
+            int r = roots[i], c = C + i;
+            auto& queue = found[t];
+            queue = {r}, cmap[r] = c;
+            for (int j = 0; j < int(queue.size()); j++) {
+                int u = queue[j];
+                for (int a = roff[u]; a < roff[u + 1]; a++) {
+                    int v = rin[a];
+                    if (color[v].load(memory_order_relaxed) == r && cmap[v] == -1) {
+                        cmap[v] = c, queue.push_back(v);
+                    }
+                }
+            }
+            queue.clear();
+        });
+        C += roots.size(), drop_assigned();
     }
 
-    return make_pair(cset, cmap);
+    // 4. serial
+    pearce_scc(adj, cmap, C);
+    return group_scc(C, move(cmap));
 }
 
 auto condensate_scc(const vector<vector<int>>& adj, const vector<int>& cmap) {
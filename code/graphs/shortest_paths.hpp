@@ -1,7 +1,8 @@
 #pragma once
 
 #include "../struct/pbds.hpp"          // pbds priority queue
-#include "../struct/integer_heaps.hpp" // binary_int_heap
+#include "../struct/integer_heaps.hpp" // binary_int_heap, binary_min_int_heap
+#include "../parallel/thread_pool.hpp"   // thread_pool, run_on_each_thread, parallel_for
 
 template <typename Cost = long, typename CostSum = Cost>
 auto spfa(int s, const vector<vector<pair<int, Cost>>>& adj) {
@@ -44,7 +45,12 @@ auto spfa(int s, const vector<vector<pair<int, Cost>>>& adj) {
     return dist;
 }
 
-template <typename Cost = long, typename CostSum = Cost>
+/**
+ * MinHeap can be any of binary_min_int_heap, radix_int_heap or bucket_int_heap (the
+ * latter two require integer costs), or another heap constructible from (V, dist).
+ */
+template <typename Cost = long, typename CostSum = Cost,
+          template <typename> typename MinHeap = binary_min_int_heap>
 auto dijkstra(int s, const vector<vector<pair<int, Cost>>>& adj) {
     constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
 
@@ -53,8 +59,7 @@ auto dijkstra(int s, const vector<vector<pair<int, Cost>>>& adj) {
     // vector<int> prev(V, -1);
     dist[s] = 0;
 
-    using min_heap = binary_int_heap<less_container<vector<CostSum>>>;
-    min_heap heap(V, dist);
+    MinHeap<vector<CostSum>> heap(V, dist);
     heap.push(s);
 
     do {
@@ -72,6 +77,113 @@ auto dijkstra(int s, const vector<vector<pair<int, Cost>>>& adj) {
     return dist;
 }
 
+/**
+ * Delta-stepping parallel sssp (Meyer, Sanders) for non-negative costs, GAPBS style.
+ * Nodes are binned by tentative distance into bins of width delta. The lowest non-empty
+ * bin is gathered from the thread-local bin arrays into a shared frontier and relaxed in
+ * parallel with atomic min on the distances, each thread binning the nodes it improved.
+ * delta=0 picks delta = max cost / average degree. Takes the graph in CSR form: the arcs
+ * out of u are arcs[off[u],off[u+1]).
+ * Complexity: O(V + E + phases) work, the number of phases is about L/delta with L the
+ * largest distance, nodes are relaxed again when improved within their bin.
+ */
+template <typename Cost = long, typename CostSum = Cost>
+auto delta_stepping(int s, const vector<int>& off, const vector<pair<int, Cost>>& arcs,
+                    int nthreads = 1, double delta = 0) {
+    constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
+    constexpr int GRAIN = 64;
+
+    int V = off.size() - 1, T = nthreads;
+    assert(0 <= s && s < V && T > 0);
+    if (delta <= 0) {
+        Cost maxw = 0;
+        for (auto [v, w] : arcs) {
+            maxw = max(maxw, w);
+        }
+        delta = max(1.0 * maxw * V / max<size_t>(arcs.size(), 1), 1.0);
+    }
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
+
+    vector<atomic<CostSum>> dist(V);
+    for (int u = 0; u < V; u++) {
+        dist[u].store(inf, memory_order_relaxed);
+    }
+    dist[s] = 0;
+
+    vector<vector<vector<int>>> bins(T); // thread-local bins
+    vector<int> frontier = {s}, offset(T + 1);
+    size_t bin = 0;
+
+    while (!frontier.empty()) {
+        parallel_for(P, T, frontier.size(), GRAIN, [&](int t, int i) {
+            int u = frontier[i];
+            CostSum du = dist[u].load(memory_order_relaxed);
+            if (size_t(du / delta) < bin) {
+                return; // settled in an earlier bin
+            }
+            for (int a = off[u]; a < off[u + 1]; a++) {
+                auto [v, w] = arcs[a];
+                CostSum dv = du + w, old = dist[v].load(memory_order_relaxed);
+                while (dv < old &&
+                       !dist[v].compare_exchange_weak(old, dv, memory_order_relaxed)) {}
+                if (dv < old) {
+                    size_t b = dv / delta;
+                    if (b >= bins[t].size()) {
+                        bins[t].resize(b + 1);
+                    }
+                    bins[t][b].push_back(v);
+                }
+            }
+        });
+
+        // next bin is the lowest non-empty bin of any thread, it may be the same bin
+        size_t next = SIZE_MAX;
+        for (int t = 0; t < T; t++) {
+            for (size_t b = bin; b < min(next, bins[t].size()); b++) {
+                if (!bins[t][b].empty()) {
+                    next = b;
+                    break;
+                }
+            }
+        }
+        if (next == SIZE_MAX) {
+            break;
+        }
+        bin = next;
+        for (int t = 0; t < T; t++) {
+            size_t size = bin < bins[t].size() ? bins[t][bin].size() : 0;
+            offset[t + 1] = offset[t] + size;
+        }
+        frontier.resize(offset[T]);
+        run_on_each_thread(P, T, [&](int t) {
+            if (bin < bins[t].size()) {
+                copy(begin(bins[t][bin]), end(bins[t][bin]), begin(frontier) + offset[t]);
+                bins[t][bin].clear();
+            }
+        });
+    }
+
+    vector<CostSum> ans(V);
+    for (int u = 0; u < V; u++) {
+        ans[u] = dist[u].load(memory_order_relaxed);
+    }
+    return ans;
+}
+
+template <typename Cost = long, typename CostSum = Cost>
+auto delta_stepping(int s, const vector<vector<pair<int, Cost>>>& adj, int nthreads = 1,
+                    double delta = 0) {
+    int V = adj.size();
+    vector<int> off(V + 1);
+    vector<pair<int, Cost>> arcs;
+    for (int u = 0; u < V; u++) {
+        arcs.insert(end(arcs), begin(adj[u]), end(adj[u]));
+        off[u + 1] = arcs.size();
+    }
+    return delta_stepping<Cost, CostSum>(s, off, arcs, nthreads, delta);
+}
+
 template <typename Cost = long, typename CostSum = Cost>
 auto bellman_ford(int V, int s, const vector<tuple<int, int, Cost>>& edge) {
     constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
@@ -246,50 +358,150 @@ auto floyd_warshall(const vector<vector<pair<int, Cost>>>& adj) {
     return dist;
 }
 
+/**
+ * Blocked Floyd-Warshall into one row-major VxV matrix, dist[u*V+v], on nthreads.
+ * The work matrix is padded and stored tile by tile, each BxB tile contiguous and small
+ * enough that three fit in L1. For each diagonal tile K: close tile (K,K), then the tiles
+ * of row K and column K against it, then all other tiles (I,J) against (I,K) and (K,J).
+ * The min-plus kernel runs over contiguous tile rows and is vectorized by the compiler.
+ */
 template <typename Cost = long, typename CostSum = Cost>
-auto dijkstra_all(const vector<vector<pair<int, Cost>>>& adj) {
+auto floyd_warshall_blocked(const vector<vector<pair<int, Cost>>>& adj,
+                            int nthreads = 1) {
     constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
+    constexpr int B = 32;
 
-    int V = adj.size();
-    vector<vector<CostSum>> dist(V, vector<CostSum>(V, inf));
-    // vector<vector<int>> prev(V, vector<int>(V, -1));
-
-    int s = 0;
-    auto cmp = [&](int u, int v) { return dist[s][u] < dist[s][v]; };
-    using min_heap = binary_int_heap<decltype(cmp)>;
-    min_heap heap(V, cmp);
+    int V = adj.size(), T = nthreads, nb = (V + B - 1) / B;
+    vector<CostSum> d(1L * nb * nb * B * B, inf);
+    auto at = [&](int u, int v) -> CostSum& {
+        return d[((1L * (u / B) * nb + v / B) * B + u % B) * B + v % B];
+    };
+    for (int u = 0; u < V; u++) {
+        for (auto [v, w] : adj[u]) {
+            at(u, v) = min(CostSum(w), at(u, v));
+        }
+        at(u, u) = 0;
+    }
 
-    while (s < V) {
-        dist[s][s] = 0;
-        heap.push(s);
+    // tile (I,J) = min(tile (I,J), tile (I,K) + tile (K,J)), k in order within the tile
+    auto tile = [&](int I, int J, int K) {
+        CostSum* c = &d[(1L * I * nb + J) * B * B];
+        const CostSum* a = &d[(1L * I * nb + K) * B * B];
+        const CostSum* b = &d[(1L * K * nb + J) * B * B];
+        for (int k = 0; k < B; k++) {
+            for (int i = 0; i < B; i++) {
+                CostSum aik = a[i * B + k];
+                for (int j = 0; j < B; j++) {
+                    c[i * B + j] = min(c[i * B + j], aik + b[k * B + j]);
+                }
+            }
+        }
+    };
+
+    // same for I!=K and J!=K, tile (I,J) does not alias the others so k can go inside
+    auto rest_tile = [&](int I, int J, int K) {
+        CostSum* c = &d[(1L * I * nb + J) * B * B];
+        const CostSum* a = &d[(1L * I * nb + K) * B * B];
+        const CostSum* b = &d[(1L * K * nb + J) * B * B];
+        for (int i = 0; i < B; i++) {
+            CostSum row[B];
+            copy(c + i * B, c + (i + 1) * B, row);
+            for (int k = 0; k < B; k++) {
+                CostSum aik = a[i * B + k];
+                for (int j = 0; j < B; j++) {
+                    row[j] = min(row[j], aik + b[k * B + j]);
+                }
+            }
+            copy(row, row + B, c + i * B);
+        }
+    };
 
-        do {
-            int u = heap.pop();
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
 
-            for (auto [v, w] : adj[u]) {
-                if (dist[s][v] > dist[s][u] + w) {
-                    dist[s][v] = dist[s][u] + w;
-                    // prev[s][v] = u;
-                    heap.push_or_improve(v);
+    for (int K = 0; K < nb; K++) {
+        tile(K, K, K);
+        parallel_for(P, T, 2 * nb, 1, [&](int, int x) {
+            if (int I = x >> 1; I != K) {
+                x & 1 ? tile(I, K, K) : tile(K, I, K);
+            }
+        });
+        parallel_for(P, T, nb, 1, [&](int, int I) {
+            for (int J = 0; J < nb && I != K; J++) {
+                if (J != K) {
+                    rest_tile(I, J, K);
                 }
             }
-        } while (!heap.empty());
+        });
+    }
 
-        s++;
+    // drop the padding and fix infinites getting reduced by negative cost edges
+    vector<CostSum> dist(1L * V * V);
+    for (int u = 0; u < V; u++) {
+        // if dist[u][u] < 0, negative cycle detected
+        assert(at(u, u) == 0);
+        for (int v = 0; v < V; v++) {
+            CostSum x = at(u, v);
+            dist[1L * u * V + v] = x > inf / 2 ? inf : x;
+        }
     }
+    return dist;
+}
+
+/**
+ * Dijkstra from every source on nthreads into one row-major VxV matrix, dist[u*V+v].
+ */
+template <typename Cost = long, typename CostSum = Cost>
+auto dijkstra_all(const vector<vector<pair<int, Cost>>>& adj, int nthreads = 1) {
+    constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
+
+    int V = adj.size(), T = nthreads;
+    vector<CostSum> dist(1L * V * V, inf);
+    // vector<int> prev(1L * V * V, -1);
+
+    optional_thread_pool pool(T);
+    atomic<int> next = 0;
+    run_on_each_thread(pool.get(), T, [&](int) {
+        CostSum* d = nullptr;
+        auto cmp = [&d](int u, int v) { return d[u] < d[v]; };
+        using min_heap = binary_int_heap<decltype(cmp)>;
+        min_heap heap(V, cmp);
+
+        for (int s = next++; s < V; s = next++) {
+            d = &dist[1L * s * V];
+            d[s] = 0;
+            heap.push(s);
+
+            do {
+                int u = heap.pop();
+
+                for (auto [v, w] : adj[u]) {
+                    if (d[v] > d[u] + w) {
+                        d[v] = d[u] + w;
+                        // prev[s * V + v] = u;
+                        heap.push_or_improve(v);
+                    }
+                }
+            } while (!heap.empty());
+        }
+    });
 
     // return make_pair(move(dist), move(prev));
     return dist;
 }
 
+/**
+ * Johnson's reweighting then Dijkstra from every source on nthreads into one row-major
+ * VxV matrix, dist[u*V+v]. Negative costs are allowed, negative cycles are not.
+ */
 template <typename Cost = long, typename CostSum = Cost>
-auto johnsons(vector<vector<pair<int, Cost>>>& adj) {
+auto johnsons(vector<vector<pair<int, Cost>>>& adj, int nthreads = 1) {
     constexpr CostSum inf = numeric_limits<CostSum>::max() / 2;
 
-    int V = adj.size();
+    int V = adj.size(), T = nthreads;
     vector<CostSum> pi(V + 1, 0);
-    vector<vector<CostSum>> dist(V, vector<CostSum>(V, inf));
-    // vector<vector<int>> next(V, vector<int>(V, -1));
+    vector<CostSum> dist(1L * V * V, inf);
+    // vector<int> prev(1L * V * V, -1);
 
     // Step 1: spfa starting on extra node V to compute potentials; adds extra edges
     adj.emplace_back(V);
@@ -315,7 +527,7 @@ auto johnsons(vector<vector<pair<int, Cost>>>& adj) {
             if (pi[v] > pi[u] + w) {
                 pi[v] = pi[u] + w;
                 if (!in_queue[v]) {
-                    if (Q.empty() || dist[v] < dist[Q.front()]) {
+                    if (Q.empty() || pi[v] < pi[Q.front()]) {
                         Q.push_front(v);
                     } else {
                         Q.push_back(v);
@@ -329,34 +541,37 @@ auto johnsons(vector<vector<pair<int, Cost>>>& adj) {
     adj.pop_back();
 
     // Step 2: run dijkstra V times; removed extra edges above
-    int s = 0;
-    auto cmp = [&](int u, int v) { return dist[s][u] < dist[s][v]; };
-    using min_heap = binary_int_heap<decltype(cmp)>;
-    min_heap heap(V, cmp);
-
-    while (s < V) {
-        dist[s][s] = 0;
-        heap.push(s);
-
-        do {
-            int u = heap.pop();
-
-            for (auto [v, w] : adj[u]) {
-                if (dist[s][v] > dist[s][u] + pi[u] - pi[v] + w) {
-                    dist[s][v] = dist[s][u] + pi[u] - pi[v] + w;
-                    // prev[s][v] = u;
-                    heap.push_or_improve(v);
+    optional_thread_pool pool(T);
+    atomic<int> next = 0;
+    run_on_each_thread(pool.get(), T, [&](int) {
+        CostSum* d = nullptr;
+        auto cmp = [&d](int u, int v) { return d[u] < d[v]; };
+        using min_heap = binary_int_heap<decltype(cmp)>;
+        min_heap heap(V, cmp);
+
+        for (int s = next++; s < V; s = next++) {
+            d = &dist[1L * s * V];
+            d[s] = 0;
+            heap.push(s);
+
+            do {
+                int u = heap.pop();
+
+                for (auto [v, w] : adj[u]) {
+                    if (d[v] > d[u] + pi[u] - pi[v] + w) {
+                        d[v] = d[u] + pi[u] - pi[v] + w;
+                        // prev[s * V + v] = u;
+                        heap.push_or_improve(v);
+                    }
                 }
-            }
-        } while (!heap.empty());
+            } while (!heap.empty());
 
-        for (int u = 0; u < V; u++) {
-            if (dist[s][u] != inf)
-                dist[s][u] += pi[u] - pi[s];
+            for (int u = 0; u < V; u++) {
+                if (d[u] != inf)
+                    d[u] += pi[u] - pi[s];
+            }
         }
-
-        s++;
-    }
+    });
 
     // return make_pair(move(dist), move(prev));
     return dist;
@@ -1,51 +1,261 @@
 #pragma once
 
-#include "../numeric/bits.hpp" // FOR_EACH_MASK, FOR_EACH_BIT
+#include "../numeric/bits.hpp"         // FOR_EACH_BIT_NUMBER, next_lexicographical_mask
+#include "../parallel/thread_pool.hpp" // thread_pool, parallel_for
+
+/**
+ * Local search heuristic for an upper bound
+ * Builds a nearest neighbour tour from each of the first `starts` vertices, improves it
+ * with 2-opt (reverse a segment) and Or-opt (move a segment of up to 3 vertices
+ * elsewhere, possibly reversed) until no move improves, and keeps the best tour.
+ * Distances may be asymmetric: the cost of a reversed segment comes from prefix sums in
+ * both directions.
+ * Complexity: O(V^2) per improving move
+ */
+long tsp_local_search(int V, const vector<vector<int>>& dist,
+                      vector<int>* out_path = nullptr, int starts = 16) {
+    auto d = [&](int u, int v) { return long(dist[u][v]); };
+    vector<int> t, best_tour;
+    vector<long> fw(V + 1), bw(V + 1);
+    long best = LONG_MAX;
+
+    auto rebuild = [&]() {
+        for (int x = 0; x < V; x++) {
+            fw[x + 1] = fw[x] + d(t[x], t[(x + 1) % V]);
+            bw[x + 1] = bw[x] + d(t[(x + 1) % V], t[x]);
+        }
+    };
+    // reverse t[i..j], 1<=i<j<V
+    auto two_opt = [&]() {
+        for (int i = 1; i < V; i++) {
+            for (int j = i + 1; j < V; j++) {
+                int p = t[i - 1], a = t[i], b = t[j], q = t[(j + 1) % V];
+                long before = d(p, a) + (fw[j] - fw[i]) + d(b, q);
+                long after = d(p, b) + (bw[j] - bw[i]) + d(a, q);
+                if (after < before) {
+                    reverse(begin(t) + i, begin(t) + j + 1);
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    // move t[i..i+L) between t[j] and t[j+1], forward or reversed
+    auto or_opt = [&]() {
+        for (int L = 1; L <= 3 && L < V - 1; L++) {
+            for (int i = 1; i + L <= V; i++) {
+                int p = t[i - 1], a = t[i], b = t[i + L - 1], q = t[(i + L) % V];
+                long gain = d(p, a) + d(b, q) - d(p, q);
+                long inside = fw[i + L - 1] - fw[i], reversed = bw[i + L - 1] - bw[i];
+                for (int j = 0; j < V; j++) {
+                    if (i - 1 <= j && j < i + L) {
+                        continue;
+                    }
+                    int x = t[j], y = t[(j + 1) % V];
+                    long fwd = d(x, a) + d(b, y) - d(x, y);
+                    long rev = d(x, b) + d(a, y) - d(x, y) + reversed - inside;
+                    if (min(fwd, rev) < gain) {
+                        vector<int> seg(begin(t) + i, begin(t) + i + L);
+                        if (rev < fwd) {
+                            reverse(begin(seg), end(seg));
+                        }
+                        t.erase(begin(t) + i, begin(t) + i + L);
+                        int at = find(begin(t), end(t), x) - begin(t) + 1;
+                        t.insert(begin(t) + at, begin(seg), end(seg));
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    for (int s = 0; s < min(V, starts); s++) {
+        t = {s};
+        vector<bool> seen(V);
+        seen[s] = true;
+        for (int k = 1; k < V; k++) {
+            int u = t.back(), next = -1;
+            for (int v = 0; v < V; v++) {
+                if (!seen[v] && (next == -1 || d(u, v) < d(u, next))) {
+                    next = v;
+                }
+            }
+            seen[next] = true, t.push_back(next);
+        }
+        do {
+            rebuild();
+        } while (two_opt() || (rebuild(), or_opt()));
+        if (best > fw[V]) {
+            best = fw[V], best_tour = t;
+        }
+    }
+    if (out_path != nullptr) {
+        auto& path = *out_path = best_tour;
+        rotate(begin(path), find(begin(path), end(path), 0), end(path));
+    }
+    return best;
+}
 
 /**
  * Held-Karp dynamic programming exact algorithm
+ * The subsets of the first n=V-1 vertices are processed by size. A layer holds the sets
+ * of one size in colexicographic (Gosper) order, so a set is stored at its rank in the
+ * combinatorial number system, and each set stores one cost per member; only two layers
+ * of costs are alive at a time. The path is recovered from one byte per state.
+ * Each layer is computed in parallel in blocks of consecutive ranks. A state whose cost
+ * plus a lower bound on the rest of the tour exceeds the local search upper bound is
+ * pruned, and sets with no live state are skipped by the next layer (one bit per set).
  * Complexity: O(V^2 2^V) (~1s for V=22)
- * Memory: O(V 2^V) (prohibitive for V>25)
+ * Memory: O(V binom(V,V/2)) for the costs, O(V 2^V) bytes for the path (V<=28 or so)
  */
-long tsp_held_karp(int V, const vector<vector<int>>& dist, vector<int>* out_path) {
-    static constexpr int inf = INT_MAX / 2;
-    int n = V - 1;
-    vector<vector<int>> cost(1 << n, vector<int>(n, inf));
+long tsp_held_karp(int V, const vector<vector<int>>& dist, vector<int>* out_path,
+                   int nthreads = 1) {
+    static constexpr int inf = INT_MAX / 2, BLOCK = 4096;
+    assert(0 < V && V <= 32 && nthreads > 0);
+    int n = V - 1, T = nthreads;
+    if (n == 0) {
+        if (out_path != nullptr) {
+            *out_path = {0};
+        }
+        return 0;
+    }
+    optional_thread_pool pool(T);
+    thread_pool* P = pool.get();
+
+    // binom[b][j] = C(b,j), the set {c_1<...<c_s} has rank sum C(c_j,j)
+    vector<array<long, 33>> binom(n + 1);
+    for (int b = 0; b <= n; b++) {
+        binom[b][0] = 1;
+        for (int j = 1; j <= 32; j++) {
+            binom[b][j] = b ? binom[b - 1][j - 1] + binom[b - 1][j] : 0;
+        }
+    }
+    auto unrank = [&](long r, int s) {
+        unsigned set = 0;
+        for (int j = s, c = n - 1; j >= 1; j--, c--) {
+            while (binom[c][j] > r) {
+                c--;
+            }
+            set |= 1u << c, r -= binom[c][j];
+        }
+        return set;
+    };
+
+    // every vertex outside the set, and n at the end, still needs an incoming edge
+    vector<long> in_min(V, LONG_MAX);
+    for (int i = 0; i < V; i++) {
+        for (int j = 0; j < V; j++) {
+            if (i != j) {
+                in_min[j] = min(in_min[j], long(dist[i][j]));
+            }
+        }
+    }
+    long rest = accumulate(begin(in_min), end(in_min), 0L);
+    long upper = tsp_local_search(V, dist);
+
+    vector<vector<int>> into(n, vector<int>(n)); // into[k][m] = dist[m][k]
+    for (int k = 0; k < n; k++) {
+        for (int m = 0; m < n; m++) {
+            into[k][m] = dist[m][k];
+        }
+    }
+
+    // layer s: row r holds the costs of the set of rank r ending at each of its s members
+    vector<int> prev(n), cur;
+    vector<uint64_t> prev_alive((n + 63) / 64), cur_alive;
+    vector<vector<uint8_t>> pred(out_path ? n + 1 : 0);
+    auto alive = [&](const vector<uint64_t>& bits, long r) {
+        return bits[r >> 6] >> (r & 63) & 1;
+    };
     for (int i = 0; i < n; i++) {
-        cost[1 << i][i] = dist[n][i];
+        bool live = dist[n][i] + rest - in_min[i] <= upper;
+        prev[i] = live ? dist[n][i] : inf;
+        prev_alive[i >> 6] |= uint64_t(live) << (i & 63);
     }
+
     for (int s = 2; s <= n; s++) {
-        FOR_EACH_MASK (set, s, n) {
-            FOR_EACH_BIT_NUMBER (kbit, k, set) {
-                FOR_EACH_BIT_NUMBER (mbit, m, set ^ kbit) {
-                    cost[set][k] = min(cost[set][k], cost[set ^ kbit][m] + dist[m][k]);
+        long rows = binom[n][s];
+        cur.resize(rows * s), cur_alive.assign((rows + 63) / 64, 0);
+        if (out_path) {
+            pred[s].resize(rows * s);
+        }
+        int blocks = (rows + BLOCK - 1) / BLOCK;
+        parallel_for(P, T, blocks, 1, [&](int, int block) {
+            long r0 = 1L * block * BLOCK, r1 = min(rows, r0 + BLOCK);
+            unsigned set = unrank(r0, s);
+            int el[32], cost[32];
+            for (long r = r0; r < r1; r++, next_lexicographical_mask(set)) {
+                int c = 0;
+                long lower = rest;
+                FOR_EACH_BIT_NUMBER (bit, k, set) {
+                    el[c++] = k, lower -= in_min[k];
                 }
+                // rank of set without el[i]: members above i move down one position
+                long below = 0, above = 0;
+                for (int j = 1; j < s; j++) {
+                    above += binom[el[j]][j];
+                }
+                bool any = false;
+                for (int i = 0; i < s; i++) {
+                    long p = below + above;
+                    below += binom[el[i]][i + 1];
+                    above -= i + 1 < s ? binom[el[i + 1]][i + 1] : 0;
+                    int* out = &cur[r * s + i];
+                    if (!alive(prev_alive, p)) {
+                        *out = inf;
+                        continue;
+                    }
+                    const int* row = &prev[p * (s - 1)];
+                    const int* to = into[el[i]].data();
+                    for (int j = 0; j < i; j++) {
+                        cost[j] = to[el[j]];
+                    }
+                    for (int j = i + 1; j < s; j++) {
+                        cost[j - 1] = to[el[j]];
+                    }
+                    int best = inf;
+                    for (int j = 0; j < s - 1; j++) {
+                        best = min(best, row[j] + cost[j]);
+                    }
+                    best = best + lower <= upper ? best : inf;
+                    *out = best, any |= best < inf;
+                    if (out_path && best < inf) {
+                        int j = 0;
+                        while (row[j] + cost[j] != best) {
+                            j++;
+                        }
+                        pred[s][r * s + i] = j;
+                    }
+                }
+                cur_alive[r >> 6] |= uint64_t(any) << (r & 63);
             }
-        }
+        });
+        swap(prev, cur), swap(prev_alive, cur_alive);
     }
-    // find the optimum and recover the path
-    int optimum = inf;
-    int set = (1 << n) - 1, k = n;
+
+    // find the optimum and recover the path, the full set has rank 0
+    long optimum = inf;
+    int k = 0;
     for (int i = 0; i < n; i++) {
-        if (optimum > cost[set][i] + dist[i][n]) {
-            optimum = cost[set][i] + dist[i][n];
+        if (optimum > prev[i] + dist[i][n]) {
+            optimum = prev[i] + dist[i][n];
             k = i;
         }
     }
     if (out_path == nullptr)
         return optimum;
-    vector<int> path;
-    path.push_back(k);
-    for (int s = n; s >= 2; s--) {
-        int kbit = 1 << k;
-        FOR_EACH_BIT_NUMBER (mbit, m, set ^ kbit) {
-            if (cost[set][k] == cost[set ^ kbit][m] + dist[m][k]) {
-                path.push_back(m);
-                set ^= kbit;
-                k = m;
-                break;
-            }
+    vector<int> path = {k};
+    unsigned set = (1u << n) - 1;
+    for (int s = n, i = k; s >= 2; s--) {
+        long r = 0;
+        int c = 0, el[32];
+        FOR_EACH_BIT_NUMBER (bit, m, set) {
+            r += binom[m][c + 1], el[c++] = m;
         }
+        int j = pred[s][r * s + i];
+        int m = el[j < i ? j : j + 1];
+        path.push_back(m), set ^= 1u << el[i], i = j;
     }
     path.push_back(n);
     reverse(begin(path), end(path));
@@ -18,9 +18,9 @@
  *     - c: (u,v) where 0<=u<m and M<=v.
  *     - d: (u,v) where M<=u   and m<=v<M
  *   * - a: m^2 edges | b: (M-m)^2 edges | c: m(V-M) edges | d: (M-m)(U-M) edges
- *     - total: m^2 + m(V-U-M) + UM edges. must pick m such that this is >=E.
- *     - discriminant: D = (V-U-M)^2 + 4E -4UM
- *     - m<=lo=1/2(M+U-V-sqrt(D)) OR m>=hi=1/2(M+U-V+sqrt(D))
+ *     - total: 2m^2 + m(V-U-2M) + UM edges. must pick m such that this is >=E.
+ *     - discriminant: D = (V-U-2M)^2 + 8E -8UM
+ *     - m<=lo=1/4(2M+U-V-sqrt(D)) OR m>=hi=1/4(2M+U-V+sqrt(D))
  *   - Pick a partition of E-M into 4 parts with the upper cap above (*).
  *   - Add the edges using pair_sample.
  * - Case 2. intend to add edges with probability p
@@ -34,9 +34,10 @@ auto bipartite_matching_max_edges(int U, int V, int M) {
 
 auto bipartite_matching_group_sizes(int U, int V, int M, int E) {
     assert(M <= U && M <= V && M <= E && E <= bipartite_matching_max_edges(U, V, M));
-    long delta = 1L * (V - U - M) * (V - U - M) + 4L * E - 4L * U * M;
-    int lo = (M + U - V - sqrt(delta)) / 2;
-    int hi = (M + U - V + sqrt(delta) + 1) / 2;
+    long delta = 1L * (V - U - 2 * M) * (V - U - 2 * M) + 8L * E - 8L * U * M;
+    double root = sqrt(max(delta, 0L)); // delta<0: every m has enough room
+    int lo = floor((2 * M + U - V - root) / 4);
+    int hi = ceil((2 * M + U - V + root) / 4);
     assert(0 <= lo || hi <= M);
 
     lo = clamp(lo, -1, M), hi = clamp(hi, lo + 1, M + 1);
@@ -768,7 +768,7 @@ auto random_forest(const vector<int>& tree_sizes) {
     g.reserve(accumulate(begin(tree_sizes), end(tree_sizes), 0));
     int T = tree_sizes.size();
     for (int i = 0, s = 0; i < T; s += tree_sizes[i++]) {
-        for (auto [u, v] : random_tree(T)) {
+        for (auto [u, v] : random_tree(tree_sizes[i])) {
             g.push_back({u + s, v + s});
         }
     }
@@ -787,7 +787,7 @@ auto random_geometric_forest(const vector<int>& tree_sizes, double alpha) {
     g.reserve(accumulate(begin(tree_sizes), end(tree_sizes), 0));
     int T = tree_sizes.size();
     for (int i = 0, s = 0; i < T; s += tree_sizes[i++]) {
-        for (auto [u, v] : random_geometric_tree(T, alpha)) {
+        for (auto [u, v] : random_geometric_tree(tree_sizes[i], alpha)) {
             g.push_back({u + s, v + s});
         }
     }
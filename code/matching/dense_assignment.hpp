@@ -0,0 +1,255 @@
+#pragma once
+
+#include "../parallel/thread_pool.hpp" // thread_pool, parallel_for
+
+/**
+ * Min-cost perfect assignment on a dense cost matrix (nonnegative integer costs)
+ * The costs live in one row-major WxW matrix, W=max(U,V); the padding rows or columns
+ * hold the cost given to the constructor, every entry starts with it. For sparse graphs
+ * use mincost_hungarian, which never materializes the missing edges.
+ *
+ * lapjv(): Jonker-Volgenant. Column reduction, reduction transfer and two rounds of
+ *     augmenting row reduction assign most rows cheaply, then every free row is assigned
+ *     by a dijkstra over the columns. The dijkstra keeps its state in flat arrays and its
+ *     scans (relaxation, minimum, price update) run over all columns without branches, so
+ *     they vectorize.
+ *     Complexity: O(W^3), usually much less.
+ *
+ * auction(nthreads): Bertsekas' auction with epsilon scaling, Jacobi flavour. Costs are
+ *     scaled by W+1 so that the final epsilon=1 gives an optimal assignment. In each
+ *     round every unassigned row bids for its best column at the same time, the bids are
+ *     computed in parallel and resolved serially.
+ *     Complexity: O(W^3 log(WC)) worst case.
+ *
+ * Both return the cost, without the padding unless include_padding.
+ * m[0][u] is the column of row u and m[1][v] the row of column v.
+ */
+template <typename Cost = int, typename CostSum = long>
+struct dense_assignment {
+    int U = 0, V = 0, W = 0;
+    vector<Cost> cost;
+    vector<int> m[2];
+
+    dense_assignment() = default;
+    dense_assignment(int U, int V, Cost pad = 0)
+        : U(U), V(V), W(max(U, V)), cost(1L * W * W, pad) {}
+
+    void add(int u, int v, Cost w) {
+        assert(0 <= u && u < U && 0 <= v && v < V && w >= 0);
+        cost[1L * u * W + v] = w;
+    }
+    const Cost* row(int u) const { return &cost[1L * u * W]; }
+
+    static inline constexpr CostSum inf = numeric_limits<CostSum>::max() / 4;
+
+    auto lapjv(bool include_padding = false) {
+        vector<int>&x = m[0], &y = m[1];
+        x.assign(W, -1), y.assign(W, -1);
+        vector<CostSum> v(W, inf);
+
+        // column reduction, row by row so that the inner loop is contiguous
+        vector<int> arg(W, 0), matches(W, 0);
+        for (int i = 0; i < W; i++) {
+            const Cost* c = row(i);
+            for (int j = 0; j < W; j++) {
+                bool better = c[j] < v[j];
+                v[j] = better ? c[j] : v[j];
+                arg[j] = better ? i : arg[j];
+            }
+        }
+        for (int j = W - 1; j >= 0; j--) {
+            int i = arg[j];
+            if (matches[i]++ == 0) {
+                x[i] = j, y[j] = i;
+            } else if (v[j] < v[x[i]]) {
+                y[x[i]] = -1, x[i] = j, y[j] = i;
+            }
+        }
+
+        // reduction transfer, rows assigned several columns keep the last one
+        vector<int> free;
+        for (int i = 0; i < W; i++) {
+            if (matches[i] == 0) {
+                free.push_back(i);
+            } else if (matches[i] == 1) {
+                int j1 = x[i];
+                CostSum keep = v[j1], least = inf;
+                v[j1] = -inf;
+                const Cost* c = row(i);
+                for (int j = 0; j < W; j++) {
+                    least = min(least, c[j] - v[j]);
+                }
+                v[j1] = keep - least;
+            }
+        }
+
+        // augmenting row reduction
+        for (int round = 0; round < 2 && W > 1 && !free.empty(); round++) {
+            vector<int> next;
+            for (int k = 0, S = free.size(); k < S;) {
+                int i = free[k++];
+                const Cost* c = row(i);
+                CostSum u1 = inf, u2 = inf;
+                int j1 = 0, j2 = 0;
+                for (int j = 0; j < W; j++) {
+                    CostSum h = c[j] - v[j];
+                    if (h < u2) {
+                        if (h >= u1) {
+                            u2 = h, j2 = j;
+                        } else {
+                            u2 = u1, j2 = j1, u1 = h, j1 = j;
+                        }
+                    }
+                }
+                int i0 = y[j1];
+                if (u1 < u2) {
+                    v[j1] -= u2 - u1;
+                } else if (i0 != -1) {
+                    j1 = j2, i0 = y[j2];
+                }
+                if (i0 != -1) {
+                    x[i0] = -1;
+                    if (u1 < u2) {
+                        free[--k] = i0;
+                    } else {
+                        next.push_back(i0);
+                    }
+                }
+                x[i] = j1, y[j1] = i;
+            }
+            free = move(next);
+        }
+
+        // augmentation, dense dijkstra from each free row
+        vector<CostSum> d(W);
+        vector<int> pred(W);
+        vector<char> ready(W);
+        for (int f : free) {
+            const Cost* c = row(f);
+            for (int j = 0; j < W; j++) {
+                d[j] = c[j] - v[j], pred[j] = f, ready[j] = 0;
+            }
+            int end = -1;
+            CostSum least = 0;
+            while (end == -1) {
+                least = inf;
+                for (int j = 0; j < W; j++) {
+                    least = min(least, ready[j] ? inf : d[j]);
+                }
+                // among the closest columns take a free one if there is one, this
+                // matters with few distinct costs
+                int j1 = -1;
+                for (int j = 0; j < W; j++) {
+                    if (!ready[j] && d[j] == least) {
+                        j1 = j1 == -1 || y[j] == -1 ? j : j1;
+                        if (y[j] == -1) {
+                            break;
+                        }
+                    }
+                }
+                ready[j1] = 1;
+                if (y[j1] == -1) {
+                    end = j1;
+                    break;
+                }
+                int i = y[j1];
+                const Cost* ci = row(i);
+                CostSum h = ci[j1] - v[j1] - least;
+                for (int j = 0; j < W; j++) {
+                    CostSum relaxed = ci[j] - v[j] - h;
+                    bool better = !ready[j] && relaxed < d[j];
+                    d[j] = better ? relaxed : d[j];
+                    pred[j] = better ? i : pred[j];
+                }
+            }
+            for (int j = 0; j < W; j++) {
+                v[j] += ready[j] ? d[j] - least : 0;
+            }
+            for (int i = -1; i != f;) {
+                i = pred[end], y[end] = i, swap(x[i], end);
+            }
+        }
+        return total_cost(include_padding);
+    }
+
+    auto auction(int nthreads = 1, bool include_padding = false) {
+        constexpr int GRAIN = 8, SCALE_DOWN = 6;
+        int T = nthreads;
+        assert(T > 0);
+        optional_thread_pool pool(T);
+        thread_pool* P = pool.get();
+
+        vector<int>&x = m[0], &y = m[1];
+        const CostSum S = W + 1;
+        Cost maxc = W ? *max_element(begin(cost), end(cost)) : 0;
+        vector<CostSum> price(W, 0), bid(W);
+        vector<int> target(W), free, winner(W, -1), best(W);
+
+        for (CostSum eps = max<CostSum>(1, maxc * S / SCALE_DOWN);; eps /= SCALE_DOWN) {
+            eps = max<CostSum>(eps, 1);
+            x.assign(W, -1), y.assign(W, -1);
+            free.resize(W), iota(begin(free), end(free), 0);
+            while (!free.empty()) {
+                int F = free.size();
+                // bid: value of column j is -(c*S + price), the best one is raised to
+                // the price at which it is as good as the second best, plus eps
+                parallel_for(P, T, F, GRAIN, [&](int, int k) {
+                    const Cost* c = row(free[k]);
+                    CostSum v1 = inf, v2 = inf;
+                    for (int j = 0; j < W; j++) {
+                        v1 = min(v1, c[j] * S + price[j]);
+                    }
+                    int j1 = 0;
+                    while (c[j1] * S + price[j1] != v1) {
+                        j1++;
+                    }
+                    for (int j = 0; j < j1; j++) {
+                        v2 = min(v2, c[j] * S + price[j]);
+                    }
+                    for (int j = j1 + 1; j < W; j++) {
+                        v2 = min(v2, c[j] * S + price[j]);
+                    }
+                    target[k] = j1;
+                    bid[k] = price[j1] + (W > 1 ? v2 - v1 : 0) + eps;
+                });
+                // resolve: the highest bid for each column wins it
+                for (int k = 0; k < F; k++) {
+                    int j = target[k];
+                    if (winner[j] == -1 || bid[best[j]] < bid[k]) {
+                        winner[j] = free[k], best[j] = k;
+                    }
+                }
+                vector<int> next;
+                for (int k = 0; k < F; k++) {
+                    int i = free[k], j = target[k];
+                    if (winner[j] != i) {
+                        next.push_back(i);
+                        continue;
+                    }
+                    if (y[j] != -1) {
+                        x[y[j]] = -1, next.push_back(y[j]);
+                    }
+                    x[i] = j, y[j] = i, price[j] = bid[k];
+                }
+                for (int k = 0; k < F; k++) {
+                    winner[target[k]] = -1;
+                }
+                free = move(next);
+            }
+            if (eps == 1) {
+                break;
+            }
+        }
+        return total_cost(include_padding);
+    }
+
+    CostSum total_cost(bool include_padding) const {
+        CostSum sum = 0;
+        for (int u = 0; u < W; u++) {
+            if (include_padding || (u < U && m[0][u] < V)) {
+                sum += row(u)[m[0][u]];
+            }
+        }
+        return sum;
+    }
+};
@@ -3,8 +3,97 @@
 #include <bits/stdc++.h>
 using namespace std;
 
+/**
+ * Karp-Sipser greedy initial matching: while some vertex has exactly one unmatched
+ * neighbour match them, otherwise match an arbitrary edge. Degrees count unmatched
+ * neighbours. Unmatched vertices are -1 in mu and mv.
+ * Complexity: O(V + E)
+ */
+inline int karp_sipser(int U, int V, const vector<vector<int>>& adj, vector<int>& mu,
+                       vector<int>& mv) {
+    vector<int> off(V + 1), radj, du(U), dv(V);
+    for (int u = 0; u < U; u++) {
+        for (int v : adj[u]) {
+            off[v + 1]++;
+        }
+    }
+    partial_sum(begin(off), end(off), begin(off));
+    radj.resize(off[V]);
+    vector<int> at(begin(off), end(off) - 1);
+    for (int u = 0; u < U; u++) {
+        du[u] = adj[u].size();
+        for (int v : adj[u]) {
+            radj[at[v]++] = u;
+        }
+    }
+    for (int v = 0; v < V; v++) {
+        dv[v] = off[v + 1] - off[v];
+    }
+
+    vector<int> ones; // degree one vertices, v is stored as U+v
+    for (int u = 0; u < U; u++) {
+        if (du[u] == 1) {
+            ones.push_back(u);
+        }
+    }
+    for (int v = 0; v < V; v++) {
+        if (dv[v] == 1) {
+            ones.push_back(U + v);
+        }
+    }
+    int matching = 0;
+    auto match = [&](int u, int v) {
+        mu[u] = v, mv[v] = u, matching++;
+        for (int w : adj[u]) {
+            if (mv[w] == -1 && --dv[w] == 1) {
+                ones.push_back(U + w);
+            }
+        }
+        for (int i = off[v]; i < off[v + 1]; i++) {
+            if (int w = radj[i]; mu[w] == -1 && --du[w] == 1) {
+                ones.push_back(w);
+            }
+        }
+    };
+    for (int next = 0; next < U;) {
+        if (!ones.empty()) {
+            int x = ones.back();
+            ones.pop_back();
+            if (x < U && mu[x] == -1) {
+                for (int v : adj[x]) {
+                    if (mv[v] == -1) {
+                        match(x, v);
+                        break;
+                    }
+                }
+            } else if (x >= U && mv[x - U] == -1) {
+                for (int i = off[x - U]; i < off[x - U + 1]; i++) {
+                    if (mu[radj[i]] == -1) {
+                        match(radj[i], x - U);
+                        break;
+                    }
+                }
+            }
+        } else if (mu[next] == -1) {
+            for (int v : adj[next]) {
+                if (mv[v] == -1) {
+                    match(next, v);
+                    break;
+                }
+            }
+            next++;
+        } else {
+            next++;
+        }
+    }
+    return matching;
+}
+
 /**
  * Hopcroft-Karp maximum bipartite matching
+ * Starts from a Karp-Sipser matching. The bfs uses a flat queue and the dfs is iterative
+ * with a current arc per vertex, a vertex that fails is cut off for the phase.
+ * mu[u] and mv[v] are the partners of u and v, -1 if unmatched.
  * Complexity: O(V^1/2 E)
  */
 struct hopcroft_karp {
@@ -23,30 +112,28 @@ struct hopcroft_karp {
         adj[u].push_back(v);
     }
 
-    vector<int> vis, dist;
-    int iteration;
+    vector<int> dist, arc, Q, path;
     static inline constexpr int inf = INT_MAX / 2;
 
     bool bfs() {
-        queue<int> Q;
+        Q.clear();
         for (int u = 0; u < U; u++) {
             if (mu[u] == -1) {
                 dist[u] = 0;
-                Q.push(u);
+                Q.push_back(u);
             } else {
                 dist[u] = inf;
             }
         }
         dist[U] = inf;
-        while (!Q.empty()) {
-            int u = Q.front();
-            Q.pop();
+        for (int i = 0; i < int(Q.size()); i++) {
+            int u = Q[i];
             if (dist[u] < dist[U]) {
                 for (int v : adj[u]) {
                     // note: the check v != mu[u] is implicit in dist[mv[v]] == inf
                     if (dist[mv[v]] == inf) {
                         dist[mv[v]] = dist[u] + 1;
-                        Q.push(mv[v]);
+                        Q.push_back(mv[v]);
                     }
                 }
             }
@@ -54,18 +141,24 @@ struct hopcroft_karp {
         return dist[U] != inf;
     }
 
-    bool dfs(int u) {
-        if (u == U) {
-            return true;
-        }
-        if (vis[u] == iteration) {
-            return false;
-        }
-        vis[u] = iteration;
-        for (int v : adj[u]) {
-            if (dist[mv[v]] == dist[u] + 1 && dfs(mv[v])) {
-                mv[v] = u;
-                mu[u] = v;
+    bool dfs(int s) {
+        path = {s};
+        while (!path.empty()) {
+            int u = path.back();
+            if (arc[u] == int(adj[u].size())) {
+                dist[u] = inf, path.pop_back();
+                continue;
+            }
+            int x = mv[adj[u][arc[u]]];
+            if (dist[x] != dist[u] + 1) {
+                arc[u]++;
+            } else if (x != U) {
+                path.push_back(x);
+            } else {
+                for (int w : path) {
+                    int v = adj[w][arc[w]];
+                    mv[v] = w, mu[w] = v, dist[w] = inf; // paths are vertex disjoint
+                }
                 return true;
             }
         }
@@ -73,14 +166,13 @@ struct hopcroft_karp {
     }
 
     int compute() {
-        vis.assign(U + 1, 0);
         dist.assign(U + 1, 0);
         mu.assign(U + 1, -1);
-        mv.assign(V, U);
-        int matching = 0;
-        iteration = 0;
+        mv.assign(V, -1);
+        int matching = karp_sipser(U, V, adj, mu, mv);
+        replace(begin(mv), end(mv), -1, U); // U is the sink of the layers while running
         while (bfs()) {
-            iteration++;
+            arc.assign(U, 0);
             for (int u = 0; u < U; u++) {
                 if (mu[u] == -1 && dfs(u)) {
                     matching++;
@@ -88,6 +180,7 @@ struct hopcroft_karp {
             }
         }
         mu.pop_back();
+        replace(begin(mv), end(mv), U, -1);
         return matching;
     }
 };
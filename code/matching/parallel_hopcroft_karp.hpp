@@ -0,0 +1,154 @@
+#pragma once
+
+#include "hopcroft_karp.hpp"           // karp_sipser
+#include "../parallel/thread_pool.hpp" // thread_pool, run_on_each_thread, parallel_for
+
+/**
+ * Parallel Hopcroft-Karp maximum bipartite matching
+ * Starts from a Karp-Sipser matching. Each phase builds the layers with a level
+ * synchronous parallel bfs from the free vertices of U, claiming a vertex with a CAS on
+ * its distance. Then every free vertex of U runs an iterative dfs in parallel; a thread
+ * claims every vertex of U it enters and the free vertex of V it ends on, so the paths
+ * found are vertex disjoint and are augmented without locks. A claimed vertex is dead
+ * for the rest of the phase to the other threads, which can cost a path in the phase,
+ * the next phase finds it; a phase that augments nothing is redone on one thread.
+ * mu[u] and mv[v] are the partners of u and v, -1 if unmatched.
+ * Complexity: O(V^1/2 E) work
+ */
+struct parallel_hopcroft_karp {
+    int U, V;
+    vector<vector<int>> adj;
+    vector<int> mu, mv;
+
+    parallel_hopcroft_karp(int U, int V, const vector<array<int, 2>>& g = {})
+        : U(U), V(V), adj(U) {
+        for (auto [u, v] : g)
+            add(u, v);
+    }
+
+    void add(int u, int v) {
+        assert(0 <= u && u < U && 0 <= v && v < V);
+        adj[u].push_back(v);
+    }
+
+    static inline constexpr int inf = INT_MAX / 2, GRAIN = 256;
+
+    vector<int> off, head, arc, free_u;
+    vector<atomic<int>> dist, mate, claim, taken; // mate[v] = mv[v], -1 if free
+    vector<vector<int>> found, path;
+    int stamp = 0;
+
+    // layers from the free vertices of U, returns the shortest augmenting path length
+    int bfs(thread_pool* pool, int T) {
+        for (int u = 0; u < U; u++) {
+            dist[u].store(mu[u] == -1 ? 0 : inf, memory_order_relaxed);
+        }
+        vector<int> frontier = free_u;
+        atomic<bool> done = false;
+        for (int level = 1; !frontier.empty() && !done; level++) {
+            parallel_for(pool, T, frontier.size(), GRAIN, [&](int t, int i) {
+                for (int e = off[frontier[i]]; e < off[frontier[i] + 1]; e++) {
+                    int x = mate[head[e]].load(memory_order_relaxed), old = inf;
+                    if (x == -1) {
+                        done.store(true, memory_order_relaxed);
+                    } else if (dist[x].load(memory_order_relaxed) == inf &&
+                               dist[x].compare_exchange_strong(old, level,
+                                                               memory_order_relaxed)) {
+                        found[t].push_back(x);
+                    }
+                }
+            });
+            frontier.clear();
+            for (int t = 0; t < T; t++) {
+                frontier.insert(end(frontier), begin(found[t]), end(found[t]));
+                found[t].clear();
+            }
+            if (done) {
+                return level;
+            }
+        }
+        return inf;
+    }
+
+    bool dfs(int t, int s, int L) {
+        auto& P = path[t];
+        P = {s};
+        while (!P.empty()) {
+            int u = P.back(), du = dist[u].load(memory_order_relaxed);
+            if (arc[u] == off[u + 1]) {
+                P.pop_back();
+                continue;
+            }
+            int v = head[arc[u]], x = mate[v].load(memory_order_relaxed);
+            if (x == -1) {
+                if (du + 1 == L &&
+                    taken[v].exchange(stamp, memory_order_relaxed) != stamp) {
+                    for (int w : P) {
+                        int y = head[arc[w]];
+                        mate[y].store(w, memory_order_relaxed), mu[w] = y;
+                    }
+                    return true;
+                }
+                arc[u]++;
+            } else if (dist[x].load(memory_order_relaxed) == du + 1 &&
+                       claim[x].exchange(stamp, memory_order_relaxed) != stamp) {
+                P.push_back(x);
+            } else {
+                arc[u]++;
+            }
+        }
+        return false;
+    }
+
+    int compute(int nthreads = 1) {
+        int T = nthreads;
+        assert(T > 0);
+        optional_thread_pool pool(T);
+        thread_pool* P = pool.get();
+
+        off.assign(U + 1, 0), head.clear();
+        for (int u = 0; u < U; u++) {
+            head.insert(end(head), begin(adj[u]), end(adj[u]));
+            off[u + 1] = head.size();
+        }
+        mu.assign(U, -1), mv.assign(V, -1);
+        int matching = karp_sipser(U, V, adj, mu, mv);
+
+        dist = vector<atomic<int>>(U), claim = vector<atomic<int>>(U);
+        mate = vector<atomic<int>>(V), taken = vector<atomic<int>>(V);
+        for (int v = 0; v < V; v++) {
+            mate[v].store(mv[v], memory_order_relaxed);
+        }
+        found.assign(T, {}), path.assign(T, {}), arc.resize(U), stamp = 0;
+
+        for (bool serial = false;;) {
+            free_u.clear();
+            for (int u = 0; u < U; u++) {
+                if (mu[u] == -1) {
+                    free_u.push_back(u);
+                }
+            }
+            int L = bfs(P, T);
+            if (L == inf) {
+                break;
+            }
+            stamp++;
+            for (int u = 0; u < U; u++) {
+                arc[u] = off[u];
+            }
+            atomic<int> augmented = 0;
+            parallel_for(P, serial ? 1 : T, free_u.size(), 1, [&](int t, int i) {
+                int s = free_u[i];
+                if (claim[s].exchange(stamp, memory_order_relaxed) != stamp &&
+                    dfs(t, s, L)) {
+                    augmented.fetch_add(1, memory_order_relaxed);
+                }
+            });
+            matching += augmented, serial = augmented == 0;
+        }
+        for (int v = 0; v < V; v++) {
+            mv[v] = mate[v].load(memory_order_relaxed);
+        }
+        return matching;
+    }
+};
@@ -0,0 +1,444 @@
+#pragma once
+
+#include <bits/stdc++.h>
+using namespace std;
+
+/**
+ * Min-cost perfect matching in general graphs (Edmonds' weighted blossom algorithm,
+ * organized like Kolmogorov's Blossom V)
+ * Any integer costs, multi-edges are fine. Returns the cost, or nullopt if there is no
+ * perfect matching. mate[u] is the vertex matched to u, -1 everywhere on failure.
+ *
+ * Greedy initialization: y[u] starts at half the cheapest edge at u, then every exposed
+ * vertex raises its dual until an edge becomes tight and takes it if the other end is
+ * exposed too. Every exposed vertex then roots an alternating tree, and the trees are
+ * kept across augmentations: an augmentation only dissolves the two trees it joins.
+ * The dual update is a single delta shared by all trees, kept implicitly: a node in a
+ * tree stores its dual at the time it got its label. Events happen at fixed times then,
+ * so every candidate event goes in one priority queue keyed by its time:
+ *   grow    tight edge from a + node to a node outside the trees (slack falls by 1)
+ *   shrink  tight edge between two + nodes of the same tree (slack falls by 2)
+ *   augment tight edge between two + nodes of different trees (slack falls by 2)
+ *   expand  - blossom whose dual reaches 0 (dual falls by 1)
+ * Entries are pushed whenever a node changes label and checked when popped, stale ones
+ * are dropped. Costs are scaled by 4 so that all the duals stay integer.
+ * Complexity: O(V E log E) worst case, near O(E log E) on random graphs.
+ */
+template <typename Cost = long, typename CostSum = Cost>
+struct weighted_blossom {
+    int V, E = 0;
+    vector<array<int, 2>> edge;
+    vector<Cost> cost;
+    vector<int> mate;
+
+    explicit weighted_blossom(int V) : V(V) {}
+
+    void add(int u, int v, Cost w) {
+        assert(0 <= u && u < V && 0 <= v && v < V && u != v);
+        edge.push_back({u, v}), cost.push_back(w), E++;
+    }
+
+    optional<CostSum> mincost_perfect_matching() {
+        mate.assign(V, -1);
+        init();
+        if (!greedy()) {
+            return nullopt;
+        }
+        int exposed = 0;
+        for (int u = 0; u < V; u++) {
+            if (me[u] == -1) {
+                exposed++, set_label(u, PLUS, u);
+            }
+        }
+        for (int u = 0; u < V; u++) {
+            if (me[u] == -1) {
+                scan(u);
+            }
+        }
+        while (exposed > 0) {
+            if (events.empty()) {
+                return nullopt;
+            }
+            auto [time, id] = events.top();
+            events.pop();
+            if (event_time(id) != time) {
+                continue;
+            }
+            now = time;
+            if (id >= E) {
+                expand(id - E);
+                continue;
+            }
+            int a = top(edge[id][0]), b = top(edge[id][1]);
+            if (label[a] != PLUS || label[b] != PLUS) {
+                grow(id);
+            } else if (tree[a] == tree[b]) {
+                shrink(id);
+            } else {
+                augment(id), exposed -= 2;
+            }
+        }
+        CostSum total = 0;
+        for (int u = 0; u < V; u++) {
+            mate[u] = other(me[u], u);
+            total += u < mate[u] ? cost[me[u]] : 0;
+        }
+        return total;
+    }
+
+  private:
+    static constexpr int PLUS = 1, MINUS = -1, FREE = 0;
+    static constexpr CostSum inf = numeric_limits<CostSum>::max();
+
+    vector<int> off, inc; // incident edges of each vertex
+    vector<CostSum> w;    // 4 * cost
+    vector<int> me;       // matched edge of each vertex, -1 if exposed
+
+    // nodes: vertices [0,V) and blossoms [V,2V)
+    // y[b] is b's dual at time since[b], it moves with the label only while b is outer.
+    // the duals of nodes inside a blossom are frozen, so up/acc is a weighted union-find
+    // on the blossom forest: up[x] is an ancestor of x and acc[x] sums the duals from x
+    // up to it, excluded. The dual of vertex u is acc[u] + dual(top(u)) after top(u).
+    // Expanding b resets the nodes compressed onto it to {parent[x], y[x]}.
+    vector<int> up, parent, base, label, tree, tedge, mark, spare;
+    vector<CostSum> y, since, acc;
+    vector<vector<int>> compressed;       // nodes whose up was compressed onto each node
+    vector<vector<int>> child;            // blossom cycle, child[0] holds the base
+    vector<vector<array<int, 3>>> link;   // {e,x,y}: e joins x in child i to y in i+1
+    vector<vector<int>> members;          // outer nodes of each tree, lazily cleaned
+    priority_queue<pair<CostSum, int>, vector<pair<CostSum, int>>, greater<>> events;
+    CostSum now = 0;
+    int stamp = 0;
+
+    int other(int e, int u) const { return u ^ edge[e][0] ^ edge[e][1]; }
+    CostSum dual(int b) const { return y[b] + label[b] * (now - since[b]); }
+    CostSum slack(int e) {
+        auto [u, v] = edge[e];
+        CostSum du = dual(top(u)), dv = dual(top(v));
+        return w[e] - acc[u] - du - acc[v] - dv;
+    }
+
+    // outermost node containing x, compresses the path
+    int top(int x) {
+        int r = x;
+        CostSum sum = 0;
+        while (up[r] != r) {
+            sum += acc[r], r = up[r];
+        }
+        while (up[x] != r && x != r) {
+            int next = up[x];
+            CostSum step = acc[x];
+            up[x] = r, acc[x] = sum, sum -= step;
+            compressed[r].push_back(x), x = next;
+        }
+        return r;
+    }
+    bool is_outer_blossom(int b) const {
+        return b >= V && !child[b].empty() && parent[b] == -1;
+    }
+
+    void init() {
+        off.assign(V + 1, 0), inc.resize(2 * E), w.resize(E);
+        for (int e = 0; e < E; e++) {
+            off[edge[e][0] + 1]++, off[edge[e][1] + 1]++;
+            w[e] = CostSum(4) * cost[e];
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        vector<int> at(begin(off), end(off) - 1);
+        for (int e = 0; e < E; e++) {
+            inc[at[edge[e][0]]++] = e, inc[at[edge[e][1]]++] = e;
+        }
+        me.assign(V, -1), up.resize(2 * V), acc.assign(2 * V, 0);
+        iota(begin(up), end(up), 0), compressed.assign(2 * V, {});
+        parent.assign(2 * V, -1), base.resize(2 * V), label.assign(2 * V, FREE);
+        tree.assign(2 * V, -1), tedge.assign(2 * V, -1), mark.assign(2 * V, 0);
+        iota(begin(base), end(base), 0);
+        y.assign(2 * V, 0), since.assign(2 * V, 0);
+        child.assign(2 * V, {}), link.assign(2 * V, {}), members.assign(V, {});
+        spare.resize(V), iota(rbegin(spare), rend(spare), V);
+        events = {}, now = 0, stamp = 0;
+    }
+
+    bool greedy() {
+        for (int u = 0; u < V; u++) {
+            if (off[u] == off[u + 1]) {
+                return false;
+            }
+            y[u] = inf;
+            for (int i = off[u]; i < off[u + 1]; i++) {
+                y[u] = min(y[u], w[inc[i]] / 2);
+            }
+        }
+        for (int u = 0; u < V; u++) {
+            if (me[u] != -1) {
+                continue;
+            }
+            CostSum least = inf;
+            for (int i = off[u]; i < off[u + 1]; i++) {
+                least = min(least, slack(inc[i]));
+            }
+            y[u] += least;
+            for (int i = off[u]; i < off[u + 1]; i++) {
+                int e = inc[i], v = other(e, u);
+                if (slack(e) == 0 && me[v] == -1) {
+                    me[u] = me[v] = e;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename Fn>
+    void for_vertices(int b, Fn&& fn) {
+        if (b < V) {
+            fn(b);
+            return;
+        }
+        vector<int> stack = {b};
+        while (!stack.empty()) {
+            int x = stack.back();
+            stack.pop_back();
+            if (x < V) {
+                fn(x);
+            } else {
+                stack.insert(end(stack), begin(child[x]), end(child[x]));
+            }
+        }
+    }
+
+    // time of the event of an edge (or of blossom id-E), inf if there is none
+    CostSum event_time(int id) {
+        if (id >= E) {
+            int b = id - E;
+            return is_outer_blossom(b) && label[b] == MINUS ? now + dual(b) : inf;
+        }
+        int a = top(edge[id][0]), b = top(edge[id][1]);
+        if (a == b) {
+            return inf;
+        } else if (label[a] == PLUS && label[b] == PLUS) {
+            assert(slack(id) % 2 == 0);
+            return now + slack(id) / 2;
+        } else if (label[a] + label[b] == PLUS) {
+            return now + slack(id);
+        }
+        return inf;
+    }
+
+    void push_edge(int e) {
+        if (CostSum time = event_time(e); time != inf) {
+            events.push({time, e});
+        }
+    }
+
+    void scan(int b) {
+        for_vertices(b, [&](int u) {
+            for (int i = off[u]; i < off[u + 1]; i++) {
+                push_edge(inc[i]);
+            }
+        });
+    }
+
+    void fix(int b) { y[b] = dual(b), since[b] = now; }
+
+    void set_label(int b, int l, int t) {
+        fix(b), label[b] = l, tree[b] = t;
+        if (l != FREE) {
+            members[t].push_back(b);
+        }
+        if (l == MINUS && b >= V) {
+            events.push({now + y[b], E + b});
+        }
+    }
+
+    int endpoint_in(int e, int b) {
+        return top(edge[e][0]) == b ? edge[e][0] : edge[e][1];
+    }
+
+    // the + node above the + node b in its tree, -1 at the root
+    int grandparent(int b) {
+        int e = me[base[b]];
+        if (e == -1) {
+            return -1;
+        }
+        int m = top(other(e, base[b]));
+        return top(other(tedge[m], endpoint_in(tedge[m], m)));
+    }
+
+    void grow(int e) {
+        auto [u, v] = edge[e];
+        if (label[top(u)] != PLUS) {
+            swap(u, v);
+        }
+        int a = top(u), b = top(v);
+        int c = top(other(me[base[b]], base[b]));
+        set_label(b, MINUS, tree[a]), tedge[b] = e;
+        set_label(c, PLUS, tree[a]);
+        scan(c);
+    }
+
+    void shrink(int e) {
+        int a = top(edge[e][0]), b = top(edge[e][1]);
+        stamp++;
+        int lca = -1;
+        for (int x = a, z = b; lca == -1; swap(x, z)) {
+            if (x != -1) {
+                if (mark[x] == stamp) {
+                    lca = x;
+                }
+                mark[x] = stamp, x = grandparent(x);
+            }
+        }
+
+        // children: lca down to a, then b up to just below lca
+        vector<int> nodes, edges, down, down_edges;
+        auto climb = [&](int x, vector<int>& path, vector<int>& path_edges) {
+            path = {x};
+            while (x != lca) {
+                int em = me[base[x]], m = top(other(em, base[x])), f = tedge[m];
+                x = top(other(f, endpoint_in(f, m)));
+                path.insert(end(path), {m, x});
+                path_edges.insert(end(path_edges), {em, f});
+            }
+        };
+        climb(a, down, down_edges);
+        climb(b, nodes, edges);
+        reverse(begin(down), end(down)), reverse(begin(down_edges), end(down_edges));
+        down_edges.push_back(e);
+        down.insert(end(down), begin(nodes), end(nodes) - 1);
+        down_edges.insert(end(down_edges), begin(edges), end(edges));
+
+        int B = spare.back(), k = down.size();
+        spare.pop_back();
+        child[B] = down, link[B].resize(k);
+        for (int i = 0; i < k; i++) {
+            int f = down_edges[i], x = endpoint_in(f, down[i]);
+            link[B][i] = {f, x, other(f, x)};
+        }
+        base[B] = base[lca], parent[B] = -1, up[B] = B, acc[B] = 0;
+        y[B] = 0, since[B] = now;
+        label[B] = PLUS, tree[B] = tree[lca], members[tree[B]].push_back(B);
+        vector<int> was_minus;
+        for (int c : down) {
+            if (label[c] == MINUS) {
+                was_minus.push_back(c);
+            }
+            fix(c), label[c] = FREE, tree[c] = -1, parent[c] = B;
+            up[c] = B, acc[c] = y[c];
+        }
+        for (int c : was_minus) {
+            scan(c);
+        }
+    }
+
+    // make vertex v the base of blossom b, rematching along the even side of the cycle
+    void rebase(int b, int v) {
+        int t = v;
+        while (parent[t] != b) {
+            t = parent[t];
+        }
+        if (t >= V) {
+            rebase(t, v);
+        }
+        auto& ch = child[b];
+        int k = ch.size(), i = find(begin(ch), end(ch), t) - begin(ch);
+        auto match = [&](int j) {
+            auto [e, x, z] = link[b][j];
+            if (ch[j] >= V) {
+                rebase(ch[j], x);
+            }
+            if (ch[(j + 1) % k] >= V) {
+                rebase(ch[(j + 1) % k], z);
+            }
+            me[x] = me[z] = e;
+        };
+        if (i % 2 == 1) {
+            for (int j = i + 1; j < k; j += 2) {
+                match(j);
+            }
+        } else {
+            for (int j = i - 2; j >= 0; j -= 2) {
+                match(j);
+            }
+        }
+        rotate(begin(ch), begin(ch) + i, end(ch));
+        rotate(begin(link[b]), begin(link[b]) + i, end(link[b]));
+        base[b] = v;
+    }
+
+    // match vertex u through e and flip the tree path above it
+    void augment_path(int u, int e) {
+        while (true) {
+            int s = top(u), old = base[s], em = me[old];
+            if (s >= V) {
+                rebase(s, u);
+            }
+            me[u] = e;
+            if (em == -1) {
+                break;
+            }
+            int m = top(other(em, old)), f = tedge[m], x = endpoint_in(f, m);
+            if (m >= V) {
+                rebase(m, x);
+            }
+            me[x] = f;
+            u = other(f, x), e = f;
+        }
+    }
+
+    void augment(int e) {
+        int ta = tree[top(edge[e][0])], tb = tree[top(edge[e][1])];
+        augment_path(edge[e][0], e);
+        augment_path(edge[e][1], e);
+        vector<int> dissolved;
+        for (int t : {ta, tb}) {
+            for (int b : members[t]) {
+                if ((b < V || is_outer_blossom(b)) && tree[b] == t && label[b] != FREE) {
+                    fix(b), label[b] = FREE, tree[b] = -1;
+                    dissolved.push_back(b);
+                }
+            }
+            members[t].clear(), members[t].shrink_to_fit();
+        }
+        for (int b : dissolved) {
+            scan(b);
+        }
+    }
+
+    // expand the - blossom B, its dual is 0
+    void expand(int B) {
+        int t = tree[B], ein = tedge[B], xin = endpoint_in(ein, B);
+        auto ch = move(child[B]);
+        auto ln = move(link[B]);
+        child[B].clear(), link[B].clear();
+        label[B] = FREE, tree[B] = -1, spare.push_back(B);
+        for (int x : compressed[B]) {
+            if (up[x] == B) {
+                up[x] = parent[x], acc[x] = y[x];
+            }
+        }
+        compressed[B].clear(), compressed[B].shrink_to_fit();
+        for (int c : ch) {
+            parent[c] = -1, since[c] = now, label[c] = FREE, up[c] = c, acc[c] = 0;
+        }
+        // the even path from the entry child to the base child alternates - and +
+        int k = ch.size(), i = find(begin(ch), end(ch), top(xin)) - begin(ch);
+        int step = i % 2 == 1 ? 1 : -1;
+        set_label(ch[i], MINUS, t), tedge[ch[i]] = ein;
+        for (int j = i, s = 1; j % k != 0; s++) {
+            int f = step == 1 ? get<0>(ln[j]) : get<0>(ln[j - 1]);
+            j += step;
+            int c = ch[j % k];
+            if (s % 2 == 1) {
+                set_label(c, PLUS, t);
+            } else {
+                set_label(c, MINUS, t), tedge[c] = f;
+            }
+        }
+        for (int c : ch) {
+            if (label[c] != MINUS) {
+                scan(c);
+            }
+        }
+    }
+};
@@ -165,3 +165,51 @@ struct thread_pool {
     inline int pool_size() const noexcept { return threads.size(); }
     inline bool empty() const noexcept { return pending() == 0; }
 };
+
+/**
+ * A pool of T threads for the functions below, spawned only if T > 1: get() is nullptr
+ * otherwise, which they run inline.
+ */
+struct optional_thread_pool {
+    optional<thread_pool> pool;
+
+    explicit optional_thread_pool(int T) {
+        if (T > 1) {
+            pool.emplace(T);
+        }
+    }
+
+    thread_pool* get() { return pool ? &*pool : nullptr; }
+};
+
+/**
+ * Run fn(t) for t in [0,T) on the pool and wait for all of them. T=1 runs inline.
+ */
+template <typename Fn>
+void run_on_each_thread(thread_pool* pool, int T, const Fn& fn) {
+    if (T == 1) {
+        fn(0);
+    } else {
+        for (int t = 0; t < T; t++) {
+            pool->submit(fn, t);
+        }
+        pool->wait();
+    }
+}
+
+/**
+ * Run fn(t, i) for i in [0,n) on T threads of the pool, in blocks of grain indices handed
+ * out dynamically. Small ranges use fewer threads.
+ */
+template <typename Fn>
+void parallel_for(thread_pool* pool, int T, int n, int grain, const Fn& fn) {
+    T = min(T, 1 + n / (4 * grain));
+    atomic<int> cursor = 0;
+    run_on_each_thread(pool, T, [&](int t) {
+        for (int i = cursor.fetch_add(grain); i < n; i = cursor.fetch_add(grain)) {
+            for (int j = i, end = min(n, i + grain); j < end; j++) {
+                fn(t, j);
+            }
+        }
+    });
+}
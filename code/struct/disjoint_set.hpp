@@ -87,3 +87,69 @@ struct disjoint_set_rollback {
         return false;
     }
 };
+
+/**
+ * Union-find that can be shared by many threads, every operation is lock-free.
+ * Linking is by index (the root with the smaller index is linked under the other), so
+ * parent indices only ever increase and concurrent links can never form a cycle; find
+ * does path halving with relaxed CAS, losing a compaction race is harmless.
+ * Randomly relabel the nodes beforehand if the index order is adversarial.
+ * Reference: Jayanti, Tarjan, "A randomized concurrent algorithm for disjoint set union"
+ */
+struct concurrent_disjoint_set {
+    int N;
+    atomic<int> S;
+    vector<atomic<int>> next;
+
+    explicit concurrent_disjoint_set(int N = 0) : N(N), S(N), next(N) {
+        for (int i = 0; i < N; i++) {
+            next[i].store(i, memory_order_relaxed);
+        }
+    }
+
+    bool unit(int i) const { return next[i].load(memory_order_relaxed) == i; }
+    int count() const { return S.load(memory_order_relaxed); }
+
+    int find(int i) {
+        while (true) {
+            int p = next[i].load(memory_order_relaxed);
+            if (p == i) {
+                return i;
+            }
+            int g = next[p].load(memory_order_relaxed);
+            if (p != g) {
+                next[i].compare_exchange_weak(p, g, memory_order_relaxed);
+            }
+            i = g;
+        }
+    }
+
+    bool same(int i, int j) {
+        while (true) {
+            i = find(i), j = find(j);
+            if (i == j) {
+                return true;
+            }
+            if (next[i].load(memory_order_acquire) == i) {
+                return false;
+            }
+        }
+    }
+
+    bool join(int i, int j) {
+        while (true) {
+            i = find(i), j = find(j);
+            if (i == j) {
+                return false;
+            }
+            if (i < j) {
+                swap(i, j);
+            }
+            int root = j;
+            if (next[j].compare_exchange_strong(root, i, memory_order_acq_rel)) {
+                S.fetch_sub(1, memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+};
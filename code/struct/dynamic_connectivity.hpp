@@ -1,170 +1,356 @@
 #pragma once
 
-#include "euler_tour_tree.hpp"
+#include <bits/stdc++.h>
+using namespace std;
 
+/**
+ * Fully dynamic connectivity (Holm, de Lichtenberg, Thorup), vertices in [0,N]
+ * Every edge has a level, tree edges of level >= i form a spanning forest F_i of the
+ * edges of level >= i, kept as euler tour trees. A cut tree edge is replaced by searching
+ * the smaller side at each level from the edge's level down, pushing its edges one level
+ * up as they are scanned.
+ *
+ * Storage: edges live in an arena (pooled ids, reused after a cut) and sit in intrusive
+ * doubly linked lists, one per (level, tree/non-tree, endpoint). The euler tours are
+ * treaps with parent pointers over flat node arrays (vertex nodes then pairs of arc
+ * nodes), the treap priority is a hash of the node index. A node aggregates its tour's
+ * vertex count and whether some vertex in it has tree/non-tree edges of that level.
+ * The only hash lookup is from the endpoints to the edge id, in link/cut, in a flat
+ * linear probing table with backward shift deletion (no tombstones under churn).
+ *
+ * Complexity: O(log^2 N) amortized per link/cut, O(log N) expected per conn
+ */
 struct dynamic_connectivity {
-    struct dynconn_node {
-        int subt_size = 0;  // how many nodes in subtree
-        int adj[2] = {};    // how many adjacent to this node outside MST/inside MST
-        int insubt[2] = {}; // how many adjacent to all nodes inside this subtree
+    // euler tour forest of one level, null node 0, vertex u is node u+1
+    struct euler_forest {
+        struct node {
+            int parent = 0, kid[2] = {}, size = 0;
+            uint8_t flag = 0, agg = 0;
+        };
+        int B; // first arc node, even
+        vector<node> t;
+        vector<int> free_arcs, arc; // arc[e]: arc node of tree edge e at this level
+        vector<int> head[2];        // intrusive list head of edge handles per vertex
 
-        int tree_size() const { return subt_size; }
-        int sum(int tree) const { return insubt[tree]; }
+        explicit euler_forest(int N)
+            : B((N + 3) & ~1), t(B + 2 * N), head{vector<int>(N + 1, -1),
+                                                   vector<int>(N + 1, -1)} {
+            for (int x = 1; x <= N + 1; x++) {
+                t[x].size = 1;
+            }
+            for (int a = B + 2 * N - 2; a >= B; a -= 2) {
+                free_arcs.push_back(a);
+            }
+        }
+
+        static uint32_t prio(uint32_t x) {
+            x ^= x >> 16, x *= 0x85ebca6b, x ^= x >> 13, x *= 0xc2b2ae35;
+            return x ^ (x >> 16);
+        }
+        void pull(int x) {
+            auto& n = t[x];
+            n.size = (x < B) + t[n.kid[0]].size + t[n.kid[1]].size;
+            n.agg = n.flag | t[n.kid[0]].agg | t[n.kid[1]].agg;
+        }
+        void adopt(int p, int side, int c) {
+            t[p].kid[side] = c;
+            if (c) {
+                t[c].parent = p;
+            }
+        }
+        int root(int x) const {
+            while (t[x].parent) {
+                x = t[x].parent;
+            }
+            return x;
+        }
+        int merge(int a, int b) {
+            if (!a || !b) {
+                return a | b;
+            }
+            if (prio(a) > prio(b)) {
+                adopt(a, 1, merge(t[a].kid[1], b)), pull(a);
+                return a;
+            } else {
+                adopt(b, 0, merge(a, t[b].kid[0])), pull(b);
+                return b;
+            }
+        }
+        int merge(int a, int b, int c) { return merge(merge(a, b), c); }
+        // split the tour of x before x (x starts the right part) or after x
+        array<int, 2> split(int x, bool before) {
+            int side = before ? 0 : 1, p = t[x].parent;
+            array<int, 2> part;
+            part[side] = t[x].kid[side], part[!side] = x;
+            t[x].kid[side] = 0, pull(x);
+            for (int c = x; p; c = p, p = t[p].parent) {
+                int s = t[p].kid[1] == c; // p goes with the part on the other side of c
+                adopt(p, s, part[!s]), pull(p), part[!s] = p;
+            }
+            for (int r : part) {
+                t[r].parent = 0;
+            }
+            return part;
+        }
+        int reroot(int x) {
+            auto [l, r] = split(x, true);
+            return merge(r, l);
+        }
+
+        bool conn(int u, int v) const { return root(u + 1) == root(v + 1); }
+        int tree_size(int u) const { return t[root(u + 1)].size; }
 
-        void pushdown(bool, bool, dynconn_node&, dynconn_node&) {}
-        void pushup(bool is_node, bool, dynconn_node& lhs, dynconn_node& rhs) {
-            subt_size = is_node + lhs.subt_size + rhs.subt_size;
-            insubt[0] = adj[0] + lhs.insubt[0] + rhs.insubt[0];
-            insubt[1] = adj[1] + lhs.insubt[1] + rhs.insubt[1];
+        void link(int u, int v, int e) {
+            int a = free_arcs.back();
+            free_arcs.pop_back();
+            if (int(arc.size()) <= e) {
+                arc.resize(2 * e + 2);
+            }
+            arc[e] = a, t[a] = t[a + 1] = node();
+            merge(reroot(u + 1), a, merge(reroot(v + 1), a + 1));
+        }
+        // rotate the tour to a ..Y.. b ..Z.., then Y and Z are the two trees
+        void cut(int e) {
+            int a = arc[e], b = a ^ 1;
+            auto [x, y] = split(a, true);
+            merge(y, x);
+            split(b, true);
+            split(a, false), split(b, false);
+            free_arcs.push_back(a & ~1);
+        }
+
+        // flag bit of vertex u, updates the aggregates up to the root
+        void set_flag(int u, uint8_t bit, bool on) {
+            int x = u + 1;
+            t[x].flag = on ? t[x].flag | bit : t[x].flag & ~bit;
+            for (uint8_t old; x; x = t[x].parent) {
+                old = t[x].agg, pull(x);
+                if (old == t[x].agg && x != u + 1) {
+                    break;
+                }
+            }
+        }
+        // some vertex with the flag bit in the tour of u, or -1
+        int find_flag(int u, uint8_t bit) const {
+            int x = root(u + 1);
+            if (!(t[x].agg & bit)) {
+                return -1;
+            }
+            while (!(t[x].flag & bit)) {
+                auto [l, r] = t[x].kid;
+                x = t[l].agg & bit ? l : r;
+            }
+            return x - 1;
         }
     };
-    int N;
-    vector<euler_tour_tree<dynconn_node>> ett;
-    unordered_map<pair<int, int>, int> edge_level;
-    unordered_map<pair<int, int>, unordered_set<int>> adj[2];
 
-    void ensure_level(int level) {
-        if (int(ett.size()) == level) {
-            ett.emplace_back(ett[0].t.size() - 1);
+    // unordered pair of vertices -> edge id
+    struct edge_table {
+        static constexpr uint64_t EMPTY = ~0ULL;
+        struct slot {
+            uint64_t key = EMPTY;
+            int id = -1;
+        };
+        vector<slot> slots = vector<slot>(16);
+        int S = 0, shift = 60;
+
+        static uint64_t key(int u, int v) {
+            auto [a, b] = minmax(u, v);
+            return uint64_t(a) << 32 | uint32_t(b);
+        }
+        int home(uint64_t k) const { return k * 0x9e3779b97f4a7c15 >> shift; }
+        int next(int i) const { return (i + 1) & (slots.size() - 1); }
+        int locate(uint64_t k) const {
+            int i = home(k);
+            while (slots[i].key != k && slots[i].key != EMPTY) {
+                i = next(i);
+            }
+            return i;
         }
-    }
 
-    explicit dynamic_connectivity(int N = 0)
-        : N(N), ett(1, euler_tour_tree<dynconn_node>(N)) {
-        edge_level.reserve(4 * N);
-    }
+        void reserve(int n) {
+            if (2 * n <= int(slots.size())) {
+                return;
+            }
+            auto old = move(slots);
+            while (2 * n > (1 << (64 - shift))) {
+                shift--;
+            }
+            slots.assign(1 << (64 - shift), slot());
+            for (auto [k, id] : old) {
+                if (k != EMPTY) {
+                    slots[locate(k)] = {k, id};
+                }
+            }
+        }
+        int find(int u, int v) const { return slots[locate(key(u, v))].id; }
+        void insert(int u, int v, int id) {
+            reserve(S + 1), S++;
+            slots[locate(key(u, v))] = {key(u, v), id};
+        }
+        void erase(int u, int v) {
+            int i = locate(key(u, v)), mask = slots.size() - 1;
+            for (int j = next(i); slots[j].key != EMPTY; j = next(j)) {
+                // move j back to i unless its home lies cyclically in (i,j]
+                if (((j - home(slots[j].key)) & mask) >= ((j - i) & mask)) {
+                    slots[i] = slots[j], i = j;
+                }
+            }
+            slots[i] = slot(), S--;
+        }
+    };
+
+    struct edge {
+        int end[2], level;
+        bool tree;
+        int next[2], prev[2]; // list links of the edge handles 2e and 2e+1
+    };
+
+    enum op_type : uint8_t { LINK, CUT, CONN };
+    struct op {
+        op_type type;
+        int u, v;
+    };
+
+    int N;
+    vector<euler_forest> level;
+    vector<edge> edges;
+    vector<int> free_edges;
+    edge_table edge_id;
+
+    explicit dynamic_connectivity(int N = 0) : N(N), level(1, euler_forest(N)) {}
 
     int num_nodes() const { return N; }
+    int num_edges() const { return edges.size() - free_edges.size(); }
 
-  public:
     // returns true if linking joined two unconnected components
     bool link(int u, int v) {
-        if (u == v)
+        if (u == v || edge_id.find(u, v) != -1) {
             return false;
-        if (ett[0].link(u, v)) {
-            add_edge_level<1>(u, v, 0);
-            return true;
+        }
+        int e;
+        if (free_edges.empty()) {
+            e = edges.size(), edges.emplace_back();
         } else {
-            add_edge_level<0>(u, v, 0);
-            return false;
+            e = free_edges.back(), free_edges.pop_back();
+        }
+        edge_id.insert(u, v, e);
+        bool tree = !level[0].conn(u, v);
+        edges[e] = {{u, v}, 0, tree, {-1, -1}, {-1, -1}};
+        if (tree) {
+            level[0].link(u, v, e);
         }
+        attach(e);
+        return tree;
     }
 
     // returns true if cutting separated a connected component into two
     bool cut(int u, int v) {
-        if (u == v)
+        int e = u == v ? -1 : edge_id.find(u, v);
+        if (e == -1) {
             return false;
-        int level = get_edge_level(u, v);
-        if (level == -1)
-            return false;
-        if (!ett[0].cut(u, v)) {
-            rem_edge_level<0>(u, v, level);
+        }
+        edge_id.erase(u, v);
+        detach(e), free_edges.push_back(e);
+        if (!edges[e].tree) {
             return false;
         }
-
-        for (int i = level; i > 0; i--) {
-            bool cut = ett[i].cut(u, v);
-            assert(cut);
+        for (int i = edges[e].level; i >= 0; i--) {
+            level[i].cut(e);
         }
-        rem_edge_level<1>(u, v, level);
-
-        for (int i = level; i >= 0; i--) {
-            int u_size = ett[i].access_node(u)->tree_size();
-            int v_size = ett[i].access_node(v)->tree_size();
-            if (u_size > v_size)
-                swap(u, v), swap(u_size, v_size);
 
-            // push tree edges down to level i+1
-            while (true) {
-                int a = find_with_bridge<1>(u, i);
-                if (a == 0)
-                    break;
-                const auto& edges = adj[1].at({i, a});
-                int S = edges.size();
-                while (S--) {
-                    int b = *edges.begin();
-                    rem_edge_level<1>(a, b, i);
-                    add_edge_level<1>(a, b, i + 1);
-                    ett[i + 1].link(a, b);
+        for (int i = edges[e].level; i >= 0; i--) {
+            ensure_level(i + 1);
+            if (level[i].tree_size(u) > level[i].tree_size(v)) {
+                swap(u, v);
+            }
+            // push the tree edges of the smaller side up
+            for (int a; (a = level[i].find_flag(u, TREE_BIT)) != -1;) {
+                for (int h; (h = level[i].head[1][a]) != -1;) {
+                    int f = h >> 1;
+                    detach(f), edges[f].level++, attach(f);
+                    level[i + 1].link(edges[f].end[0], edges[f].end[1], f);
                 }
             }
-
-            while (true) {
-                int a = find_with_bridge<0>(u, i);
-                if (a == 0)
-                    break;
-                const auto& edges = adj[0].at({i, a});
-                int S = edges.size();
-                while (S--) {
-                    int b = *edges.begin();
-                    if (ett[i].conn(b, v)) {
+            // scan its non-tree edges for a replacement, pushing them up otherwise
+            for (int a; (a = level[i].find_flag(u, EDGE_BIT)) != -1;) {
+                for (int h; (h = level[i].head[0][a]) != -1;) {
+                    int f = h >> 1, b = edges[f].end[!(h & 1)];
+                    detach(f);
+                    if (level[i].conn(b, v)) {
+                        edges[f].tree = true, attach(f);
                         for (int j = 0; j <= i; j++) {
-                            ett[j].link(a, b);
+                            level[j].link(a, b, f);
                         }
-                        rem_edge_level<0>(a, b, i);
-                        add_edge_level<1>(a, b, i);
                         return false;
-                    } else {
-                        rem_edge_level<0>(a, b, i);
-                        add_edge_level<0>(a, b, i + 1);
                     }
+                    edges[f].level++, attach(f);
                 }
             }
         }
-
         return true;
     }
 
-    void reroot(int u) { ett[0].reroot(u); }
+    bool conn(int u, int v) const { return u == v || level[0].conn(u, v); }
 
-    int findroot(int u) { return ett[0].findroot(u); }
-
-    bool conn(int u, int v) { return ett[0].conn(u, v); }
-
-  private:
-    int next_two(int n) const { return n > 1 ? 8 * sizeof(n) - __builtin_clz(n - 1) : 0; }
-
-    int get_level(int u, int v) const {
-        auto it = edge_level.find(minmax(u, v));
-        return it == edge_level.end() ? -1 : it->second;
-    }
+    int component_size(int u) const { return level[0].tree_size(u); }
 
-    template <bool tree>
-    int find_with_bridge(int u, int level) {
-        if (ett[level].access_node(u)->sum(tree) == 0) {
-            return 0;
+    /**
+     * Apply a stream of operations in order, returns the result of each: whether the
+     * link joined or the cut separated components, or whether the pair is connected.
+     * The edge arena and table are sized once for all the links of the stream.
+     */
+    auto update(const vector<op>& ops) {
+        int links = 0;
+        for (const auto& [type, u, v] : ops) {
+            links += type == LINK;
         }
-        const auto& t = ett[level].t;
-        while (t[u].node.adj[tree] == 0) {
-            auto [l, r] = t[u].child;
-            u = t[l].node.sum(tree) > 0 ? l : r;
+        edges.reserve(num_edges() + links), edge_id.reserve(num_edges() + links);
+        vector<char> result(ops.size());
+        for (int i = 0, S = ops.size(); i < S; i++) {
+            auto [type, u, v] = ops[i];
+            result[i] = type == LINK ? link(u, v) : type == CUT ? cut(u, v) : conn(u, v);
         }
-        ett[level].access_node(u);
-        return u;
+        return result;
     }
 
-    template <bool tree>
-    void add_edge_level(int u, int v, int level) {
-        ensure_level(level);
-        edge_level.emplace(minmax(u, v), level);
-        adj[tree][{level, u}].insert(v);
-        adj[tree][{level, v}].insert(u);
-        ett[level].access_node(u)->adj[tree]++;
-        ett[level].access_node(v)->adj[tree]++;
-    }
+  private:
+    static constexpr uint8_t EDGE_BIT = 1, TREE_BIT = 2; // non-tree, tree
 
-    template <bool tree>
-    void rem_edge_level(int u, int v, int level) {
-        edge_level.erase(minmax(u, v));
-        auto su = adj[tree].find({level, u}), sv = adj[tree].find({level, v});
-        su->second.size() == 1u ? adj[tree].erase(su), 0 : su->second.erase(v);
-        sv->second.size() == 1u ? adj[tree].erase(sv), 0 : sv->second.erase(u);
-        ett[level].access_node(u)->adj[tree]--;
-        ett[level].access_node(v)->adj[tree]--;
+    void ensure_level(int i) {
+        if (int(level.size()) == i) {
+            level.emplace_back(N);
+        }
     }
 
-    int get_edge_level(int u, int v) {
-        auto it = edge_level.find(minmax(u, v));
-        return it == edge_level.end() ? -1 : it->second;
+    // insert/remove edge e in the lists of its endpoints at its level
+    void attach(int e) {
+        auto& E = edges[e];
+        auto& F = level[E.level];
+        for (int s = 0; s < 2; s++) {
+            int& head = F.head[E.tree][E.end[s]];
+            E.prev[s] = -1, E.next[s] = head;
+            if (head != -1) {
+                edges[head >> 1].prev[head & 1] = 2 * e + s;
+            } else {
+                F.set_flag(E.end[s], E.tree ? TREE_BIT : EDGE_BIT, true);
+            }
+            head = 2 * e + s;
+        }
+    }
+    void detach(int e) {
+        auto& E = edges[e];
+        auto& F = level[E.level];
+        for (int s = 0; s < 2; s++) {
+            int prev = E.prev[s], next = E.next[s];
+            if (next != -1) {
+                edges[next >> 1].prev[next & 1] = prev;
+            }
+            if (prev != -1) {
+                edges[prev >> 1].next[prev & 1] = next;
+            } else if ((F.head[E.tree][E.end[s]] = next) == -1) {
+                F.set_flag(E.end[s], E.tree ? TREE_BIT : EDGE_BIT, false);
+            }
+        }
     }
 };
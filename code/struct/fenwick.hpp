@@ -5,6 +5,8 @@ using namespace std;
 
 /**
  * 1-indexed fenwick tree
+ * Build from an array (arr[0] at position 1) in O(N); add_many applies a batch of
+ * updates, in O(N) with one linear pass if the batch is large, otherwise sorted by index.
  */
 template <typename T>
 struct fenwick {
@@ -13,6 +15,15 @@ struct fenwick {
 
     explicit fenwick(int N = 0) : N(N), tree(N + 1) {}
 
+    explicit fenwick(const vector<T>& arr) : N(arr.size()), tree(N + 1) {
+        copy(begin(arr), end(arr), begin(tree) + 1);
+        for (int i = 1; i <= N; i++) {
+            if (int j = i + (i & -i); j <= N) {
+                tree[j] += tree[i];
+            }
+        }
+    }
+
     T sum(int i) const {
         T sum = 0;
         while (i > 0) {
@@ -42,6 +53,66 @@ struct fenwick {
         }
         return i + 1;
     }
+
+    void add_many(vector<pair<int, T>> updates) {
+        int K = updates.size();
+        if (1L * K * (32 - __builtin_clz(N | 1)) >= N) {
+            vector<T> delta(N + 1);
+            for (auto [i, n] : updates) {
+                if (0 < i && i <= N) { // like add(), ignore positions past N
+                    delta[i] += n;
+                }
+            }
+            for (int i = 1; i <= N; i++) {
+                tree[i] += delta[i];
+                if (int j = i + (i & -i); j <= N) {
+                    delta[j] += delta[i];
+                }
+            }
+        } else {
+            sort(begin(updates), end(updates),
+                 [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (int k = 0, l = 0; k < K; k = l) {
+                T n = updates[k].second;
+                for (l = k + 1; l < K && updates[l].first == updates[k].first; l++) {
+                    n += updates[l].second;
+                }
+                add(updates[k].first, n);
+            }
+        }
+    }
+};
+
+/**
+ * 1-indexed fenwick tree with range add and range sum, on two fenwick trees:
+ * prefix sum(i) = sum_b(i) * i - sum_c(i)
+ */
+template <typename T>
+struct range_fenwick {
+    int N;
+    fenwick<T> b, c;
+
+    explicit range_fenwick(int N = 0) : N(N), b(N), c(N) {}
+
+    explicit range_fenwick(const vector<T>& arr) : N(arr.size()) {
+        vector<T> db(N), dc(N);
+        for (int i = 0; i < N; i++) {
+            T d = arr[i] - (i ? arr[i - 1] : T(0));
+            db[i] = d, dc[i] = d * T(i);
+        }
+        b = fenwick<T>(db), c = fenwick<T>(dc);
+    }
+
+    T sum(int i) const { return b.sum(i) * T(i) - c.sum(i); }
+    T sum(int l, int r) const { return sum(r) - sum(l - 1); }
+    T get(int i) const { return b.sum(i); }
+
+    void add(int l, int r, T n) { // add n to [l..r]
+        if (l <= r) {
+            b.add(l, n), b.add(r + 1, -n);
+            c.add(l, n * T(l - 1)), c.add(r + 1, -n * T(r));
+        }
+    }
 };
 
 template <typename T>
@@ -91,21 +162,26 @@ struct sparse_fenwick {
 
 /**
  * 1-indexed 2d fenwick tree
+ * One flat row-major array, each step of the outer loop computes its row base once.
+ * Tiled layouts (8x8 and 2x4 tiles) were measured slower on random add/sum mixes: the
+ * cells visited by one operation are spread apart in both dimensions, so tiles don't
+ * bring them into shared cache lines and only add index arithmetic and TLB pressure.
  */
 template <typename T>
 struct fenwick2d {
     int N, M;
-    vector<vector<T>> tree;
+    vector<T> tree;
 
     explicit fenwick2d(int N = 0, int M = 0)
-        : N(N), M(M), tree(N + 1, vector<int>(M + 1)) {}
+        : N(N), M(M), tree(1L * (N + 1) * (M + 1)) {}
 
     T sum(int i, int j) const {
         T sum = 0;
         while (i > 0) {
+            const T* row = tree.data() + 1L * i * (M + 1);
             int k = j;
             while (k > 0) {
-                sum += tree[i][k];
+                sum += row[k];
                 k -= k & -k;
             }
             i -= i & -i;
@@ -120,9 +196,10 @@ struct fenwick2d {
     void add(int i, int j, T n) {
         if (i > 0 && j > 0) {
             while (i <= N) {
+                T* row = tree.data() + 1L * i * (M + 1);
                 int k = j;
                 while (k <= M) {
-                    tree[i][k] += n;
+                    row[k] += n;
                     k += k & -k;
                 }
                 i += i & -i;
@@ -131,6 +208,87 @@ struct fenwick2d {
     }
 };
 
+/**
+ * Static 2d fenwick tree for a set of points known in advance (offline).
+ * Each node of the fenwick tree over the compressed rows keeps the sorted columns of
+ * the points under it and a fenwick tree over them, all in flat arrays.
+ * Only points given at construction can be updated, sums can be queried anywhere.
+ * Complexity: O(P log P) memory and construction, O(log^2 P) add and sum
+ */
+template <typename T>
+struct offline_fenwick2d {
+    int N;
+    vector<int> xs, off, ys;
+    vector<T> tree;
+
+    explicit offline_fenwick2d(vector<array<int, 2>> points) {
+        sort(begin(points), end(points));
+        points.erase(unique(begin(points), end(points)), end(points));
+        for (auto [x, y] : points) {
+            if (xs.empty() || xs.back() != x) {
+                xs.push_back(x);
+            }
+        }
+        N = xs.size();
+        off.assign(N + 2, 0);
+        for (auto [x, y] : points) {
+            for (int a = row(x); a <= N; a += a & -a) {
+                off[a + 1]++;
+            }
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        ys.resize(off[N + 1]), tree.resize(off[N + 1]);
+        auto cur = off;
+        for (auto [x, y] : points) {
+            for (int a = row(x); a <= N; a += a & -a) {
+                ys[cur[a]++] = y;
+            }
+        }
+        for (int a = 1; a <= N; a++) {
+            sort(begin(ys) + off[a], begin(ys) + off[a + 1]);
+        }
+    }
+
+    T sum(int i, int j) const {
+        T sum = 0;
+        for (int a = upper_bound(begin(xs), end(xs), i) - begin(xs); a > 0; a -= a & -a) {
+            int L = off[a], S = off[a + 1] - L;
+            int k = upper_bound(begin(ys) + L, begin(ys) + L + S, j) - begin(ys) - L;
+            while (k > 0) {
+                sum += tree[L + k - 1];
+                k -= k & -k;
+            }
+        }
+        return sum;
+    }
+
+    T rectangle(int i0, int j0, int i1, int j1) const {
+        return sum(i1, j1) - sum(i0, j1) - sum(i1, j0) + sum(i0, j0);
+    }
+
+    void add(int i, int j, T n) {
+        for (int a = row(i); a <= N; a += a & -a) {
+            int L = off[a], S = off[a + 1] - L;
+            int k = lower_bound(begin(ys) + L, begin(ys) + L + S, j) - begin(ys) - L + 1;
+            assert(k <= S && ys[L + k - 1] == j);
+            while (k <= S) {
+                tree[L + k - 1] += n;
+                k += k & -k;
+            }
+        }
+    }
+
+  private:
+    int row(int x) const {
+        int a = lower_bound(begin(xs), end(xs), x) - begin(xs) + 1;
+        assert(a <= N && xs[a - 1] == x);
+        return a;
+    }
+};
+
+/**
+ * Hashmap 2d fenwick tree, for points not known in advance. Prefer offline_fenwick2d.
+ */
 template <typename T>
 struct sparse_fenwick2d {
     int N, M;
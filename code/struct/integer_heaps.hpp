@@ -104,6 +104,343 @@ struct binary_int_heap {
     }
 };
 
+template <typename Container>
+using binary_min_int_heap = binary_int_heap<less_container<Container>>;
+
+/**
+ * D-ary heap over the integers [0...N) with decrease-key, same interface as
+ * binary_int_heap. The heap array is shifted by D-1 slots so that the D children of a
+ * node are contiguous and start on a multiple of D, e.g. one 32-byte block for D=8.
+ * Shallower than the binary heap, pops compare D children per level instead of 2.
+ *
+ * Operation complexities (n is the size of the heap, u is a value)
+ *           O(N)            construction
+ *           O(1)            top()
+ *           O(1)            contains(u)
+ *           O(log_D n)      push(u)
+ *           O(log_D n)-     decrease_key(u)
+ *           O(D log_D n)    pop()
+ *           O(n)            clear()
+ */
+template <int D, typename Compare = less<>>
+struct dary_int_heap {
+    static_assert(D >= 2);
+    vector<int> c, id;
+    Compare comp;
+
+    explicit dary_int_heap(int N = 0, const Compare& comp = Compare())
+        : c(D - 1, -1), id(N, -1), comp(comp) {}
+
+    bool empty() const { return c.size() == D - 1; }
+    size_t size() const { return c.size() - (D - 1); }
+    bool contains(int u) const { return id[u] != -1; }
+    int top() const {
+        assert(!empty());
+        return c[D - 1];
+    }
+    void push(int u) {
+        assert(!contains(u));
+        id[u] = size(), c.push_back(u);
+        heapify_up(id[u]);
+    }
+    int pop() {
+        assert(!empty());
+        int u = c[D - 1];
+        c[D - 1] = c.back();
+        id[c[D - 1]] = 0, id[u] = -1;
+        c.pop_back();
+        heapify_down(0);
+        return u;
+    }
+    void improve(int u) { assert(contains(u)), heapify_up(id[u]); }
+    void decline(int u) { assert(contains(u)), heapify_down(id[u]); }
+    void push_or_improve(int u) { contains(u) ? improve(u) : push(u); }
+    void push_or_decline(int u) { contains(u) ? decline(u) : push(u); }
+    void clear() {
+        for (int i = D - 1, S = c.size(); i < S; i++)
+            id[c[i]] = -1;
+        c.resize(D - 1);
+    }
+    void fill() {
+        for (int u = 0, N = id.size(); u < N; u++) {
+            if (!contains(u)) {
+                push(u);
+            }
+        }
+    }
+
+  private:
+    static int parent(int i) { return (i - 1) / D; }
+    static int child(int i) { return D * i + 1; }
+    int& at(int i) { return c[i + D - 1]; }
+    void exchange(int i, int j) { swap(id[at(i)], id[at(j)]), swap(at(i), at(j)); }
+    void heapify_up(int i) {
+        while (i > 0 && comp(at(i), at(parent(i)))) { // while c[i] < c[parent(i)]
+            exchange(i, parent(i)), i = parent(i);
+        }
+    }
+    void heapify_down(int i) {
+        int k, S = size();
+        while ((k = child(i)) < S) {
+            int m = k;
+            for (int j = k + 1, e = min(k + D, S); j < e; j++)
+                if (comp(at(j), at(m)))
+                    m = j;
+            if (!comp(at(m), at(i))) // break if c[i] <= c[minchild(i)]
+                break;
+            exchange(i, m), i = m;
+        }
+    }
+};
+
+/**
+ * Monotone radix heap over the integers [0...N), keyed by an external container of
+ * non-negative integer keys (e.g. dijkstra's dist), with decrease-key.
+ * Monotone: keys pushed or improved must be >= the key of the last top() or pop(). Once
+ * the heap is cleared or runs empty any keys are allowed again: they wait in the last
+ * bucket, and the next top() anchors the bound at their minimum.
+ * Drop-in replacement for binary_min_int_heap whenever the keys are integers.
+ *
+ * Bucket b>0 holds the elements whose key first differs from the last popped key at bit
+ * b-1, bucket 0 those with key equal to it. Each element descends at most once per bit.
+ *
+ * Operation complexities (n is the size of the heap, u is a value, B is the key width)
+ *           O(N + B)        construction
+ *           O(1)            contains(u)
+ *           O(1)            push(u)
+ *           O(1)            decrease_key(u)
+ *           O(B)*           pop()
+ *           O(n + B)        clear()
+ */
+template <typename Container>
+struct radix_int_heap {
+    using key_t = remove_cv_t<remove_reference_t<decltype(declval<Container>()[0])>>;
+    static_assert(is_integral_v<key_t>);
+    static constexpr int B = 8 * sizeof(key_t) + 1;
+
+    const Container* key = nullptr;
+    vector<int> next, prev, id;
+    array<int, B> head;
+    key_t last = 0;
+    int S = 0;
+    bool anchored = false; // last bounds the keys, false while the heap was emptied
+
+    explicit radix_int_heap(int N = 0, const Container& key = Container())
+        : key(&key), next(N), prev(N), id(N, -1) {
+        head.fill(-1);
+    }
+
+    bool empty() const { return S == 0; }
+    size_t size() const { return S; }
+    bool contains(int u) const { return id[u] != -1; }
+    int top() {
+        assert(!empty());
+        if (head[0] == -1) {
+            pull();
+        }
+        return head[0];
+    }
+    void push(int u) {
+        assert(!contains(u));
+        insert(u, anchored ? bucket(u) : B - 1), S++;
+    }
+    int pop() {
+        int u = top();
+        erase(u), S--;
+        anchored = S > 0;
+        return u;
+    }
+    void improve(int u) {
+        assert(contains(u));
+        if (int b = anchored ? bucket(u) : B - 1; b != id[u]) {
+            erase(u), insert(u, b);
+        }
+    }
+    void push_or_improve(int u) { contains(u) ? improve(u) : push(u); }
+    void clear() {
+        for (int b = 0; b < B; b++) {
+            for (int u = head[b], v; u != -1; u = v) {
+                v = next[u], id[u] = -1;
+            }
+            head[b] = -1;
+        }
+        S = 0, anchored = false;
+    }
+    void fill() {
+        for (int u = 0, N = id.size(); u < N; u++) {
+            if (!contains(u)) {
+                push(u);
+            }
+        }
+    }
+
+  private:
+    int bucket(int u) const {
+        key_t k = (*key)[u];
+        assert(k >= last);
+        auto diff = uint64_t(k) ^ uint64_t(last);
+        return diff ? 64 - __builtin_clzll(diff) : 0;
+    }
+    void insert(int u, int b) {
+        id[u] = b, prev[u] = -1, next[u] = head[b];
+        if (head[b] != -1) {
+            prev[head[b]] = u;
+        }
+        head[b] = u;
+    }
+    void erase(int u) {
+        if (prev[u] != -1) {
+            next[prev[u]] = next[u];
+        } else {
+            head[id[u]] = next[u];
+        }
+        if (next[u] != -1) {
+            prev[next[u]] = prev[u];
+        }
+        id[u] = -1;
+    }
+    void pull() {
+        int b = 1;
+        while (head[b] == -1) {
+            b++;
+        }
+        last = (*key)[head[b]], anchored = true;
+        for (int u = next[head[b]]; u != -1; u = next[u]) {
+            last = min(last, (*key)[u]);
+        }
+        int u = head[b];
+        head[b] = -1;
+        while (u != -1) {
+            int v = next[u];
+            insert(u, bucket(u)), u = v;
+        }
+    }
+};
+
+/**
+ * Dial's bucket queue over the integers [0...N), keyed by an external container of
+ * non-negative integer keys, with decrease-key. Same monotone contract as radix_int_heap.
+ * The buckets form a ring indexed by key modulo its size, which doubles whenever a key
+ * lands further than the ring size from the last popped key (from the smallest key while
+ * the heap is not anchored), so it works best when the keys in the heap span a small
+ * range C (dijkstra with small integer weights).
+ *
+ * Operation complexities (n is the size of the heap, u is a value)
+ *           O(N)            construction
+ *           O(1)            contains(u)
+ *           O(1)*           push(u)
+ *           O(1)            decrease_key(u)
+ *           O(1)*           pop()       amortized over the keys skipped
+ *           O(n + C)        clear()
+ */
+template <typename Container>
+struct bucket_int_heap {
+    using key_t = remove_cv_t<remove_reference_t<decltype(declval<Container>()[0])>>;
+    static_assert(is_integral_v<key_t>);
+
+    const Container* key = nullptr;
+    vector<int> next, prev, id, head;
+    key_t last = 0, lo = 0, hi = 0; // [lo,hi] spans the keys while not anchored
+    int S = 0;
+    bool anchored = false;
+
+    explicit bucket_int_heap(int N = 0, const Container& key = Container(), int C = 64)
+        : key(&key), next(N), prev(N), id(N, -1), head(1 << ring_bits(C), -1) {}
+
+    bool empty() const { return S == 0; }
+    size_t size() const { return S; }
+    bool contains(int u) const { return id[u] != -1; }
+    int top() {
+        assert(!empty());
+        if (!anchored) {
+            last = lo, anchored = true;
+        }
+        int mask = head.size() - 1;
+        while (head[last & mask] == -1) {
+            last++;
+        }
+        return head[last & mask];
+    }
+    void push(int u) {
+        assert(!contains(u));
+        reserve((*key)[u], S == 0);
+        insert(u, (*key)[u] & (head.size() - 1)), S++;
+    }
+    int pop() {
+        int u = top();
+        erase(u), S--;
+        anchored = S > 0;
+        return u;
+    }
+    void improve(int u) {
+        assert(contains(u));
+        reserve((*key)[u], false);
+        int b = (*key)[u] & (head.size() - 1);
+        if (b != id[u]) {
+            erase(u), insert(u, b);
+        }
+    }
+    void push_or_improve(int u) { contains(u) ? improve(u) : push(u); }
+    void clear() {
+        for (int& h : head) {
+            for (int u = h, v; u != -1; u = v) {
+                v = next[u], id[u] = -1;
+            }
+            h = -1;
+        }
+        S = 0, anchored = false;
+    }
+    void fill() {
+        for (int u = 0, N = id.size(); u < N; u++) {
+            if (!contains(u)) {
+                push(u);
+            }
+        }
+    }
+
+  private:
+    static int ring_bits(int64_t span) {
+        return span <= 1 ? 0 : 64 - __builtin_clzll(span - 1);
+    }
+    // grow the ring to hold key k, first says k is the only key of an unanchored heap
+    void reserve(key_t k, bool first) {
+        if (!anchored) {
+            lo = first ? k : min(lo, k), hi = first ? k : max(hi, k);
+        }
+        assert(!anchored || k >= last);
+        key_t span = anchored ? k - last : hi - lo;
+        if (span < key_t(head.size())) {
+            return;
+        }
+        vector<int> old(1 << ring_bits(span + 1), -1);
+        swap(head, old);
+        int mask = head.size() - 1;
+        for (int h : old) {
+            for (int u = h, v; u != -1; u = v) {
+                v = next[u], insert(u, (*key)[u] & mask);
+            }
+        }
+    }
+    void insert(int u, int b) {
+        id[u] = b, prev[u] = -1, next[u] = head[b];
+        if (head[b] != -1) {
+            prev[head[b]] = u;
+        }
+        head[b] = u;
+    }
+    void erase(int u) {
+        if (prev[u] != -1) {
+            next[prev[u]] = next[u];
+        } else {
+            head[id[u]] = next[u];
+        }
+        if (next[u] != -1) {
+            prev[next[u]] = prev[u];
+        }
+        id[u] = -1;
+    }
+};
+
 /**
  * Pairing heap over the unique integers [0...N)
  * By default a min-heap, but you'll usually need a custom compare.
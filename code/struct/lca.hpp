@@ -1,7 +1,27 @@
 #pragma once
 
 #include "disjoint_set.hpp"
-#include "y_combinator.hpp"
+#include "../parallel/thread_pool.hpp"
+
+/**
+ * Split Q batched queries into contiguous chunks and answer each chunk fn(l,r) on a pool
+ * of nthreads threads. Chunks smaller than a few thousand queries are not worth a thread.
+ */
+template <typename Fn>
+void lca_batch_split(int Q, int nthreads, const Fn& fn) {
+    static constexpr int MIN_CHUNK = 4096;
+    nthreads = max(1, min(nthreads, Q / MIN_CHUNK));
+    if (nthreads == 1) {
+        fn(0, Q);
+        return;
+    }
+    thread_pool pool(nthreads);
+    for (int i = 0; i < nthreads; i++) {
+        int l = 1L * Q * i / nthreads, r = 1L * Q * (i + 1) / nthreads;
+        pool.submit(fn, l, r);
+    }
+    pool.finish();
+}
 
 /**
  * LCA on a tree, 0/1-indexed, binary lifting
@@ -64,6 +84,47 @@ struct lca_binary {
     }
 
     int dist(int u, int v) const { return depth[u] + depth[v] - 2 * depth[lca(u, v)]; }
+
+    /**
+     * Answer many queries at once. Queries are processed in blocks of BATCH in lockstep,
+     * one lifting level at a time, so that the loads of the whole block are in flight
+     * together instead of one dependent chain per query.
+     */
+    auto lca_all(const vector<array<int, 2>>& queries, int nthreads = 1) const {
+        static constexpr int BATCH = 64;
+        int Q = queries.size();
+        vector<int> ans(Q);
+
+        lca_batch_split(Q, nthreads, [&](int l, int r) {
+            int us[BATCH], vs[BATCH], diff[BATCH];
+            for (int s = l; s < r; s += BATCH) {
+                int n = min(BATCH, r - s);
+                for (int k = 0; k < n; k++) {
+                    auto [u, v] = queries[s + k];
+                    if (depth[u] < depth[v])
+                        swap(u, v);
+                    us[k] = u, vs[k] = v, diff[k] = depth[u] - depth[v];
+                }
+                for (int b = B - 1; b >= 0; b--) {
+                    for (int k = 0; k < n; k++) {
+                        us[k] = (diff[k] >> b & 1) ? up[b][us[k]] : us[k];
+                    }
+                }
+                for (int b = B - 1; b >= 0; b--) {
+                    for (int k = 0; k < n; k++) {
+                        int a = up[b][us[k]], c = up[b][vs[k]];
+                        bool jump = a != c;
+                        us[k] = jump ? a : us[k], vs[k] = jump ? c : vs[k];
+                    }
+                }
+                for (int k = 0; k < n; k++) {
+                    ans[s + k] = us[k] == vs[k] ? us[k] : up[0][us[k]];
+                }
+            }
+        });
+
+        return ans;
+    }
 };
 
 /**
@@ -125,6 +186,40 @@ struct lca_rmq {
     }
 
     int dist(int u, int v) const { return depth[u] + depth[v] - 2 * depth[lca(u, v)]; }
+
+    /**
+     * Answer many queries at once, in blocks of BATCH queries per stage (gather first,
+     * then sparse table, then depth) so each stage is a run of independent loads.
+     */
+    auto lca_all(const vector<array<int, 2>>& queries, int nthreads = 1) const {
+        static constexpr int BITS = CHAR_BIT * sizeof(int) - 1;
+        static constexpr int BATCH = 64;
+        int Q = queries.size();
+        vector<int> ans(Q);
+
+        lca_batch_split(Q, nthreads, [&](int l, int r) {
+            int as[BATCH], bs[BATCH], ls[BATCH], rs[BATCH];
+            for (int s = l; s < r; s += BATCH) {
+                int n = min(BATCH, r - s);
+                for (int k = 0; k < n; k++) {
+                    auto [u, v] = queries[s + k];
+                    auto [a, b] = minmax(first[u], first[v]);
+                    as[k] = a, bs[k] = b;
+                }
+                for (int k = 0; k < n; k++) {
+                    int bits = as[k] == bs[k] ? 0 : BITS - __builtin_clz(bs[k] - as[k]);
+                    int len = as[k] == bs[k] ? 0 : 1 << bits;
+                    ls[k] = jmp[bits][as[k]];
+                    rs[k] = jmp[bits][bs[k] - len];
+                }
+                for (int k = 0; k < n; k++) {
+                    ans[s + k] = depth[ls[k]] < depth[rs[k]] ? ls[k] : rs[k];
+                }
+            }
+        });
+
+        return ans;
+    }
 };
 
 /**
@@ -188,49 +283,104 @@ struct lca_schieber_vishkin {
     }
 
     int dist(int u, int v) const { return depth[u] + depth[v] - 2 * depth[lca(u, v)]; }
+
+    /**
+     * Answer many queries at once. Each block of BATCH queries goes through the same
+     * stages as lca() but with the branches replaced by selects, so the bit arithmetic
+     * between the gathers is straight-line code over small arrays that vectorizes.
+     */
+    auto lca_all(const vector<array<int, 2>>& queries, int nthreads = 1) const {
+        static constexpr int BATCH = 64;
+        int Q = queries.size();
+        vector<int> ans(Q);
+
+        lca_batch_split(Q, nthreads, [&](int l, int r) {
+            int us[BATCH], vs[BATCH], Iu[BATCH], Iv[BATCH], Au[BATCH], Av[BATCH];
+            int hz[BATCH], xu[BATCH], xv[BATCH];
+            for (int s = l; s < r; s += BATCH) {
+                int n = min(BATCH, r - s);
+                for (int k = 0; k < n; k++) {
+                    auto [u, v] = queries[s + k];
+                    us[k] = u, vs[k] = v;
+                    Iu[k] = I[u], Iv[k] = I[v], Au[k] = A[u], Av[k] = A[v];
+                }
+                for (int k = 0; k < n; k++) {
+                    int x = Iu[k] ^ Iv[k];
+                    int hb = x ? highest_one_bit(x) : lowest_one_bit(Iu[k]);
+                    hz[k] = lowest_one_bit(Au[k] & Av[k] & -hb);
+                    int hwu = highest_one_bit(Au[k] & (hz[k] - 1));
+                    int hwv = highest_one_bit(Av[k] & (hz[k] - 1));
+                    xu[k] = (Iu[k] & -hwu) | hwu;
+                    xv[k] = (Iv[k] & -hwv) | hwv;
+                }
+                for (int k = 0; k < n; k++) {
+                    int eu = lowest_one_bit(Iu[k]) == hz[k] ? us[k] : up[head[xu[k]]];
+                    int ev = lowest_one_bit(Iv[k]) == hz[k] ? vs[k] : up[head[xv[k]]];
+                    ans[s + k] = preorder[eu] < preorder[ev] ? eu : ev;
+                }
+            }
+        });
+
+        return ans;
+    }
 };
 
 /**
  * Tarjan's offline LCA algorithm.
+ * Iterative dfs, with the queries bucketed per node in a flat array.
  * Complexity: O(N + Q)
  */
 auto lca_tarjan(const vector<vector<int>>& tree, int root,
                 const vector<array<int, 2>>& queries) {
     int N = tree.size(), Q = queries.size();
 
-    vector<vector<int>> want(N);
-    vector<int> lca(queries.size());
+    vector<int> lca(Q), off(N + 1, 0), want(2 * Q);
 
     for (int i = 0; i < Q; i++) {
         auto [u, v] = queries[i];
         if (u == v) {
             lca[i] = u;
         } else {
-            want[u].push_back(i);
-            want[v].push_back(i);
+            off[u + 1]++, off[v + 1]++;
+        }
+    }
+    partial_sum(begin(off), end(off), begin(off));
+    auto cur = off;
+    for (int i = 0; i < Q; i++) {
+        auto [u, v] = queries[i];
+        if (u != v) {
+            want[cur[u]++] = i, want[cur[v]++] = i;
         }
     }
 
     vector<bool> color(N);
+    vector<int> parent(N), pos(N, 0), dfs;
     disjoint_set dsu(N);
 
-    y_combinator([&](auto self, int u, int p) -> void {
-        dsu.reroot(u);
-        for (int v : tree[u]) {
-            if (v != p) {
-                self(v, u);
-                dsu.join(u, v);
-                dsu.reroot(u);
+    parent[root] = -1, dfs.push_back(root);
+
+    while (!dfs.empty()) {
+        int u = dfs.back(), S = tree[u].size();
+        if (pos[u] < S) {
+            int v = tree[u][pos[u]++];
+            if (v != parent[u]) {
+                parent[v] = u, dfs.push_back(v);
             }
+            continue;
         }
+        dfs.pop_back();
         color[u] = 1;
-        for (int i : want[u]) {
-            int v = u ^ queries[i][0] ^ queries[i][1];
+        for (int j = off[u]; j < off[u + 1]; j++) {
+            int i = want[j], v = u ^ queries[i][0] ^ queries[i][1];
             if (color[v]) {
                 lca[i] = dsu.find(v);
             }
         }
-    })(root, -1);
+        if (int p = parent[u]; p != -1) {
+            dsu.join(p, u);
+            dsu.reroot(p);
+        }
+    }
 
     return lca;
 }
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "disjoint_set.hpp"
+
+/**
+ * Bulk operations of the link cut trees, shared by link_cut_tree_path and
+ * link_cut_tree_subtree as a CRTP base.
+ * LCT provides the node array t, the splay primitives is_root, pushdown, pushup and
+ * adopt, link/cut, and the hooks add_light(u,c)/rem_light(u,c) called when the splay tree
+ * rooted at c starts/stops hanging from u (virtual subtree aggregates, no-ops on paths).
+ */
+template <typename LCT>
+struct link_cut_tree_bulk {
+    /**
+     * Replace the represented forest by the rooted forest parent[] (1-indexed, 0 for
+     * roots), keeping node values. Every heavy path becomes a perfectly balanced splay
+     * tree, so this is O(n) and the first accesses cost O(log^2 n) instead of O(depth).
+     */
+    void build_from_tree(const vector<int>& parent) {
+        flatten();
+        build(parent);
+    }
+
+    /**
+     * Link each edge (u,v) unless u and v are already connected. Small batches are linked
+     * one by one, large batches rebuild the whole forest in O(n + k). Returns #linked.
+     */
+    int link_many(const vector<array<int, 2>>& edges) {
+        int N = self().t.size() - 1, K = edges.size(), linked = 0;
+        if (K < N / BULK_RATIO) {
+            for (auto [u, v] : edges) {
+                linked += self().link(u, v);
+            }
+            return linked;
+        }
+        auto parent = flatten();
+        disjoint_set dsu(N + 1);
+        vector<array<int, 2>> tree;
+        for (int u = 1; u <= N; u++) {
+            if (parent[u]) {
+                dsu.join(u, parent[u]);
+                tree.push_back({u, parent[u]});
+            }
+        }
+        for (auto [u, v] : edges) {
+            if (dsu.join(u, v)) {
+                tree.push_back({u, v}), linked++;
+            }
+        }
+        vector<int> off(N + 2), adj(2 * tree.size()), bfs;
+        for (auto [u, v] : tree) {
+            off[u + 1]++, off[v + 1]++;
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        for (auto [u, v] : tree) {
+            adj[off[u]++] = v, adj[off[v]++] = u;
+        }
+        std::rotate(begin(off), end(off) - 1, end(off)), off[0] = 0;
+
+        // keep the old roots as roots where possible
+        vector<bool> seen(N + 1);
+        bfs.reserve(N);
+        for (int r = 1; r <= N; r++) {
+            if (parent[r] == 0 && !seen[r]) {
+                seen[r] = true, bfs.push_back(r);
+                for (int i = bfs.size() - 1, S = bfs.size(); i < S; i++) {
+                    int u = bfs[i];
+                    for (int j = off[u]; j < off[u + 1]; j++) {
+                        if (int v = adj[j]; !seen[v]) {
+                            seen[v] = true, parent[v] = u, bfs.push_back(v), S++;
+                        }
+                    }
+                }
+            }
+        }
+        build(parent);
+        return linked;
+    }
+
+    /**
+     * Cut each edge (u,v) that is present. Small batches are cut one by one, large
+     * batches rebuild the whole forest in O(n + k). Returns #cut.
+     */
+    int cut_many(const vector<array<int, 2>>& edges) {
+        int N = self().t.size() - 1, K = edges.size(), removed = 0;
+        if (K < N / BULK_RATIO) {
+            for (auto [u, v] : edges) {
+                removed += self().cut(u, v);
+            }
+            return removed;
+        }
+        auto parent = flatten();
+        for (auto [u, v] : edges) {
+            if (u != v && parent[u] == v) {
+                parent[u] = 0, removed++;
+            } else if (u != v && parent[v] == u) {
+                parent[v] = 0, removed++;
+            }
+        }
+        build(parent);
+        return removed;
+    }
+
+  private:
+    static constexpr int BULK_RATIO = 32;
+
+    LCT& self() { return static_cast<LCT&>(*this); }
+
+    // Push all lazies down, detach every splay tree and return the represented forest
+    vector<int> flatten() {
+        auto& lct = self();
+        auto& t = lct.t;
+        int N = t.size() - 1;
+        vector<int> parent(N + 1), roots, stack;
+        for (int u = 1; u <= N; u++) {
+            if (lct.is_root(u)) {
+                roots.push_back(u);
+            }
+        }
+        for (int r : roots) {
+            if (t[r].parent) {
+                lct.rem_light(t[r].parent, r);
+            }
+        }
+        for (int r : roots) {
+            int last = t[r].parent, u = r;
+            while (u || !stack.empty()) {
+                while (u) {
+                    lct.pushdown(u), stack.push_back(u), u = t[u].child[0];
+                }
+                u = stack.back(), stack.pop_back();
+                parent[u] = last, last = u;
+                u = t[u].child[1];
+            }
+        }
+        for (int u = 0; u <= N; u++) {
+            t[u].parent = t[u].child[0] = t[u].child[1] = t[u].flip = 0;
+        }
+        return parent;
+    }
+
+    // Build heavy paths as balanced splay trees over a flattened forest
+    void build(const vector<int>& parent) {
+        auto& lct = self();
+        auto& t = lct.t;
+        int N = t.size() - 1;
+        assert(int(parent.size()) == N + 1);
+        vector<int> off(N + 2), kids(N), bfs, size(N + 1, 1), heavy(N + 1), top(N + 1);
+        for (int u = 1; u <= N; u++) {
+            off[parent[u] + 1]++;
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        for (int u = 1; u <= N; u++) {
+            kids[off[parent[u]]++] = u;
+        }
+        std::rotate(begin(off), end(off) - 1, end(off)), off[0] = 0;
+
+        bfs.assign(begin(kids) + off[0], begin(kids) + off[1]);
+        bfs.reserve(N);
+        for (int i = 0; i < int(bfs.size()); i++) {
+            int u = bfs[i];
+            bfs.insert(end(bfs), begin(kids) + off[u], begin(kids) + off[u + 1]);
+        }
+        assert(int(bfs.size()) == N); // parent[] must be a forest
+        for (int i = N - 1; i >= 0; i--) {
+            int u = bfs[i], p = parent[u];
+            if (p) {
+                size[p] += size[u];
+                if (!heavy[p] || size[heavy[p]] < size[u]) {
+                    heavy[p] = u;
+                }
+            }
+        }
+
+        // children paths are built before their parents in reverse bfs order
+        vector<int> path;
+        for (int i = N - 1; i >= 0; i--) {
+            int h = bfs[i];
+            if (parent[h] && heavy[parent[h]] == h) {
+                continue;
+            }
+            path.clear();
+            for (int u = h; u; u = heavy[u]) {
+                path.push_back(u);
+                for (int j = off[u]; j < off[u + 1]; j++) {
+                    if (int c = kids[j]; c != heavy[u]) {
+                        lct.add_light(u, top[c]);
+                    }
+                }
+            }
+            top[h] = build_balanced(path.data(), path.size());
+            t[top[h]].parent = parent[h];
+        }
+    }
+
+    int build_balanced(const int* seq, int S) {
+        if (S == 0) {
+            return 0;
+        }
+        auto& lct = self();
+        int m = S / 2, u = seq[m];
+        lct.adopt(u, build_balanced(seq, m), 0);
+        lct.adopt(u, build_balanced(seq + m + 1, S - m - 1), 1);
+        lct.pushup(u);
+        return u;
+    }
+};
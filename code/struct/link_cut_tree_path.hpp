@@ -1,7 +1,6 @@
 #pragma once
 
-#include <bits/stdc++.h>
-using namespace std;
+#include "link_cut_tree_bulk.hpp" // build_from_tree, link_many, cut_many
 
 struct lct_node_path_empty {
     void path_flip() {}
@@ -13,7 +12,9 @@ struct lct_node_path_empty {
  * Unrooted link cut tree: lazy path queries + path/point updates.
  */
 template <typename LCTNode>
-struct link_cut_tree_path {
+struct link_cut_tree_path : link_cut_tree_bulk<link_cut_tree_path<LCTNode>> {
+    friend link_cut_tree_bulk<link_cut_tree_path>;
+
     struct Node {
         int parent = 0, child[2] = {};
         int8_t flip = 0; // splay tree is flipped due to reroot
@@ -141,6 +142,10 @@ struct link_cut_tree_path {
         assert(!t[u].child[1] && !t[u].flip);
         return last;
     }
+
+    // ***** Bulk hooks
+    void add_light(int, int) {}
+    void rem_light(int, int) {}
 };
 
 /**
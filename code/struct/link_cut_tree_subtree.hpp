@@ -1,7 +1,6 @@
 #pragma once
 
-#include <bits/stdc++.h>
-using namespace std;
+#include "link_cut_tree_bulk.hpp" // build_from_tree, link_many, cut_many
 
 struct lct_node_subtree_empty {
     void flip_path() {}
@@ -15,7 +14,9 @@ struct lct_node_subtree_empty {
  * Unrooted link cut tree: subtree queries + point updates.
  */
 template <typename LCTNode>
-struct link_cut_tree_subtree {
+struct link_cut_tree_subtree : link_cut_tree_bulk<link_cut_tree_subtree<LCTNode>> {
+    friend link_cut_tree_bulk<link_cut_tree_subtree>;
+
     struct Node {
         int parent = 0, child[2] = {};
         int8_t flip = 0; // splay tree is flipped due to reroot
@@ -155,6 +156,10 @@ struct link_cut_tree_subtree {
         assert(!t[u].child[1] && !t[u].flip);
         return last;
     }
+
+    // ***** Bulk hooks
+    void add_light(int u, int c) { t[u].node.add_virtual_subtree(t[c].node); }
+    void rem_light(int u, int c) { t[u].node.rem_virtual_subtree(t[c].node); }
 };
 
 /**
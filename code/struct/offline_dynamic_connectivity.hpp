@@ -0,0 +1,170 @@
+#pragma once
+
+#include "disjoint_set.hpp"            // disjoint_set_rollback
+#include "dynamic_connectivity.hpp"    // dynamic_connectivity::op
+#include "../parallel/thread_pool.hpp" // thread_pool, parallel_for
+
+/**
+ * Offline dynamic connectivity, vertices in [0,N]
+ * Record a stream of link/cut/conn events, then solve() answers all of them, with the
+ * same results as dynamic_connectivity::update(): whether the link joined two components,
+ * whether the cut separated one, whether the pair is connected. Linking an existing edge
+ * or cutting a missing one does nothing and gives false. The events are the online
+ * structure's ops, so the same stream can be given to either.
+ *
+ * Every event is a query on the edges alive at its time (a link only after it, a cut up
+ * to it). Each edge's lifetime covers a range of queries, stored at O(log Q) nodes of a
+ * segment tree over the queries. A dfs over the tree joins the edges of each node in a
+ * disjoint_set_rollback, answers the query at each leaf and rolls back on the way up.
+ * The dfs is iterative. With nthreads>1 the subtrees below a fixed depth are independent
+ * tasks, each thread has its own union-find and replays the edges on the path from the
+ * root before traversing its subtree.
+ *
+ * Complexity: O(E log Q log N + Q log N)
+ */
+struct offline_dynamic_connectivity {
+    using op_type = dynamic_connectivity::op_type;
+    using op = dynamic_connectivity::op;
+
+    int N;
+    vector<op> ops;
+
+    explicit offline_dynamic_connectivity(int N = 0) : N(N) {}
+
+    void link(int u, int v) { ops.push_back({op_type::LINK, u, v}); }
+    void cut(int u, int v) { ops.push_back({op_type::CUT, u, v}); }
+    void conn(int u, int v) { ops.push_back({op_type::CONN, u, v}); }
+
+    auto solve(int nthreads = 1) const {
+        int S = ops.size(), T = nthreads;
+        assert(T > 0);
+        vector<char> result(S, false);
+
+        // pair up each link with the next cut of the same edge, by sorting the events
+        vector<pair<uint64_t, int>> events;
+        for (int i = 0; i < S; i++) {
+            auto [type, u, v] = ops[i];
+            if (type != op_type::CONN && u != v) {
+                auto [a, b] = minmax(u, v);
+                events.push_back({uint64_t(a) << 32 | uint32_t(b), i});
+            }
+        }
+        sort(begin(events), end(events));
+        vector<char> active(S);
+        vector<array<int, 2>> lifetime, endpoints; // alive strictly between the events
+        for (int i = 0, j = 0, E = events.size(); i < E; i = j) {
+            int start = -1;
+            for (j = i; j < E && events[j].first == events[i].first; j++) {
+                int t = events[j].second;
+                active[t] = (ops[t].type == op_type::LINK) == (start == -1);
+                if (active[t] && ops[t].type == op_type::LINK) {
+                    start = t;
+                } else if (active[t]) {
+                    lifetime.push_back({start, t}), start = -1;
+                }
+            }
+            if (start != -1) {
+                lifetime.push_back({start, S});
+            }
+            auto [type, u, v] = ops[events[i].second];
+            endpoints.resize(lifetime.size(), {u, v});
+        }
+        for (int i = 0; i < S; i++) {
+            active[i] |= ops[i].type == op_type::CONN;
+        }
+
+        // queries are the active events, rank[t] = number of queries before event t
+        vector<int> query, rank(S + 1);
+        for (int t = 0; t < S; t++) {
+            rank[t] = query.size();
+            if (active[t]) {
+                query.push_back(t);
+            }
+        }
+        rank[S] = query.size();
+        int Q = query.size(), n = 1;
+        if (Q == 0) {
+            return result;
+        }
+        while (n < Q) {
+            n *= 2;
+        }
+
+        // edges of each segment tree node in flat arrays, bottom-up range decomposition
+        vector<int> off(2 * n + 1);
+        auto decompose = [&](int l, int r, auto&& fn) {
+            for (l += n, r += n; l < r; l >>= 1, r >>= 1) {
+                if (l & 1) {
+                    fn(l++);
+                }
+                if (r & 1) {
+                    fn(--r);
+                }
+            }
+        };
+        int L = lifetime.size();
+        for (int e = 0; e < L; e++) {
+            decompose(rank[lifetime[e][0] + 1], rank[lifetime[e][1]],
+                      [&](int x) { off[x + 1]++; });
+        }
+        partial_sum(begin(off), end(off), begin(off));
+        vector<array<int, 2>> items(off[2 * n]);
+        vector<int> at(begin(off), end(off) - 1);
+        for (int e = 0; e < L; e++) {
+            decompose(rank[lifetime[e][0] + 1], rank[lifetime[e][1]],
+                      [&](int x) { items[at[x]++] = endpoints[e]; });
+        }
+
+        // tasks are the subtrees at depth D, enough of them to balance the threads
+        int D = 0;
+        while (T > 1 && (1 << D) < 8 * T && (1 << D) < n) {
+            D++;
+        }
+        optional_thread_pool pool(T);
+        thread_pool* P = pool.get();
+        vector<disjoint_set_rollback> dsu(T);
+        vector<vector<int>> stack(T), saved(T, vector<int>(2 * n));
+
+        parallel_for(P, T, 1 << D, 1, [&](int t, int task) {
+            int top = (1 << D) + task;
+            if ((top << (__lg(n) - D)) - n >= Q) {
+                return; // no queries below
+            }
+            auto& uf = dsu[t];
+            auto& time = saved[t];
+            uf.assign(N + 1);
+            for (int x = top >> 1; x >= 1; x >>= 1) {
+                for (int i = off[x]; i < off[x + 1]; i++) {
+                    uf.join(items[i][0], items[i][1]);
+                }
+            }
+            // x>0 enters node x, x<0 leaves node -x
+            auto& st = stack[t];
+            st.assign(1, top);
+            while (!st.empty()) {
+                int x = st.back();
+                st.pop_back();
+                if (x < 0) {
+                    uf.rollback(time[-x]);
+                    continue;
+                }
+                time[x] = uf.time();
+                for (int i = off[x]; i < off[x + 1]; i++) {
+                    uf.join(items[i][0], items[i][1]);
+                }
+                st.push_back(-x);
+                if (x >= n) {
+                    auto [type, u, v] = ops[query[x - n]];
+                    result[query[x - n]] = uf.same(u, v) == (type == op_type::CONN);
+                } else {
+                    int depth = __lg(x), first = (2 * x + 1) << (__lg(n) - depth - 1);
+                    if (first - n < Q) {
+                        st.push_back(2 * x + 1);
+                    }
+                    st.push_back(2 * x);
+                }
+            }
+        });
+        return result;
+    }
+};
@@ -14,16 +14,109 @@ void unit_test_centroid_decomposition() {
     assert(int(g.size()) == V - 1);
 
     auto tree = make_adjacency_lists_undirected(V, g);
-    auto decomp = build_tree_centroid_decomposition(tree);
+    auto [cparent, cdepth] = build_tree_centroid_decomposition(tree);
     for (int u = 0; u < V; u++) {
         cout << (u ? " " : "        ") << setw(2) << u << " \n"[u + 1 == V];
     }
     for (int u = 0; u < V; u++) {
-        cout << (u ? " " : "cparent ") << setw(2) << decomp[u] << " \n"[u + 1 == V];
+        cout << (u ? " " : "cparent ") << setw(2) << cparent[u] << " \n"[u + 1 == V];
     }
+    for (int u = 0; u < V; u++) {
+        cout << (u ? " " : " cdepth ") << setw(2) << cdepth[u] << " \n"[u + 1 == V];
+    }
+}
+
+inline namespace detail {
+
+// every centroid splits its piece (the vertices of depth >= its own reachable from it)
+// into parts of at most half the size, whose centroids have it as parent
+bool verify_centroid_decomposition(const vector<vector<int>>& tree,
+                                   const vector<int>& cparent,
+                                   const vector<int>& cdepth) {
+    int V = tree.size();
+    vector<int> seen(V, -1);
+    auto flood = [&](int s, int c, int d) {
+        vector<int> piece = {s};
+        seen[s] = c;
+        for (int i = 0; i < int(piece.size()); i++) {
+            for (int v : tree[piece[i]]) {
+                if (seen[v] != c && cdepth[v] >= d) {
+                    seen[v] = c, piece.push_back(v);
+                }
+            }
+        }
+        return piece;
+    };
+    for (int c = 0; c < V; c++) {
+        if (cdepth[c] < 0 || (cparent[c] != -1) != (cdepth[c] > 0)) {
+            return false;
+        }
+        int d = cdepth[c], S = flood(c, c, d).size();
+        seen[c] = V + c;
+        for (int v : tree[c]) {
+            if (cdepth[v] > d && seen[v] != V + c) {
+                auto part = flood(v, V + c, d + 1);
+                int top = 0;
+                for (int u : part) {
+                    top += cdepth[u] == d + 1 && cparent[u] == c;
+                }
+                if (2 * int(part.size()) > S || top != 1) {
+                    return false;
+                }
+            } else if (cdepth[v] == d) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+void stress_test_centroid_decomposition() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test centroid decomposition (runs={})", runs);
+
+        int V = intd(1, 200)(mt);
+        int trees = intd(1, min(V, 3))(mt);
+        auto g = boold(0.5)(mt) ? random_geometric_forest(V, trees, reald(-0.9, 0.9)(mt))
+                                : random_tree(V);
+        random_relabel_graph_inplace(V, g);
+        auto tree = make_adjacency_lists_undirected(V, g);
+
+        for (int T : {1, 3}) {
+            auto [cparent, cdepth] = build_tree_centroid_decomposition(tree, T);
+            assert(verify_centroid_decomposition(tree, cparent, cdepth));
+            assert(*max_element(begin(cdepth), end(cdepth)) <= __lg(V));
+        }
+    }
+}
+
+void speed_test_centroid_decomposition() {
+    map<tuple<int, string, string>, stringable> table;
+
+    for (int V : {100'000, 1'000'000, 10'000'000}) {
+        for (double alpha : {-0.5, 0.0, 0.9}) {
+            auto name = alpha < 0 ? "wide" : alpha > 0 ? "deep" : "uniform";
+            print("speed test centroid decomposition V={} {}\n", V, name);
+            auto g = random_geometric_tree(V, alpha);
+            random_relabel_graph_inplace(V, g);
+            auto tree = make_adjacency_lists_undirected(V, g);
+
+            for (int T : {1, 4}) {
+                START_ACC(build);
+                ADD_TIME_BLOCK(build) { build_tree_centroid_decomposition(tree, T); }
+                table[{V, name, format("T={}", T)}] = FORMAT_TIME(build);
+            }
+        }
+    }
+
+    print_time_table(table, "Centroid decomposition");
 }
 
 int main() {
     RUN_SHORT(unit_test_centroid_decomposition());
+    RUN_BLOCK(stress_test_centroid_decomposition());
+    RUN_BLOCK(speed_test_centroid_decomposition());
     return 0;
 }
@@ -0,0 +1,130 @@
+#include "test_utils.hpp"
+#include "../graphs/contraction_hierarchy.hpp"
+#include "../graphs/p2p_query_engine.hpp"
+#include "../graphs/shortest_paths.hpp"
+#include "../lib/graph_generator.hpp"
+
+inline namespace detail {
+
+auto weighted_adjacency(int V, const edges_t& g, int maxw, bool undirected) {
+    vector<vector<pair<int, long>>> adj(V);
+    for (auto [u, v] : g) {
+        int w = intd(0, maxw)(mt);
+        adj[u].emplace_back(v, w);
+        if (undirected) {
+            adj[v].emplace_back(u, w);
+        }
+    }
+    return adj;
+}
+
+} // namespace detail
+
+void stress_test_contraction_hierarchy() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (8s, now, runs) {
+        print_time(now, 8s, "stress test contraction hierarchy (runs={})", runs);
+
+        int V = intd(1, 150)(mt);
+        double p = uniform_real_distribution<double>(0.0, min(6.0 / V, 1.0))(mt);
+        bool undirected = boold(0.5)(mt);
+        auto g = undirected ? random_uniform_undirected(V, p)
+                            : random_uniform_directed(V, p);
+        auto adj = weighted_adjacency(V, g, intd(0, 1000)(mt), undirected);
+
+        contraction_hierarchy<long> ch(adj);
+        vector<vector<long>> dist(V);
+        for (int s = 0; s < V; s++) {
+            dist[s] = dijkstra(s, adj);
+        }
+        for (int q = 0; q < 30; q++) {
+            int s = intd(0, V - 1)(mt), t = intd(0, V - 1)(mt);
+            assert(dist[s][t] == ch.query(s, t));
+        }
+
+        auto sources = rands_unif<int>(intd(1, 10)(mt), 0, V - 1);
+        auto targets = rands_unif<int>(intd(1, 10)(mt), 0, V - 1);
+        auto table = ch.many_to_many(sources, targets);
+        int T = targets.size();
+        for (int i = 0, S = sources.size(); i < S; i++) {
+            for (int j = 0; j < T; j++) {
+                assert(table[i * T + j] == dist[sources[i]][targets[j]]);
+            }
+        }
+    }
+}
+
+void speed_test_contraction_hierarchy() {
+    constexpr int Q = 100'000, M = 100;
+    map<tuple<string, int, string>, stringable> table;
+
+    auto run = [&](const string& name, int V, const edges_t& g) {
+        auto adj = weighted_adjacency(V, g, 10'000, true);
+        vector<array<int, 2>> queries(Q);
+        for (auto& [s, t] : queries) {
+            s = intd(0, V - 1)(mt), t = intd(0, V - 1)(mt);
+        }
+        vector<long> ans(Q);
+        START_ACC4(preprocess, ch, bidirectional, dijkstra);
+        START_ACC2(many, many_dijkstra);
+
+        ADD_TIME_BLOCK(preprocess) {
+            contraction_hierarchy<long> ch(adj);
+            ADD_TIME_BLOCK(ch) {
+                for (int i = 0; i < Q; i++) {
+                    ans[i] = ch.query(queries[i][0], queries[i][1]);
+                }
+            }
+            auto sources = rands_unif<int>(M, 0, V - 1);
+            auto targets = rands_unif<int>(M, 0, V - 1);
+            vector<long> many;
+            ADD_TIME_BLOCK(many) { many = ch.many_to_many(sources, targets); }
+            ADD_TIME_BLOCK(many_dijkstra) {
+                for (int i = 0; i < M; i++) {
+                    auto dist = dijkstra(sources[i], adj);
+                    for (int j = 0; j < M; j++) {
+                        assert(many[i * M + j] == dist[targets[j]]);
+                    }
+                }
+            }
+            table[{name, V, "shortcuts"}] = ch.shortcuts;
+        }
+        time_preprocess -= time_ch + time_many + time_many_dijkstra;
+
+        p2p_query_engine<long> engine(adj);
+        ADD_TIME_BLOCK(bidirectional) {
+            for (int i = 0; i < Q / 10; i++) {
+                assert(ans[i] == engine.bidirectional(queries[i][0], queries[i][1]));
+            }
+        }
+        ADD_TIME_BLOCK(dijkstra) {
+            for (int i = 0; i < Q / 1000; i++) {
+                assert(ans[i] == dijkstra(queries[i][0], adj)[queries[i][1]]);
+            }
+        }
+
+        table[{name, V, "preprocess"}] = FORMAT_TIME(preprocess);
+        table[{name, V, "ch query"}] = FORMAT_EACH(ch, Q);
+        table[{name, V, "bidir query"}] = FORMAT_EACH(bidirectional, Q / 10);
+        table[{name, V, "dijkstra"}] = FORMAT_EACH(dijkstra, Q / 1000);
+        table[{name, V, "100x100 ch"}] = FORMAT_TIME(many);
+        table[{name, V, "100x100 dijkstra"}] = FORMAT_TIME(many_dijkstra);
+    };
+
+    // random expanders contract into a dense core, so they are kept small
+    for (int W : {100, 200}) {
+        print("speed test contraction hierarchy grid W={}\n", W);
+        run("grid", W * W, grid_graph(W, W));
+    }
+    for (int W : {30, 50}) {
+        print("speed test contraction hierarchy random V={}\n", W * W);
+        run("random", W * W, random_exact_undirected_connected(W * W, 3 * W * W));
+    }
+
+    print_time_table(table, "Contraction hierarchy");
+}
+
+int main() {
+    RUN_BLOCK(stress_test_contraction_hierarchy());
+    RUN_BLOCK(speed_test_contraction_hierarchy());
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "test_utils.hpp"
-#include "lib/event_time_tracker.hpp"
+#include "../lib/event_time_tracker.hpp"
 #include "../struct/dynamic_connectivity.hpp"
+#include "../struct/offline_dynamic_connectivity.hpp"
 #include "../struct/pbds.hpp"
 #include "../lib/slow_graph.hpp"
 
@@ -21,7 +22,7 @@ void unit_test_dynacon() {
         assert(S == slow.num_components());
     };
     [[maybe_unused]] auto test_conn = [&](int u, int v, bool ok) {
-        bool is = dynacon.link(u, v);
+        bool is = dynacon.conn(u, v);
         print("conn({:2},{:2}): {:5} {:5} {:5}\n", u, v, is, slow.conn(u, v), ok);
         assert(S == slow.num_components());
     };
@@ -146,8 +147,156 @@ void random_test_dynacon() {
     tracker.pretty_log(event_names);
 }
 
+inline namespace detail {
+
+using dynacon_op = dynamic_connectivity::op;
+
+// a stream of ops on [0,N) that only cuts existing edges, starting from the given edges
+auto random_dynacon_ops(int N, int S, array<int, 3> mix, vector<array<int, 2>>& edges) {
+    discrete_distribution<int> typed(begin(mix), end(mix));
+    hash_set<long> present;
+    for (auto [u, v] : edges) {
+        present.insert(1L * min(u, v) * N + max(u, v));
+    }
+    vector<dynacon_op> ops;
+    ops.reserve(S);
+    while (int(ops.size()) < S) {
+        int type = typed(mt);
+        if (type == dynamic_connectivity::CUT && !edges.empty()) {
+            int i = intd(0, edges.size() - 1)(mt);
+            auto [u, v] = edges[i];
+            swap(edges[i], edges.back()), edges.pop_back();
+            present.erase(1L * min(u, v) * N + max(u, v));
+            ops.push_back({dynamic_connectivity::CUT, u, v});
+        } else if (type != dynamic_connectivity::CUT) {
+            auto [u, v] = different(0, N);
+            if (type == dynamic_connectivity::CONN) {
+                ops.push_back({dynamic_connectivity::CONN, u, v});
+            } else if (present.insert(1L * min(u, v) * N + max(u, v)).second) {
+                edges.push_back({u, v});
+                ops.push_back({dynamic_connectivity::LINK, u, v});
+            }
+        }
+    }
+    return ops;
+}
+
+} // namespace detail
+
+void stress_test_dynacon_batch() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test dynacon batch (runs={})", runs);
+
+        int N = intd(2, 60)(mt);
+        array<int, 3> mix = {intd(1, 5)(mt), intd(1, 5)(mt), intd(1, 5)(mt)};
+        vector<array<int, 2>> edges;
+        auto ops = random_dynacon_ops(N, 300, mix, edges);
+
+        dynamic_connectivity dynacon(N);
+        slow_graph slow(N);
+        auto result = dynacon.update(ops);
+        for (int i = 0; i < 300; i++) {
+            auto [type, u, v] = ops[i];
+            // slow_graph is 1-indexed
+            bool want = type == dynamic_connectivity::LINK  ? slow.link(u + 1, v + 1)
+                        : type == dynamic_connectivity::CUT ? slow.cut(u + 1, v + 1)
+                                                            : slow.conn(u + 1, v + 1);
+            assert(result[i] == want);
+        }
+        assert(dynacon.num_edges() == slow.num_edges());
+    }
+}
+
+void speed_test_dynacon() {
+    map<tuple<int, string, string>, stringable> table;
+    const int S = 1'000'000;
+
+    for (int N : {10'000, 100'000, 1'000'000}) {
+        for (auto mix : {array<int, 3>{40, 40, 20}, {30, 20, 50}, {10, 10, 80}}) {
+            auto name = format("{}/{}/{}", mix[0], mix[1], mix[2]);
+            print("speed test dynacon N={} link/cut/conn={}\n", N, name);
+
+            // start with N random edges, about the size of the giant component
+            vector<array<int, 2>> edges;
+            auto initial = random_dynacon_ops(N, N, {1, 0, 0}, edges);
+            auto ops = random_dynacon_ops(N, S, mix, edges);
+
+            START_ACC(batch);
+            dynamic_connectivity dynacon(N);
+            dynacon.update(initial);
+            ADD_TIME_BLOCK(batch) { dynacon.update(ops); }
+
+            table[{N, name, "1M ops"}] = FORMAT_TIME(batch);
+            table[{N, name, "levels"}] = dynacon.level.size();
+        }
+    }
+
+    print_time_table(table, "Dynamic connectivity (link/cut/conn %)");
+}
+
+void stress_test_offline_dynacon() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test offline dynacon (runs={})", runs);
+
+        int N = intd(2, 60)(mt), S = intd(1, 400)(mt);
+        array<int, 3> mix = {intd(1, 5)(mt), intd(1, 5)(mt), intd(1, 5)(mt)};
+        vector<array<int, 2>> edges;
+        auto ops = random_dynacon_ops(N, S, mix, edges);
+
+        // no-ops: relinks, cuts of missing edges and self-loops
+        for (int i = 0, noise = intd(0, S / 4)(mt); i < noise; i++) {
+            auto type = dynamic_connectivity::op_type(intd(0, 2)(mt));
+            int u = intd(0, N - 1)(mt), v = boold(0.2)(mt) ? u : intd(0, N - 1)(mt);
+            ops.insert(ops.begin() + intd(0, ops.size())(mt), {type, u, v});
+        }
+
+        offline_dynamic_connectivity offline(N);
+        offline.ops = ops;
+        auto want = dynamic_connectivity(N).update(ops);
+        assert(offline.solve(1) == want);
+        assert(offline.solve(3) == want);
+    }
+}
+
+void speed_test_offline_dynacon() {
+    map<tuple<int, string, string>, stringable> table;
+    const int S = 1'000'000;
+
+    for (int N : {10'000, 100'000, 1'000'000}) {
+        for (auto mix : {array<int, 3>{40, 40, 20}, {30, 20, 50}, {10, 10, 80}}) {
+            auto name = format("{}/{}/{}", mix[0], mix[1], mix[2]);
+            print("speed test offline dynacon N={} link/cut/conn={}\n", N, name);
+
+            vector<array<int, 2>> edges;
+            auto ops = random_dynacon_ops(N, N, {1, 0, 0}, edges);
+            auto more = random_dynacon_ops(N, S, mix, edges);
+            ops.insert(ops.end(), begin(more), end(more));
+
+            offline_dynamic_connectivity offline(N);
+            offline.ops = ops;
+
+            START_ACC3(online, offline_x1, offline_x4);
+            [[maybe_unused]] vector<char> want, got1, got4;
+            ADD_TIME_BLOCK(online) { want = dynamic_connectivity(N).update(ops); }
+            ADD_TIME_BLOCK(offline_x1) { got1 = offline.solve(1); }
+            ADD_TIME_BLOCK(offline_x4) { got4 = offline.solve(4); }
+            assert(got1 == want && got4 == want);
+
+            table[{N, name, "online"}] = FORMAT_TIME(online);
+            table[{N, name, "offline x1"}] = FORMAT_TIME(offline_x1);
+            table[{N, name, "offline x4"}] = FORMAT_TIME(offline_x4);
+        }
+    }
+
+    print_time_table(table, "Offline dynamic connectivity, N links + 1M events");
+}
+
 int main() {
     RUN_SHORT(unit_test_dynacon());
     RUN_BLOCK(random_test_dynacon());
+    RUN_BLOCK(stress_test_dynacon_batch());
+    RUN_BLOCK(stress_test_offline_dynacon());
+    RUN_BLOCK(speed_test_dynacon());
+    RUN_BLOCK(speed_test_offline_dynacon());
     return 0;
 }
@@ -2,6 +2,34 @@
 #include "test_utils.hpp"
 #include "../struct/fenwick.hpp"
 
+inline namespace detail {
+
+// the previous fenwick2d layout (vector of rows), baseline for the 2d benchmark
+template <typename T>
+struct nested_fenwick2d {
+    int N, M;
+    vector<vector<T>> tree;
+
+    explicit nested_fenwick2d(int N = 0, int M = 0)
+        : N(N), M(M), tree(N + 1, vector<T>(M + 1)) {}
+
+    T sum(int i, int j) const {
+        T sum = 0;
+        for (; i > 0; i -= i & -i)
+            for (int k = j; k > 0; k -= k & -k)
+                sum += tree[i][k];
+        return sum;
+    }
+
+    void add(int i, int j, T n) {
+        for (; i <= N; i += i & -i)
+            for (int k = j; k <= M; k += k & -k)
+                tree[i][k] += n;
+    }
+};
+
+} // namespace detail
+
 template <template <typename> typename Fenwick>
 void unit_test_1d() {
     Fenwick<int> fw(100);
@@ -46,10 +74,239 @@ void unit_test_2d() {
     assert(fw.sum(80, 95) == 270);
 }
 
+void unit_test_offline_2d() {
+    vector<array<int, 2>> points = {{10, 10}, {20, 20}, {30, 50}, {50, 30},
+                                    {80, 80}, {5, 95},  {85, 5}};
+    offline_fenwick2d<int> fw(points);
+
+    fw.add(10, 10, 10);
+    fw.add(20, 20, 20);
+    fw.add(30, 50, 40);
+    fw.add(50, 30, 40);
+    fw.add(80, 80, 100);
+    fw.add(5, 95, 60);
+    fw.add(85, 5, 60);
+
+    assert(fw.sum(40, 40) == 30);
+    assert(fw.sum(10, 90) == 10);
+    assert(fw.sum(40, 90) == 70);
+    assert(fw.sum(70, 90) == 110);
+    assert(fw.sum(80, 90) == 210);
+    assert(fw.sum(80, 94) == 210);
+    assert(fw.sum(80, 95) == 270);
+    assert(fw.sum(4, 1000) == 0 && fw.sum(1000, 4) == 0);
+    assert(fw.rectangle(9, 9, 50, 50) == 110);
+}
+
+void stress_test_fenwick() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test fenwick (runs={})", runs);
+
+        int N = rand_unif<int>(1, 300);
+        auto arr = rands_unif<long>(N, -1000, 1000);
+        fenwick<long> fw(arr);
+        range_fenwick<long> rf(arr);
+        vector<long> diff(N); // range adds as two point adds, the second maybe at N+1
+        adjacent_difference(begin(arr), end(arr), begin(diff));
+        fenwick<long> df(diff);
+
+        for (int q = 0; q < 100; q++) {
+            int l = rand_unif<int>(1, N), r = rand_unif<int>(l, N);
+            long n = rand_unif<long>(-1000, 1000);
+            if (rand_unif<int>(0, 1)) {
+                int K = rand_unif<int>(0, 2 * N);
+                vector<pair<int, long>> updates(K);
+                for (auto& [i, v] : updates) {
+                    i = rand_unif<int>(1, N), v = rand_unif<long>(-1000, 1000);
+                    arr[i - 1] += v;
+                }
+                fw.add_many(updates);
+                vector<pair<int, long>> ranges;
+                for (auto [i, v] : updates) {
+                    rf.add(i, i, v);
+                    ranges.push_back({i, v}), ranges.push_back({i + 1, -v});
+                }
+                df.add_many(ranges);
+            } else {
+                for (int i = l; i <= r; i++) {
+                    arr[i - 1] += n;
+                    fw.add(i, n);
+                }
+                rf.add(l, r, n);
+                df.add_many({{l, n}, {r + 1, -n}});
+            }
+            long sum = 0;
+            for (int i = 1; i <= N; i++) {
+                sum += arr[i - 1];
+                assert(fw.sum(i) == sum && rf.sum(i) == sum && rf.get(i) == arr[i - 1]);
+                assert(df.sum(i) == arr[i - 1]);
+            }
+            assert(rf.sum(l, r) == fw.sum(r) - fw.sum(l - 1));
+        }
+    }
+}
+
+void stress_test_fenwick2d() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test fenwick2d (runs={})", runs);
+
+        int N = rand_unif<int>(1, 40), M = rand_unif<int>(1, 40);
+        int P = rand_unif<int>(1, 60);
+        vector<array<int, 2>> points(P);
+        for (auto& [i, j] : points) {
+            i = rand_unif<int>(1, N), j = rand_unif<int>(1, M);
+        }
+        fenwick2d<long> fw(N, M);
+        offline_fenwick2d<long> of(points);
+        vector<vector<long>> grid(N + 1, vector<long>(M + 1));
+
+        for (int q = 0; q < 50; q++) {
+            auto [i, j] = points[rand_unif<int>(0, P - 1)];
+            long n = rand_unif<long>(-1000, 1000);
+            grid[i][j] += n, fw.add(i, j, n), of.add(i, j, n);
+
+            int x = rand_unif<int>(0, N), y = rand_unif<int>(0, M);
+            long sum = 0;
+            for (int a = 1; a <= x; a++)
+                for (int b = 1; b <= y; b++)
+                    sum += grid[a][b];
+            assert(fw.sum(x, y) == sum && of.sum(x, y) == sum);
+        }
+    }
+}
+
+void speed_test_fenwick() {
+    static vector<int> Ns = {1000, 100'000, 10'000'000};
+    const auto duration = 15000ms / Ns.size();
+    map<pair<int, string>, stringable> table;
+
+    for (int N : Ns) {
+        START_ACC4(build_add, build_linear, add_each, add_many);
+        START_ACC2(range_add, range_sum);
+        int K = N;
+
+        LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+            print_time(now, duration, "speed test fenwick N={}", N);
+
+            auto arr = rands_unif<long>(N, -1000, 1000);
+            vector<pair<int, long>> updates(K);
+            for (auto& [i, v] : updates) {
+                i = rand_unif<int>(1, N), v = rand_unif<long>(-1000, 1000);
+            }
+            fenwick<long> a(N), b(arr);
+            range_fenwick<long> rf(arr);
+
+            ADD_TIME_BLOCK(build_add) {
+                for (int i = 1; i <= N; i++) {
+                    a.add(i, arr[i - 1]);
+                }
+            }
+            ADD_TIME_BLOCK(build_linear) { b = fenwick<long>(arr); }
+            assert(a.tree == b.tree);
+            ADD_TIME_BLOCK(add_each) {
+                for (auto [i, v] : updates) {
+                    a.add(i, v);
+                }
+            }
+            ADD_TIME_BLOCK(add_many) { b.add_many(updates); }
+            assert(a.tree == b.tree);
+            ADD_TIME_BLOCK(range_add) {
+                for (int k = 0; k < K; k++) {
+                    int l = rand_unif<int>(1, N), r = rand_unif<int>(l, N);
+                    rf.add(l, r, k);
+                }
+            }
+            long sum = 0;
+            ADD_TIME_BLOCK(range_sum) {
+                for (int k = 0; k < K; k++) {
+                    int l = rand_unif<int>(1, N), r = rand_unif<int>(l, N);
+                    sum += rf.sum(l, r);
+                }
+            }
+            assert(sum != 1);
+        }
+
+        table[{N, "build add"}] = FORMAT_EACH(build_add, runs);
+        table[{N, "build linear"}] = FORMAT_EACH(build_linear, runs);
+        table[{N, "add each"}] = FORMAT_EACH(add_each, runs);
+        table[{N, "add many"}] = FORMAT_EACH(add_many, runs);
+        table[{N, "range add"}] = FORMAT_EACH(range_add, 1L * runs * K);
+        table[{N, "range sum"}] = FORMAT_EACH(range_sum, 1L * runs * K);
+    }
+
+    print_time_table(table, "Fenwick 1d");
+}
+
+void speed_test_fenwick2d() {
+    static vector<int> Ns = {100, 1000, 4000};
+    static const int Q = 1'000'000;
+    const auto duration = 20000ms / Ns.size();
+    map<pair<int, string>, stringable> table;
+
+    for (int N : Ns) {
+        START_ACC4(nested, flat, offline, sparse);
+
+        LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+            print_time(now, duration, "speed test fenwick2d N={}", N);
+
+            vector<array<int, 2>> points(Q / 10);
+            for (auto& [i, j] : points) {
+                i = rand_unif<int>(1, N), j = rand_unif<int>(1, N);
+            }
+            vector<array<int, 3>> ops(Q);
+            for (auto& [i, j, v] : ops) {
+                tie(i, j) = make_pair(rand_unif<int>(1, N), rand_unif<int>(1, N));
+                v = rand_unif<int>(0, 1);
+                if (v) {
+                    tie(i, j) = make_pair(points[i % points.size()][0],
+                                          points[i % points.size()][1]);
+                }
+            }
+            array<long, 4> sums = {};
+
+            auto run = [&](auto& fw, long& sum) {
+                for (auto [i, j, v] : ops) {
+                    v ? fw.add(i, j, i ^ j) : void(sum += fw.sum(i, j));
+                }
+            };
+
+            ADD_TIME_BLOCK(nested) {
+                nested_fenwick2d<long> fw(N, N);
+                run(fw, sums[0]);
+            }
+            ADD_TIME_BLOCK(flat) {
+                fenwick2d<long> fw(N, N);
+                run(fw, sums[1]);
+            }
+            ADD_TIME_BLOCK(offline) {
+                offline_fenwick2d<long> fw(points);
+                run(fw, sums[2]);
+            }
+            ADD_TIME_BLOCK(sparse) {
+                sparse_fenwick2d<long> fw(N, N);
+                run(fw, sums[3]);
+            }
+            assert(all_eq(sums));
+        }
+
+        table[{N, "nested"}] = FORMAT_EACH(nested, 1L * runs * Q);
+        table[{N, "flat"}] = FORMAT_EACH(flat, 1L * runs * Q);
+        table[{N, "offline"}] = FORMAT_EACH(offline, 1L * runs * Q);
+        table[{N, "sparse"}] = FORMAT_EACH(sparse, 1L * runs * Q);
+    }
+
+    print_time_table(table, "Fenwick 2d (per operation)");
+}
+
 int main() {
     RUN_SHORT(unit_test_1d<fenwick>());
     RUN_SHORT(unit_test_1d<sparse_fenwick>());
     RUN_SHORT(unit_test_2d<fenwick2d>());
     RUN_SHORT(unit_test_2d<sparse_fenwick2d>());
+    RUN_SHORT(unit_test_offline_2d());
+    RUN_BLOCK(stress_test_fenwick());
+    RUN_BLOCK(stress_test_fenwick2d());
+    RUN_BLOCK(speed_test_fenwick());
+    RUN_BLOCK(speed_test_fenwick2d());
     return 0;
 }
@@ -2,6 +2,7 @@
 #include "../lib/graph_formats.hpp"
 #include "../lib/graph_generator.hpp"
 #include "../graphs/heavy_light_decomposition.hpp"
+#include "../struct/segtree.hpp"
 
 void unit_test_heavy_light_decomposition() {
     int V = 38;
@@ -14,7 +15,8 @@ void unit_test_heavy_light_decomposition() {
     assert(int(g.size()) == V - 1);
 
     auto tree = make_adjacency_lists_undirected(V, g);
-    auto [parent, depth, head, tin, tout] = build_tree_heavy_light_decomposition(tree, 0);
+    auto [parent, depth, heavy, head, tin, tout] =
+        build_tree_heavy_light_decomposition(tree, 0);
     for (int u = 0; u < V; u++) {
         cout << (u ? " " : "       ") << setw(2) << u << " \n"[u + 1 == V];
     }
@@ -24,6 +26,9 @@ void unit_test_heavy_light_decomposition() {
     for (int u = 0; u < V; u++) {
         cout << (u ? " " : " depth ") << setw(2) << depth[u] << " \n"[u + 1 == V];
     }
+    for (int u = 0; u < V; u++) {
+        cout << (u ? " " : " heavy ") << setw(2) << heavy[u] << " \n"[u + 1 == V];
+    }
     for (int u = 0; u < V; u++) {
         cout << (u ? " " : "  head ") << setw(2) << head[u] << " \n"[u + 1 == V];
     }
@@ -35,7 +40,104 @@ void unit_test_heavy_light_decomposition() {
     }
 }
 
+void stress_test_heavy_light_decomposition() {
+    using namespace samples_segtree;
+
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test heavy light decomposition (runs={})", runs);
+
+        int V = intd(1, 100)(mt);
+        auto g = random_geometric_tree(V, reald(-0.9, 0.9)(mt));
+        random_relabel_graph_inplace(V, g);
+        auto tree = make_adjacency_lists_undirected(V, g);
+        int root = intd(0, V - 1)(mt);
+        auto hld = build_tree_heavy_light_decomposition(tree, root);
+        const auto& [parent, depth, heavy, head, tin, tout] = hld;
+
+        vector<int> value = rands_unif<int>(V, -100, 100), at(V);
+        for (int u = 0; u < V; u++) {
+            at[tin[u]] = value[u];
+            assert(parent[u] == -1 ? u == root && depth[u] == 0
+                                   : depth[u] == depth[parent[u]] + 1);
+            assert(head[u] == (parent[u] != -1 && heavy[parent[u]] == u ? head[parent[u]]
+                                                                        : u));
+            assert(heavy[u] == -1 || tin[heavy[u]] == tin[u] + 1);
+        }
+        segtree<sum_segnode, add_segupdate> seg(0, V, at);
+
+        for (int q = 0; q < 20; q++) {
+            int u = intd(0, V - 1)(mt), v = intd(0, V - 1)(mt);
+
+            // naive path by climbing
+            int a = u, b = v, path_sum = 0, edge_sum = 0;
+            while (a != b) {
+                int& x = depth[a] >= depth[b] ? a : b;
+                path_sum += value[x], edge_sum += value[x], x = parent[x];
+            }
+            path_sum += value[a];
+            assert(hld.lca(u, v) == a);
+
+            int got = 0, got_edges = 0;
+            hld.for_each_path_segment(u, v, [&](int L, int R) {
+                got += seg.query_range(L, R).value;
+            });
+            hld.for_each_path_segment(
+                u, v, [&](int L, int R) { got_edges += seg.query_range(L, R).value; },
+                true);
+            assert(got == path_sum && got_edges == edge_sum);
+
+            int subtree_sum = 0;
+            for (int w = 0; w < V; w++) {
+                int x = w;
+                while (x != -1 && x != u) {
+                    x = parent[x];
+                }
+                bool inside = tin[u] <= tin[w] && tin[w] < tout[u];
+                assert(inside == (x == u));
+                subtree_sum += inside ? value[w] : 0;
+            }
+            assert(seg.query_range(tin[u], tout[u]).value == subtree_sum);
+        }
+    }
+}
+
+void speed_test_heavy_light_decomposition() {
+    using namespace samples_segtree;
+    map<tuple<int, string, string>, stringable> table;
+
+    for (int V : {100'000, 1'000'000, 10'000'000}) {
+        for (double alpha : {-0.5, 0.0, 0.9}) {
+            auto name = alpha < 0 ? "wide" : alpha > 0 ? "deep" : "uniform";
+            print("speed test heavy light decomposition V={} {}\n", V, name);
+            auto g = random_geometric_tree(V, alpha);
+            random_relabel_graph_inplace(V, g);
+            auto tree = make_adjacency_lists_undirected(V, g);
+
+            START_ACC2(build, queries);
+            heavy_light_decomposition hld;
+            ADD_TIME_BLOCK(build) { hld = build_tree_heavy_light_decomposition(tree, 0); }
+
+            segtree<sum_segnode, add_segupdate> seg(0, V);
+            ADD_TIME_BLOCK(queries) {
+                for (int q = 0; q < 100'000; q++) {
+                    int u = intd(0, V - 1)(mt), v = intd(0, V - 1)(mt);
+                    hld.for_each_path_segment(u, v, [&](int L, int R) {
+                        seg.update_range(L, R, add_segupdate(1));
+                    });
+                }
+            }
+
+            table[{V, name, "build"}] = FORMAT_TIME(build);
+            table[{V, name, "100K path updates"}] = FORMAT_TIME(queries);
+        }
+    }
+
+    print_time_table(table, "Heavy light decomposition");
+}
+
 int main() {
     RUN_SHORT(unit_test_heavy_light_decomposition());
+    RUN_BLOCK(stress_test_heavy_light_decomposition());
+    RUN_BLOCK(speed_test_heavy_light_decomposition());
     return 0;
 }
@@ -1,5 +1,6 @@
 #include "test_utils.hpp"
 #include "../struct/integer_heaps.hpp"
+#include "../graphs/shortest_paths.hpp"
 #include "../lib/graph_generator.hpp"
 
 inline namespace detail {
@@ -20,6 +21,26 @@ ostream& operator<<(ostream& out, binary_int_heap<Compare> heap) {
     return out << nums;
 }
 
+template <typename Compare>
+struct quaternary_int_heap : dary_int_heap<4, Compare> {
+    using dary_int_heap<4, Compare>::dary_int_heap;
+};
+template <typename Compare>
+struct octonary_int_heap : dary_int_heap<8, Compare> {
+    using dary_int_heap<8, Compare>::dary_int_heap;
+};
+template <typename Compare>
+quaternary_int_heap(int, const Compare&) -> quaternary_int_heap<Compare>;
+template <typename Compare>
+octonary_int_heap(int, const Compare&) -> octonary_int_heap<Compare>;
+
+template <typename Container>
+using quaternary_min_int_heap = dary_int_heap<4, less_container<Container>>;
+template <typename Container>
+using octonary_min_int_heap = dary_int_heap<8, less_container<Container>>;
+template <typename Container>
+using pairing_min_int_heap = pairing_int_heap<less_container<Container>>;
+
 } // namespace detail
 
 template <template <typename> typename Heap, bool adjust = true>
@@ -111,6 +132,129 @@ void stress_test_int_heap(int N = 60) {
     printcl("average size: {:.2f} ({:.2f}%)\n", avg, 100.0 * avg / N);
 }
 
+template <template <typename> typename Heap>
+void stress_test_monotone_int_heap(int N = 60, long C = 1000) {
+    vector<long> key(N);
+    Heap<vector<long>> heap(N, key);
+    set<pair<long, int>> nums;
+    long last = 0;
+    bool anchored = false; // any keys are allowed since the heap ran empty
+
+    enum HeapAction {
+        CLEAR,
+        PUSH,
+        IMPROVE,
+        POP,
+    };
+    discrete_distribution<int> actiond({5, 4000, 3000, 3000});
+
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress monotone heap");
+        auto action = HeapAction(actiond(mt));
+        int n = rand_unif<int>(0, N - 1);
+
+        switch (action) {
+        case CLEAR: {
+            nums.clear(), anchored = false;
+            heap.clear();
+        } break;
+        case PUSH: {
+            if (!heap.contains(n)) {
+                long base = anchored ? last : rand_unif<long>(0, last);
+                key[n] = base + rand_wide<long>(0, C, -2);
+                heap.push(n), nums.insert({key[n], n});
+            }
+        } break;
+        case IMPROVE: {
+            if (long lo = anchored ? last : 0; heap.contains(n) && key[n] > lo) {
+                nums.erase({key[n], n});
+                key[n] = rand_unif<long>(lo, key[n] - 1);
+                heap.improve(n), nums.insert({key[n], n});
+            }
+        } break;
+        case POP: {
+            if (!nums.empty()) {
+                int m = heap.pop();
+                assert(!heap.contains(m) && nums.count({key[m], m}));
+                assert(key[m] == nums.begin()->first);
+                nums.erase({key[m], m}), last = key[m], anchored = !nums.empty();
+            }
+        } break;
+        }
+
+        assert(heap.empty() == nums.empty() && heap.size() == nums.size());
+    }
+}
+
+// the frontier runs empty after every pop on a path, keys grow far past the ring size
+void unit_test_dijkstra_path_heaps() {
+    for (int V : {2'000, 20'000}) {
+        vector<vector<pair<int, long>>> adj(V);
+        for (int u = 0; u + 1 < V; u++) {
+            long w = rand_unif<long>(900, 1000);
+            adj[u].emplace_back(u + 1, w);
+            adj[u + 1].emplace_back(u, w);
+        }
+        auto ans = dijkstra(0, adj);
+        assert(ans == (dijkstra<long, long, radix_int_heap>(0, adj)));
+        assert(ans == (dijkstra<long, long, bucket_int_heap>(0, adj)));
+    }
+}
+
+void speed_test_dijkstra_heaps() {
+    static vector<int> Vs = {10'000, 100'000, 1'000'000};
+    static vector<int> Cs = {10, 1000, 1'000'000};
+    static const int E = 4;
+    const auto duration = 30000ms / (Vs.size() * Cs.size());
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (int C : Cs) {
+            START_ACC3(binary, quaternary, octonary);
+            START_ACC3(pairing, radix, bucket);
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+                print_time(now, duration, "speed test dijkstra heaps V={} C={}", V, C);
+
+                auto g = random_exact_undirected_connected(V, E * V);
+                vector<vector<pair<int, long>>> adj(V);
+                for (auto [u, v] : g) {
+                    long w = rand_unif<long>(1, C);
+                    adj[u].emplace_back(v, w);
+                    adj[v].emplace_back(u, w);
+                }
+                vector<long> ans;
+
+                ADD_TIME_BLOCK(binary) { ans = dijkstra(0, adj); }
+                ADD_TIME_BLOCK(quaternary) {
+                    assert(ans == (dijkstra<long, long, quaternary_min_int_heap>(0, adj)));
+                }
+                ADD_TIME_BLOCK(octonary) {
+                    assert(ans == (dijkstra<long, long, octonary_min_int_heap>(0, adj)));
+                }
+                ADD_TIME_BLOCK(pairing) {
+                    assert(ans == (dijkstra<long, long, pairing_min_int_heap>(0, adj)));
+                }
+                ADD_TIME_BLOCK(radix) {
+                    assert(ans == (dijkstra<long, long, radix_int_heap>(0, adj)));
+                }
+                ADD_TIME_BLOCK(bucket) {
+                    assert(ans == (dijkstra<long, long, bucket_int_heap>(0, adj)));
+                }
+            }
+
+            table[{V, C, "binary"}] = FORMAT_EACH(binary, runs);
+            table[{V, C, "4-ary"}] = FORMAT_EACH(quaternary, runs);
+            table[{V, C, "8-ary"}] = FORMAT_EACH(octonary, runs);
+            table[{V, C, "pairing"}] = FORMAT_EACH(pairing, runs);
+            table[{V, C, "radix"}] = FORMAT_EACH(radix, runs);
+            table[{V, C, "bucket"}] = FORMAT_EACH(bucket, runs);
+        }
+    }
+
+    print_time_table(table, "Dijkstra heaps shootout");
+}
+
 void unit_test_pairing_heaps() {
     constexpr int R = 5, N = 15;
 
@@ -166,6 +310,13 @@ int main() {
     RUN_BLOCK((stress_test_int_heap<binary_int_heap, false>()));
     RUN_BLOCK((stress_test_int_heap<pairing_int_heap, false>()));
     RUN_BLOCK((stress_test_int_heap<pairing_int_heap, true>()));
+    RUN_BLOCK((stress_test_int_heap<quaternary_int_heap, false>()));
+    RUN_BLOCK((stress_test_int_heap<octonary_int_heap, false>()));
+    RUN_BLOCK((stress_test_monotone_int_heap<radix_int_heap>()));
+    RUN_BLOCK((stress_test_monotone_int_heap<bucket_int_heap>()));
+    RUN_BLOCK((stress_test_monotone_int_heap<bucket_int_heap>(60, 100'000)));
     RUN_SHORT(unit_test_pairing_heaps());
+    RUN_SHORT(unit_test_dijkstra_path_heaps());
+    RUN_BLOCK(speed_test_dijkstra_heaps());
     return 0;
 }
@@ -39,36 +39,51 @@ void stress_test_isomorphic_positives() {
     LOOP_FOR_DURATION_TRACKED (5s, now) {
         print_time(now, 5s, "true test");
 
-        int V = distV(mt);
-        auto g1 = random_uniform_undirected_connected(V, distp(mt));
-        auto g2 = random_relabel_graph(V, g1);
+        int V = 2 * (distV(mt) / 2);
+        auto g1 = boold(0.5)(mt) ? random_uniform_undirected_connected(V, distp(mt))
+                                 : random_regular(V, 3);
+
+        vector<int> label(V);
+        iota(begin(label), end(label), 0);
+        shuffle(begin(label), end(label), mt);
+        auto g2 = g1;
+        for (auto& [u, v] : g2) {
+            u = label[u], v = label[v];
+        }
         assert(isomorphic(V, g1, g2));
+
+        auto h1 = hash_graph_vertices(V, g1), h2 = hash_graph_vertices(V, g2);
+        for (int u = 0; u < V; u++) {
+            assert(h1[u] == h2[label[u]]);
+        }
     }
 }
 
-void stress_test_isomorphic_false_positives() {
+void stress_test_isomorphic_hash_collisions() {
     vector<vector<stringable>> table;
-    table.push_back({"name", "runs", "negatives", "positives", "false pos.", "ratio"});
+    table.push_back({"name", "runs", "negatives", "positives", "collisions", "ratio"});
 
     auto run = [&](const auto& name, auto&& gn) {
-        int negatives = 0, positives = 0, false_positives = 0;
+        int negatives = 0, positives = 0, collisions = 0;
 
         LOOP_FOR_DURATION_OR_RUNS_TRACKED (4s, now, 50'000, runs) {
-            print_time(now, 4s, "stress test isomorphism false positives");
+            print_time(now, 4s, "stress test isomorphism hash collisions");
 
             auto [V, g1, g2] = gn();
 
+            bool same_hash = hash_graph(V, g1) == hash_graph(V, g2);
             if (isomorphic(V, g1, g2)) {
                 positives++;
-                false_positives += !boost_test(V, g1, g2);
+                assert(same_hash && boost_test(V, g1, g2));
             } else {
                 negatives++;
+                collisions += same_hash;
                 assert(!boost_test(V, g1, g2));
             }
         }
 
-        double ratio = 100.0 * false_positives / max(positives, 1);
-        table.push_back({name, runs, negatives, positives, false_positives, ratio});
+        double ratio = 100.0 * collisions / max(negatives, 1);
+        table.push_back({name, runs, negatives, positives, collisions, ratio});
     };
 
     run("regular 11V k=2,4", generator_regular(11, 2, 4));
@@ -79,11 +94,58 @@ void stress_test_isomorphic_false_positives() {
         run("regular 14V k=" + to_string(k), generator_regular(14, k, k));
     }
 
-    print_time_table(table, "Isomorphism false positives");
+    print_time_table(table, "Isomorphism hash collisions");
+}
+
+void speed_test_hash_graph() {
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : {10'000, 100'000, 1'000'000}) {
+        for (int degree : {3, 10}) {
+            print("speed test hash graph V={} E={}V\n", V, degree);
+            auto g = random_exact_undirected(V, 1L * V * degree / 2);
+            auto regular = random_regular(V, degree);
+
+            START_ACC2(random, regular);
+            ADD_TIME_BLOCK(random) { hash_graph(V, g); }
+            ADD_TIME_BLOCK(regular) { hash_graph(V, regular); }
+
+            table[{V, degree, "random"}] = FORMAT_TIME(random);
+            table[{V, degree, "regular"}] = FORMAT_TIME(regular);
+        }
+    }
+
+    print_time_table(table, "Hash graph");
+    table.clear();
+
+    // a corpus of small graphs, every graph appears twice
+    for (int V : {20, 200}) {
+        print("speed test hash graph corpus V={}\n", V);
+        vector<pair<int, edges_t>> corpus;
+        for (int i = 0; i < 400'000 / V; i++) {
+            auto g = random_exact_undirected(V, 2 * V);
+            corpus.push_back({V, g});
+            corpus.push_back({V, random_relabel_graph(V, g)});
+        }
+        shuffle(begin(corpus), end(corpus), mt);
+
+        for (int T : {1, 4}) {
+            START_ACC(batch);
+            vector<size_t> hashes;
+            ADD_TIME_BLOCK(batch) { hashes = hash_graphs(corpus, T); }
+            unordered_set<size_t> distinct(begin(hashes), end(hashes));
+            assert(distinct.size() <= corpus.size() / 2);
+
+            table[{V, int(corpus.size()), format("T={}", T)}] = FORMAT_TIME(batch);
+        }
+    }
+
+    print_time_table(table, "Hash graph corpus");
 }
 
 int main() {
     RUN_BLOCK(stress_test_isomorphic_positives());
-    RUN_BLOCK(stress_test_isomorphic_false_positives());
+    RUN_BLOCK(stress_test_isomorphic_hash_collisions());
+    RUN_BLOCK(speed_test_hash_graph());
     return 0;
 }
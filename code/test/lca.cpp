@@ -27,9 +27,96 @@ void unit_test_lca_tree() {
     assert(lca.dist(3, 15) == 2);
 }
 
+inline namespace detail {
+
+auto random_queries(int V, int Q) {
+    vector<array<int, 2>> queries(Q);
+    intd distv(0, V - 1);
+    for (auto& [u, v] : queries) {
+        u = distv(mt), v = distv(mt);
+    }
+    return queries;
+}
+
+} // namespace detail
+
+void stress_test_lca_batch() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test lca batch (runs={})", runs);
+
+        int V = rand_unif<int>(1, 300);
+        int Q = rand_unif<int>(1, 20'000);
+        double alpha = rand_unif<double>(-0.9, 0.9);
+        auto g = random_geometric_tree(V, alpha);
+        auto tree = make_adjacency_lists_undirected(V, g);
+        auto queries = random_queries(V, Q);
+
+        lca_binary lca0(tree, 0);
+        lca_rmq lca1(tree, 0);
+        lca_schieber_vishkin lca2(tree, 0);
+
+        vector<int> expected(Q);
+        for (int i = 0; i < Q; i++) {
+            expected[i] = lca0.lca(queries[i][0], queries[i][1]);
+        }
+
+        assert(lca0.lca_all(queries) == expected);
+        assert(lca1.lca_all(queries) == expected);
+        assert(lca2.lca_all(queries) == expected);
+        assert(lca2.lca_all(queries, 4) == expected);
+        assert(lca_tarjan(tree, 0, queries) == expected);
+    }
+}
+
+template <typename LCA>
+void speed_test_lca_batch(const string& name) {
+    static vector<int> Vs = {1000, 100'000, 1'000'000};
+    static vector<double> alphas = {-0.5, 0.0};
+    static const int Q = 2'000'000;
+    static const int T = max(2u, thread::hardware_concurrency());
+    const auto duration = 10000ms / (Vs.size() * alphas.size());
+    map<tuple<int, double, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (double alpha : alphas) {
+            START_ACC4(single, batch, threaded, tarjan);
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+                print_time(now, duration, "speed test {} V={} alpha={}", name, V, alpha);
+
+                auto g = random_geometric_tree(V, alpha);
+                auto tree = make_adjacency_lists_undirected(V, g);
+                auto queries = random_queries(V, Q);
+                LCA lca(tree, 0);
+                vector<int> ans(Q);
+
+                ADD_TIME_BLOCK(single) {
+                    for (int i = 0; i < Q; i++) {
+                        ans[i] = lca.lca(queries[i][0], queries[i][1]);
+                    }
+                }
+                ADD_TIME_BLOCK(batch) { assert(lca.lca_all(queries) == ans); }
+                ADD_TIME_BLOCK(threaded) { assert(lca.lca_all(queries, T) == ans); }
+                ADD_TIME_BLOCK(tarjan) { assert(lca_tarjan(tree, 0, queries) == ans); }
+            }
+
+            table[{V, alpha, "single"}] = FORMAT_EACH(single, 1L * runs * Q);
+            table[{V, alpha, "batch"}] = FORMAT_EACH(batch, 1L * runs * Q);
+            table[{V, alpha, format("{}-threads", T)}] = FORMAT_EACH(threaded, 1L * runs * Q);
+            table[{V, alpha, "tarjan"}] = FORMAT_EACH(tarjan, 1L * runs * Q);
+        }
+    }
+
+    print_time_table(table, format("LCA batch queries ({})", name));
+}
+
 int main() {
     RUN_SHORT(unit_test_lca_tree<lca_binary>());
     RUN_SHORT(unit_test_lca_tree<lca_rmq>());
     RUN_SHORT(unit_test_lca_tree<lca_schieber_vishkin>());
+    RUN_BLOCK(stress_test_lca_batch());
+    RUN_BLOCK(speed_test_lca_batch<lca_binary>("binary"));
+    RUN_BLOCK(speed_test_lca_batch<lca_rmq>("rmq"));
+    RUN_BLOCK(speed_test_lca_batch<lca_schieber_vishkin>("schieber-vishkin"));
     return 0;
 }
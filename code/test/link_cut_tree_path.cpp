@@ -1,7 +1,8 @@
 #include "test_utils.hpp"
+#include "../lib/graph_generator.hpp"
 #include "../lib/slow_tree.hpp"
 #include "../struct/link_cut_tree_path.hpp"
-#include "lib/tree_action.hpp"
+#include "../lib/tree_action.hpp"
 
 using lct_path = link_cut_tree_path<lct_node_path_sum>;
 using namespace tree_testing;
@@ -34,10 +35,10 @@ bool stress_verify_link_cut(slow_tree<false>& slow, lct_path& tree, int D = 2) {
         if (path[d] != exp_path) {
             if (ok_path) {
                 ok_path = false;
-                printcl("      above: {}\n", above);
-                printcl("expect_path: {}\n", exp_path);
+                printcl("      above: {}\n", seq_to_string(above));
+                printcl("expect_path: {}\n", seq_to_string(exp_path));
             }
-            printcl("got_path[{}]: {}\n", d + 1, path[d]);
+            printcl("got_path[{}]: {}\n", d + 1, seq_to_string(path[d]));
         }
     }
     for (int d = 0; d < D; d++) {
@@ -50,10 +51,10 @@ bool stress_verify_link_cut(slow_tree<false>& slow, lct_path& tree, int D = 2) {
         if (path_length[d] != exp_path_length) {
             if (ok_path_length) {
                 ok_path_length = false;
-                printcl("             above: {}\n", above);
-                printcl("expect_path_length: {}\n", exp_path_length);
+                printcl("             above: {}\n", seq_to_string(above));
+                printcl("expect_path_length: {}\n", seq_to_string(exp_path_length));
             }
-            printcl("got_path_length[{}]: {}\n", d + 1, path_length[d]);
+            printcl("got_path_length[{}]: {}\n", d + 1, seq_to_string(path_length[d]));
         }
     }
 
@@ -253,8 +254,145 @@ void speed_test_lct_path() {
     print_time_table(table, "LCT Path");
 }
 
+void stress_test_lct_path_bulk() {
+    // random rooted forest on [1..N] with shuffled labels and roughly R roots
+    auto random_parents = [&](int N, int R) {
+        auto parent = parent_sample(N, 1);
+        vector<int> label(N + 1), relabeled(N + 1);
+        iota(begin(label), end(label), 0);
+        shuffle(begin(label) + 1, end(label), mt);
+        for (int u = 1; u <= N; u++) {
+            int p = u == 1 || intd(1, N)(mt) <= R ? 0 : parent[u];
+            relabeled[label[u]] = label[p];
+        }
+        return relabeled;
+    };
+
+    for (int run = 0; run < 200; run++) {
+        print_progress(run, 200, "stress test lct path bulk");
+        int N = intd(1, 100)(mt), R = intd(1, 5)(mt);
+        slow_tree<false> slow(N);
+        lct_path tree(N);
+
+        for (int u = 1; u <= N; u++) {
+            long val = intd(-100, 100)(mt);
+            slow.update_node(u, val);
+            tree.t[u].node.self = val;
+        }
+        auto parent = random_parents(N, R);
+        for (int u = 1; u <= N; u++) {
+            if (parent[u]) {
+                slow.link(u, parent[u]);
+            }
+        }
+        tree.build_from_tree(parent);
+        assert(stress_verify_link_cut(slow, tree));
+
+        for (int round = 0; round < 4; round++) {
+            // pending lazies and flips must survive the batch rebuilds
+            for (int i = 0; i < N / 4; i++) {
+                auto [u, v] = slow.random_connected();
+                long val = intd(-10, 10)(mt);
+                slow.update_path(u, v, val);
+                tree.access_path(u, v)->lazy += val;
+            }
+            int E = slow.num_edges(), K = E ? intd(0, E)(mt) : 0;
+            vector<array<int, 2>> edges;
+            for (int i = 0; i < K; i++) {
+                auto [u, v] = slow.random_edge();
+                if (boold(0.5)(mt)) {
+                    swap(u, v);
+                }
+                edges.push_back({u, v});
+            }
+            if (N > 1 && boold(0.5)(mt)) {
+                auto [u, v] = different(1, N + 1);
+                edges.push_back({u, v});
+            }
+            int cut = tree.cut_many(edges), expected_cut = 0;
+            for (auto [u, v] : edges) {
+                if (slow.has_edge(u, v)) {
+                    slow.cut(u, v), expected_cut++;
+                }
+            }
+            assert(cut == expected_cut);
+            assert(stress_verify_link_cut(slow, tree, 1));
+
+            edges.clear();
+            for (int i = 0, L = intd(0, 2 * N)(mt); N > 1 && i < L; i++) {
+                auto [u, v] = different(1, N + 1);
+                edges.push_back({u, v});
+            }
+            int linked = tree.link_many(edges), expected_linked = 0;
+            for (auto [u, v] : edges) {
+                if (!slow.conn(u, v)) {
+                    slow.link(u, v), expected_linked++;
+                }
+            }
+            assert(linked == expected_linked);
+            assert(stress_verify_link_cut(slow, tree, 1));
+        }
+    }
+}
+
+void speed_test_lct_path_build() {
+    vector<vector<stringable>> table;
+    table.push_back({"N", "shape", "method", "build", "access"});
+
+    auto run = [&](int N, double alpha, const string& shape) {
+        vector<int> parent(N + 1);
+        for (auto [p, u] : random_geometric_tree(N, alpha)) {
+            parent[u + 1] = p + 1;
+        }
+        vector<int> order(N);
+        iota(begin(order), end(order), 1);
+        shuffle(begin(order), end(order), mt);
+
+        auto measure = [&](const string& method, auto&& construct) {
+            printcl("speed test lct path build {} {} {}", N, shape, method);
+            lct_path tree(N);
+            START(build);
+            construct(tree);
+            TIME(build);
+            START(access);
+            long sum = 0;
+            for (int u : order) {
+                sum += tree.access_path(u, 1)->path_size;
+            }
+            TIME(access);
+            assert(sum >= N);
+            table.push_back({N, shape, method, FORMAT_TIME(build),
+                             FORMAT_EACH(access, N)});
+        };
+
+        measure("link", [&](lct_path& tree) {
+            for (int u = 2; u <= N; u++) {
+                tree.link(u, parent[u]);
+            }
+        });
+        measure("link_many", [&](lct_path& tree) {
+            vector<array<int, 2>> edges;
+            for (int u = 2; u <= N; u++) {
+                edges.push_back({u, parent[u]});
+            }
+            tree.link_many(edges);
+        });
+        measure("build_from_tree", [&](lct_path& tree) { tree.build_from_tree(parent); });
+    };
+
+    for (int N : {10'000, 1'000'000}) {
+        run(N, -0.5, "wide");
+        run(N, 0.0, "uniform");
+        run(N, 0.95, "deep");
+    }
+
+    print_time_table(table, "LCT Path build");
+}
+
 int main() {
     RUN_SHORT(stress_test_lct_path());
+    RUN_SHORT(stress_test_lct_path_bulk());
     RUN_SHORT(speed_test_lct_path());
+    RUN_SHORT(speed_test_lct_path_build());
     return 0;
 }
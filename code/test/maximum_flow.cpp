@@ -1,8 +1,11 @@
 #include "test_utils.hpp"
+#include "../flow/bk_flow.hpp"
 #include "../flow/dinitz_flow.hpp"
 #include "../flow/edmonds_karp.hpp"
+#include "../flow/parallel_push_relabel.hpp"
 #include "../flow/push_relabel.hpp"
 #include "../flow/tidal_flow.hpp"
+#include "../lib/adjacency_flow.hpp"
 #include "../lib/graph_formats.hpp"
 #include "../lib/graph_generator.hpp"
 
@@ -16,6 +19,38 @@ void add_edges(MF& mf, const edges_t& g, const Caps& caps) {
     }
 }
 
+template <typename MF, typename Caps>
+bool verify_flow(MF& mf, int V, const edges_t& g, const Caps& caps, int s, int t,
+                 long value) {
+    int E = g.size();
+    vector<long> balance(V);
+    for (int i = 0; i < E; i++) {
+        auto f = mf.get_flow(i);
+        if (f < 0 || f > caps[i]) {
+            return false;
+        }
+        balance[g[i][0]] -= f, balance[g[i][1]] += f;
+    }
+    for (int u = 0; u < V; u++) {
+        if (u != s && u != t && balance[u] != 0) {
+            return false;
+        }
+    }
+    return s == t || balance[t] == value;
+}
+
+template <typename MF, typename Caps>
+bool verify_cut(MF& mf, const edges_t& g, const Caps& caps, int s, int t, long value) {
+    long cut = 0;
+    for (int i = 0, E = g.size(); i < E; i++) {
+        auto [u, v] = g[i];
+        if (mf.left_of_mincut(u) && !mf.left_of_mincut(v)) {
+            cut += caps[i];
+        }
+    }
+    return mf.left_of_mincut(s) && !mf.left_of_mincut(t) && cut == value;
+}
+
 template <typename T, typename O = T>
 auto mid_cap(int V, const edges_t& g, T low, T high, int repulsion) {
     int E = g.size();
@@ -30,6 +65,72 @@ auto mid_cap(int V, const edges_t& g, T low, T high, int repulsion) {
     return cap;
 }
 
+// Vision-like segmentation instance on an XxYxZ grid: noisy blobs of source/sink
+// preference and a smoothness capacity on every grid edge (both directions)
+struct grid_instance {
+    int X, Y, Z, N;
+    edges_t g;
+    vector<int> cap, source, sink;
+};
+
+auto make_grid_instance(int X, int Y, int Z, int smooth, int noise) {
+    int N = X * Y * Z;
+    grid_instance gi{X, Y, Z, N, {}, {}, vector<int>(N), vector<int>(N)};
+    gi.g = Z > 1 ? grid3_graph(X, Y, Z) : grid_graph(X, Y);
+    for (int e = 0, E = gi.g.size(); e < E; e++) {
+        gi.g.push_back({gi.g[e][1], gi.g[e][0]});
+    }
+    for (int e = 0, E = gi.g.size(); e < E; e++) {
+        gi.cap.push_back(intd(smooth / 2, smooth)(mt));
+    }
+
+    int B = max(2, N / 500);
+    vector<array<int, 3>> blobs(B);
+    vector<int> side(B);
+    for (int b = 0; b < B; b++) {
+        blobs[b] = {intd(0, X - 1)(mt), intd(0, Y - 1)(mt), intd(0, Z - 1)(mt)};
+        side[b] = boold(0.5)(mt) ? 1 : -1;
+    }
+    for (int z = 0; z < Z; z++) {
+        for (int y = 0; y < Y; y++) {
+            for (int x = 0; x < X; x++) {
+                int best = 0, dmin = INT_MAX;
+                for (int b = 0; b < B; b++) {
+                    auto [bx, by, bz] = blobs[b];
+                    int d = abs(x - bx) + abs(y - by) + abs(z - bz);
+                    if (d < dmin) {
+                        best = b, dmin = d;
+                    }
+                }
+                int u = calc_grid3(X, Y, x, y, z);
+                int f = side[best] * 50 + intd(-noise, noise)(mt);
+                gi.source[u] = max(f, 0) + intd(0, 5)(mt);
+                gi.sink[u] = max(-f, 0) + intd(0, 5)(mt);
+            }
+        }
+    }
+    return gi;
+}
+
+// Same instance as a general network with s=N and t=N+1
+template <typename MF>
+void add_grid_instance(MF& mf, const grid_instance& gi) {
+    add_edges(mf, gi.g, gi.cap);
+    for (int u = 0; u < gi.N; u++) {
+        mf.add(gi.N, u, gi.source[u]);
+        mf.add(u, gi.N + 1, gi.sink[u]);
+    }
+}
+
+template <typename Flow, typename FlowSum>
+void add_grid_instance(bk_grid_flow<Flow, FlowSum>& mf, const grid_instance& gi) {
+    add_edges(mf, gi.g, gi.cap);
+    for (int u = 0; u < gi.N; u++) {
+        mf.add_source(u, gi.source[u]);
+        mf.add_sink(u, gi.sink[u]);
+    }
+}
+
 } // namespace detail
 
 void speed_test_max_flow() {
@@ -46,6 +147,7 @@ void speed_test_max_flow() {
             return;
 
         START_ACC4(dinitz, push, push_full, tidal);
+        START_ACC4(adj_dinitz, adj_push, adj_push_full, adj_tidal);
 
         LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
             print_time(now, duration, "speed test maxflow V,p,a={},{:.3f},{:.3f}", V, p,
@@ -55,7 +157,7 @@ void speed_test_max_flow() {
             add_uniform_self_loops(V, g, 0.2);
             auto cap = mid_cap(V, g, 1, 100'000'000, -10);
 
-            vector<long> ans(4);
+            vector<long> ans(8);
 
             ADD_TIME_BLOCK(dinitz) {
                 dinitz_flow<int, long> mf(V);
@@ -81,6 +183,30 @@ void speed_test_max_flow() {
                 ans[3] = mf.maxflow(s, t);
             }
 
+            ADD_TIME_BLOCK(adj_dinitz) {
+                adjacency_dinitz_flow<int, long> mf(V);
+                add_edges(mf, g, cap);
+                ans[4] = mf.maxflow(s, t);
+            }
+
+            ADD_TIME_BLOCK(adj_push) {
+                adjacency_push_relabel<int, long> mf(V);
+                add_edges(mf, g, cap);
+                ans[5] = mf.maxflow(s, t, true);
+            }
+
+            ADD_TIME_BLOCK(adj_push_full) {
+                adjacency_push_relabel<int, long> mf(V);
+                add_edges(mf, g, cap);
+                ans[6] = mf.maxflow(s, t, false);
+            }
+
+            ADD_TIME_BLOCK(adj_tidal) {
+                adjacency_tidal_flow<int, long> mf(V);
+                add_edges(mf, g, cap);
+                ans[7] = mf.maxflow(s, t);
+            }
+
             if (!all_eq(ans)) {
                 ofstream file("debug.txt");
                 print(file, "{}", simple_dot(g, true));
@@ -92,6 +218,10 @@ void speed_test_max_flow() {
         table[{{V, alpha}, pV, "push"}] = FORMAT_EACH(push, runs);
         table[{{V, alpha}, pV, "full"}] = FORMAT_EACH(push_full, runs);
         table[{{V, alpha}, pV, "tidal"}] = FORMAT_EACH(tidal, runs);
+        table[{{V, alpha}, pV, "dinitz x"}] = FORMAT_RATIO(adj_dinitz, dinitz);
+        table[{{V, alpha}, pV, "push x"}] = FORMAT_RATIO(adj_push, push);
+        table[{{V, alpha}, pV, "full x"}] = FORMAT_RATIO(adj_push_full, push_full);
+        table[{{V, alpha}, pV, "tidal x"}] = FORMAT_RATIO(adj_tidal, tidal);
     };
 
     for (int V : Vs) {
@@ -149,37 +279,303 @@ void stress_test_max_flow() {
 
         auto [V, g, s, t, cap] = make_graph();
 
-        int C = 4;
+        int C = 5;
         dinitz_flow<int, int> g1(V);
         push_relabel<int, int> g2(V);
         push_relabel<int, int> g3(V);
         tidal_flow<int, int> g4(V);
-        // edmonds_karp<int, int> g5(V);
+        edmonds_karp<int, int> g5(V);
 
         add_edges(g1, g, cap);
         add_edges(g2, g, cap);
         add_edges(g3, g, cap);
         add_edges(g4, g, cap);
-        // add_edges(g5, g, cap);
+        add_edges(g5, g, cap);
 
         vector<int> ans(C);
         ans[0] = g1.maxflow(s, t);
         ans[1] = g2.maxflow(s, t);
         ans[2] = g3.maxflow(s, t, false);
         ans[3] = g4.maxflow(s, t);
-        // ans[4] = g5.maxflow(s, t);
+        ans[4] = g5.maxflow(s, t);
 
         if (!all_eq(ans)) {
             ofstream file("debug.txt");
             print(file, "{}", simple_dot(g, true));
             fail("Random test failed: {}", fmt::join(ans, " "));
         }
+        assert(verify_flow(g1, V, g, cap, s, t, ans[0]));
+        assert(verify_flow(g3, V, g, cap, s, t, ans[0]));
+        assert(verify_flow(g4, V, g, cap, s, t, ans[0]));
+        assert(verify_flow(g5, V, g, cap, s, t, ans[0]));
+
+        if (s != t) {
+            assert(verify_cut(g2, g, cap, s, t, ans[0]));
+            bk_flow<int, int> g8(V);
+            add_edges(g8, g, cap);
+            assert(ans[0] == g8.maxflow(s, t));
+            assert(verify_flow(g8, V, g, cap, s, t, ans[0]));
+            assert(verify_cut(g8, g, cap, s, t, ans[0]));
+
+            parallel_push_relabel<int, int> g6(V), g7(V);
+            add_edges(g6, g, cap);
+            add_edges(g7, g, cap);
+            assert(ans[0] == g6.maxflow(s, t, 1));
+            assert(ans[0] == g7.maxflow(s, t, 3));
+            assert(verify_cut(g6, g, cap, s, t, ans[0]));
+            assert(verify_cut(g7, g, cap, s, t, ans[0]));
+        }
+    }
+}
+
+void stress_test_grid_max_flow() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test grid max flow (runs={})", runs);
+
+        int X = intd(1, 12)(mt), Y = intd(1, 12)(mt);
+        int Z = boold(0.5)(mt) ? 1 : intd(2, 6)(mt);
+        auto gi = make_grid_instance(X, Y, Z, intd(1, 120)(mt), intd(0, 80)(mt));
+        int N = gi.N;
+
+        dinitz_flow<int, long> g1(N + 2);
+        bk_flow<int, long> g2(N + 2);
+        bk_grid_flow<int, long> g3(X, Y, Z);
+        add_grid_instance(g1, gi);
+        add_grid_instance(g2, gi);
+        add_grid_instance(g3, gi);
+
+        long ans = g1.maxflow(N, N + 1);
+        assert(ans == g2.maxflow(N, N + 1));
+        assert(ans == g3.maxflow());
+
+        long cut = 0;
+        for (int e = 0, E = gi.g.size(); e < E; e++) {
+            auto [u, v] = gi.g[e];
+            cut += g3.left_of_mincut(u) && !g3.left_of_mincut(v) ? gi.cap[e] : 0;
+        }
+        for (int u = 0; u < N; u++) {
+            cut += g3.left_of_mincut(u) ? gi.sink[u] : gi.source[u];
+        }
+        assert(cut == ans);
+    }
+}
+
+void speed_test_grid_max_flow() {
+    static vector<array<int, 3>> dims = {
+        {256, 256, 1}, {1024, 1024, 1}, {32, 32, 32}, {80, 80, 80}};
+    static vector<int> smooths = {20, 80};
+    const auto duration = 60000ms / (dims.size() * smooths.size());
+    map<tuple<string, int, string>, stringable> table;
+
+    for (auto [X, Y, Z] : dims) {
+        for (int smooth : smooths) {
+            START_ACC3(dinitz, bk, bk_grid);
+            string name = format("{}x{}x{}", X, Y, Z);
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+                print_time(now, duration, "speed test grid max flow {} {}", name, smooth);
+
+                auto gi = make_grid_instance(X, Y, Z, smooth, 30);
+                int N = gi.N;
+                long ans;
+
+                ADD_TIME_BLOCK(dinitz) {
+                    dinitz_flow<int, long> mf(N + 2);
+                    add_grid_instance(mf, gi);
+                    ans = mf.maxflow(N, N + 1);
+                }
+                ADD_TIME_BLOCK(bk) {
+                    bk_flow<int, long> mf(N + 2);
+                    add_grid_instance(mf, gi);
+                    assert(ans == mf.maxflow(N, N + 1));
+                }
+                ADD_TIME_BLOCK(bk_grid) {
+                    bk_grid_flow<int, long> mf(X, Y, Z);
+                    add_grid_instance(mf, gi);
+                    assert(ans == mf.maxflow());
+                }
+            }
+
+            table[{name, smooth, "dinitz"}] = FORMAT_EACH(dinitz, runs);
+            table[{name, smooth, "bk"}] = FORMAT_EACH(bk, runs);
+            table[{name, smooth, "bk grid"}] = FORMAT_EACH(bk_grid, runs);
+            table[{name, smooth, "bk x"}] = FORMAT_RATIO(dinitz, bk);
+            table[{name, smooth, "grid x"}] = FORMAT_RATIO(dinitz, bk_grid);
+        }
+    }
+
+    print_time_table(table, "Grid maximum flow");
+}
+
+void stress_test_warm_max_flow() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test warm max flow (runs={})", runs);
+
+        int V = intd(2, 60)(mt);
+        double p = 3.0 / V;
+        auto [g, s, t] = random_geometric_flow_connected(V, p, p / 2, 0.0);
+        auto cap = rands_unif<int>(g.size(), 0, 1000);
+
+        dinitz_flow<int, int> g1(V);
+        push_relabel<int, int> g2(V);
+        push_relabel<int, int> g3(V);
+        add_edges(g1, g, cap);
+        add_edges(g2, g, cap);
+        add_edges(g3, g, cap);
+
+        for (int round = 0; round < 8; round++) {
+            if (round > 0) {
+                for (int k = intd(1, 6)(mt); k > 0; k--) {
+                    if (boold(0.8)(mt)) {
+                        int e = intd(0, g.size() - 1)(mt);
+                        cap[e] = boold(0.5)(mt) ? 0 : intd(0, 1000)(mt);
+                        g1.set_capacity(e, cap[e]);
+                        g2.set_capacity(e, cap[e]);
+                        g3.set_capacity(e, cap[e]);
+                    } else {
+                        auto [u, v] = different(0, V);
+                        g.push_back({u, v}), cap.push_back(intd(0, 1000)(mt));
+                        g1.add(u, v, cap.back());
+                        g2.add(u, v, cap.back());
+                        g3.add(u, v, cap.back());
+                    }
+                }
+            }
+
+            dinitz_flow<int, int> cold(V);
+            add_edges(cold, g, cap);
+            int ans = cold.maxflow(s, t);
+
+            assert(ans == g1.maxflow(s, t));
+            assert(ans == g2.maxflow(s, t));
+            assert(ans == g3.maxflow(s, t, false));
+            assert(verify_flow(g1, V, g, cap, s, t, ans));
+            assert(verify_cut(g2, g, cap, s, t, ans));
+            assert(verify_flow(g3, V, g, cap, s, t, ans));
+        }
     }
 }
 
+void speed_test_warm_max_flow() {
+    static vector<int> Vs = {10'000, 100'000};
+    static vector<int> edits = {1, 10, 100, 1000};
+    const auto duration = 30000ms / (Vs.size() * edits.size());
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (int K : edits) {
+            START_ACC4(dinitz_cold, dinitz_warm, push_cold, push_warm);
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+                print_time(now, duration, "speed test warm max flow V={} K={}", V, K);
+
+                double p = 6.0 / V;
+                auto [g, s, t] = random_geometric_flow_connected(V, p, p / 2, 0.0);
+                auto cap = rands_unif<int>(g.size(), 1, 100'000);
+
+                dinitz_flow<int, long> dinitz(V);
+                push_relabel<int, long> push(V);
+                add_edges(dinitz, g, cap);
+                add_edges(push, g, cap);
+                dinitz.maxflow(s, t), push.maxflow(s, t);
+
+                vector<int> changed(K);
+                for (int k = 0; k < K; k++) {
+                    changed[k] = intd(0, g.size() - 1)(mt);
+                    cap[changed[k]] = intd(1, 100'000)(mt);
+                }
+                long ans;
+
+                ADD_TIME_BLOCK(dinitz_cold) {
+                    dinitz_flow<int, long> mf(V);
+                    add_edges(mf, g, cap);
+                    ans = mf.maxflow(s, t);
+                }
+                ADD_TIME_BLOCK(push_cold) {
+                    push_relabel<int, long> mf(V);
+                    add_edges(mf, g, cap);
+                    assert(ans == mf.maxflow(s, t));
+                }
+                ADD_TIME_BLOCK(dinitz_warm) {
+                    for (int e : changed) {
+                        dinitz.set_capacity(e, cap[e]);
+                    }
+                    assert(ans == dinitz.maxflow(s, t));
+                }
+                ADD_TIME_BLOCK(push_warm) {
+                    for (int e : changed) {
+                        push.set_capacity(e, cap[e]);
+                    }
+                    assert(ans == push.maxflow(s, t));
+                }
+            }
+
+            table[{V, K, "dinitz cold"}] = FORMAT_EACH(dinitz_cold, runs);
+            table[{V, K, "dinitz warm"}] = FORMAT_EACH(dinitz_warm, runs);
+            table[{V, K, "dinitz x"}] = FORMAT_RATIO(dinitz_cold, dinitz_warm);
+            table[{V, K, "push cold"}] = FORMAT_EACH(push_cold, runs);
+            table[{V, K, "push warm"}] = FORMAT_EACH(push_warm, runs);
+            table[{V, K, "push x"}] = FORMAT_RATIO(push_cold, push_warm);
+        }
+    }
+
+    print_time_table(table, "Warm started max flow");
+}
+
+void scaling_test_parallel_push_relabel() {
+    static vector<int> Vs = {30'000, 300'000};
+    static vector<double> pVs = {4.0, 16.0};
+    static vector<int> threads = {1, 2, 4, 8};
+    const auto duration = 40000ms / (Vs.size() * pVs.size());
+    map<tuple<int, double, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (double pV : pVs) {
+            START_ACC(push);
+            vector<chrono::nanoseconds> time_parallel(threads.size());
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+                print_time(now, duration, "scaling push relabel V={} pV={}", V, pV);
+
+                double p = pV / V;
+                auto [g, s, t] = random_geometric_flow_connected(V, p, p / 2, 0.0);
+                auto cap = rands_unif<int>(g.size(), 1, 100'000'000);
+                long ans;
+
+                ADD_TIME_BLOCK(push) {
+                    push_relabel<int, long> mf(V);
+                    add_edges(mf, g, cap);
+                    ans = mf.maxflow(s, t);
+                }
+
+                for (int i = 0, S = threads.size(); i < S; i++) {
+                    START(parallel);
+                    parallel_push_relabel<int, long> mf(V);
+                    add_edges(mf, g, cap);
+                    assert(ans == mf.maxflow(s, t, threads[i]));
+                    time_parallel[i] += CUR_TIME(parallel);
+                }
+            }
+
+            table[{V, pV, "push"}] = FORMAT_EACH(push, runs);
+            for (int i = 0, S = threads.size(); i < S; i++) {
+                auto parallel = format_duration(1.0 * time_parallel[i].count() / runs);
+                table[{V, pV, format("parallel-{}", threads[i])}] = parallel;
+            }
+        }
+    }
+
+    print_time_table(table, "Parallel push relabel");
+}
+
 int main() {
     mt.seed(73);
     RUN_BLOCK(stress_test_max_flow());
+    RUN_BLOCK(stress_test_warm_max_flow());
+    RUN_BLOCK(stress_test_grid_max_flow());
     RUN_BLOCK(speed_test_max_flow());
+    RUN_BLOCK(speed_test_warm_max_flow());
+    RUN_BLOCK(speed_test_grid_max_flow());
+    RUN_BLOCK(scaling_test_parallel_push_relabel());
     return 0;
 }
@@ -2,6 +2,32 @@
 #include "../matching/maximum_matching.hpp"
 #include "../lib/bipartite_matching.hpp"
 #include "../matching/hopcroft_karp.hpp"
+#include "../matching/parallel_hopcroft_karp.hpp"
+
+inline namespace detail {
+
+template <typename Matching>
+bool verify_matching(const Matching& mm, const edges_t& g, int M) {
+    set<array<int, 2>> edges(begin(g), end(g));
+    int count = 0;
+    for (int u = 0; u < mm.U; u++) {
+        if (int v = mm.mu[u]; v != -1) {
+            count++;
+            if (!edges.count({u, v}) || mm.mv[v] != u) {
+                return false;
+            }
+        }
+    }
+    for (int v = 0; v < mm.V; v++) {
+        int u = mm.mv[v]; // free vertices of V are -1 too
+        if (u != -1 && (u < 0 || u >= mm.U || mm.mu[u] != v)) {
+            return false;
+        }
+    }
+    return count == M;
+}
+
+} // namespace detail
 
 void unit_test_maximum_matching() {
     edges_t g;
@@ -9,13 +35,15 @@ void unit_test_maximum_matching() {
     g = {{1, 1}, {1, 3}, {2, 4}, {2, 5}, {3, 2}, {3, 3}, {4, 3}, {4, 4}, {5, 3}};
     int mm0 = maximum_matching(6, 6, g).compute();
     int mm1 = hopcroft_karp(6, 6, g).compute();
-    assert(mm0 == 5 && mm1 == 5);
+    int mm2 = parallel_hopcroft_karp(6, 6, g).compute(2);
+    assert(mm0 == 5 && mm1 == 5 && mm2 == 5);
 
     g = {{1, 1}, {1, 4}, {2, 3}, {2, 6}, {2, 7}, {3, 2}, {3, 4}, {3, 5}, {4, 2},
          {4, 7}, {5, 5}, {5, 6}, {5, 7}, {6, 3}, {6, 6}, {7, 6}, {7, 7}};
     mm0 = maximum_matching(8, 8, g).compute();
     mm1 = hopcroft_karp(8, 8, g).compute();
-    assert(mm0 == 7 && mm1 == 7);
+    mm2 = parallel_hopcroft_karp(8, 8, g).compute(2);
+    assert(mm0 == 7 && mm1 == 7 && mm2 == 7);
 }
 
 void stress_test_maximum_matching() {
@@ -38,7 +66,24 @@ void stress_test_maximum_matching() {
         hopcroft_karp hk(U, V, g);
         int m1 = hk.compute();
 
-        assert(M == m0 && M == m1);
+        assert(M == m0 && M == m1 && verify_matching(hk, g, M));
+
+        for (int T : {1, 3}) {
+            parallel_hopcroft_karp phk(U, V, g);
+            int m2 = phk.compute(T);
+            assert(M == m2 && verify_matching(phk, g, M));
+        }
+
+        // plain random graph, the karp-sipser matching is rarely maximum here
+        int S = intd(5, 60)(mt), R = intd(5, 60)(mt);
+        g = random_uniform_bipartite(S, R, reald(0.5, 4.0)(mt) / max(S, R));
+        int m3 = maximum_matching(S, R, g).compute();
+        hopcroft_karp hk2(S, R, g);
+        assert(m3 == hk2.compute() && verify_matching(hk2, g, m3));
+        for (int T : {1, 3}) {
+            parallel_hopcroft_karp phk(S, R, g);
+            assert(m3 == phk.compute(T) && verify_matching(phk, g, m3));
+        }
     }
 }
 
@@ -50,7 +95,7 @@ void speed_test_maximum_matching() {
     map<tuple<pair<int, int>, double, string>, string> table;
 
     auto run = [&](int V, double p, double M) {
-        START_ACC3(gen, mm, hopcroft);
+        START_ACC4(gen, mm, hopcroft, parallel);
 
         LOOP_FOR_DURATION_TRACKED_RUNS (runtime, now, runs) {
             print_time(now, runtime, "speed test maximum matching V,M={},{}", V, V * M);
@@ -70,12 +115,18 @@ void speed_test_maximum_matching() {
             int m1 = hk.compute();
             ADD_TIME(hopcroft);
 
-            assert(m0 == m1);
+            START(parallel);
+            parallel_hopcroft_karp phk(V, V, g);
+            int m2 = phk.compute(4);
+            ADD_TIME(parallel);
+
+            assert(m0 == m1 && m1 == m2);
         }
 
         table[{{V, p}, M, "gen"}] = FORMAT_EACH(gen, runs);
         table[{{V, p}, M, "mm"}] = FORMAT_EACH(mm, runs);
         table[{{V, p}, M, "hopcroft"}] = FORMAT_EACH(hopcroft, runs);
+        table[{{V, p}, M, "parallel x4"}] = FORMAT_EACH(parallel, runs);
     };
 
     for (int V : Vs) {
@@ -89,9 +140,36 @@ void speed_test_maximum_matching() {
     print_time_table(table, "Maximum matching");
 }
 
+void speed_test_large_matching() {
+    const vector<int> threads = {1, 2, 4, 8};
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : {200'000, 1'000'000}) {
+        for (int degree : {2, 5}) {
+            print("speed test large matching V={} degree={}\n", V, degree);
+            int M = V - V / 100;
+            auto g = random_bipartite_matching(V, V, M, degree * V);
+            bipartite_matching_hide_topology(V, V, g);
+            START_ACC(hopcroft);
+            ADD_TIME_BLOCK(hopcroft) { assert(hopcroft_karp(V, V, g).compute() == M); }
+            table[{V, degree, "hopcroft"}] = FORMAT_TIME(hopcroft);
+            for (int T : threads) {
+                START_ACC(parallel);
+                ADD_TIME_BLOCK(parallel) {
+                    assert(parallel_hopcroft_karp(V, V, g).compute(T) == M);
+                }
+                table[{V, degree, format("parallel x{}", T)}] = FORMAT_TIME(parallel);
+            }
+        }
+    }
+
+    print_time_table(table, "Large maximum matching");
+}
+
 int main() {
     RUN_SHORT(unit_test_maximum_matching());
     RUN_BLOCK(stress_test_maximum_matching());
     RUN_BLOCK(speed_test_maximum_matching());
+    RUN_BLOCK(speed_test_large_matching());
     return 0;
 }
@@ -1,5 +1,23 @@
 #include "test_utils.hpp"
 #include "../graphs/min_spanning_forest.hpp"
+#include "../lib/graph_generator.hpp"
+
+inline namespace detail {
+
+// relabel components by their smallest node so different labelings compare equal
+auto normalize_components(vector<int> comp) {
+    int V = comp.size();
+    vector<int> smallest(V, -1);
+    for (int u = 0; u < V; u++) {
+        if (smallest[comp[u]] == -1) {
+            smallest[comp[u]] = u;
+        }
+        comp[u] = smallest[comp[u]];
+    }
+    return comp;
+}
+
+} // namespace detail
 
 void unit_test_min_spanning_forest() {
     edges_t g;
@@ -9,10 +27,82 @@ void unit_test_min_spanning_forest() {
     weight = {1, 4, 3, 4, 2, 4, 5, 4, 7};
     long w0 = min_spanning_forest_kruskal(7, g, weight);
     long w1 = min_spanning_forest_prim(7, g, weight);
-    assert(w0 == 16 && w1 == 16);
+    long w2 = min_spanning_forest_boruvka(7, g, weight);
+    long w3 = min_spanning_forest_boruvka(7, g, weight, 3);
+    assert(w0 == 16 && w1 == 16 && w2 == 16 && w3 == 16);
+}
+
+void stress_test_min_spanning_forest() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (3s, now, runs) {
+        print_time(now, 3s, "stress test msf (runs={})", runs);
+
+        int V = rand_unif<int>(1, 200);
+        double p = rand_unif<double>(0.0, 0.3);
+        int T = rand_unif<int>(1, 4);
+        auto g = random_uniform_undirected(V, p);
+        auto weight = rands_unif<long>(g.size(), 1, 30);
+
+        long w0 = min_spanning_forest_kruskal(V, g, weight);
+        long w1 = min_spanning_forest_boruvka(V, g, weight, T);
+        assert(w0 == w1);
+
+        auto c0 = normalize_components(connected_components(V, g));
+        auto c1 = normalize_components(parallel_connected_components(V, g, T));
+        assert(c0 == c1);
+    }
+}
+
+void scaling_test_min_spanning_forest() {
+    static vector<int> Vs = {10'000, 100'000, 1'000'000};
+    static vector<double> pVs = {4.0, 16.0};
+    static vector<int> threads = {1, 2, 4, 8};
+    const auto duration = 20000ms / (Vs.size() * pVs.size());
+    map<tuple<int, double, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (double pV : pVs) {
+            START_ACC3(kruskal, prim, components);
+            vector<chrono::nanoseconds> time_boruvka(threads.size()), time_cc(threads.size());
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
+                print_time(now, duration, "scaling msf V={} pV={}", V, pV);
+
+                auto g = random_uniform_undirected(V, pV / V);
+                auto weight = rands_unif<long>(g.size(), 1, 1'000'000);
+                long ans;
+
+                ADD_TIME_BLOCK(kruskal) { ans = min_spanning_forest_kruskal(V, g, weight); }
+                ADD_TIME_BLOCK(prim) { assert(ans == min_spanning_forest_prim(V, g, weight)); }
+                ADD_TIME_BLOCK(components) { connected_components(V, g); }
+
+                for (int i = 0, S = threads.size(); i < S; i++) {
+                    START(boruvka);
+                    assert(ans == min_spanning_forest_boruvka(V, g, weight, threads[i]));
+                    time_boruvka[i] += CUR_TIME(boruvka);
+                    START(cc);
+                    parallel_connected_components(V, g, threads[i]);
+                    time_cc[i] += CUR_TIME(cc);
+                }
+            }
+
+            table[{V, pV, "kruskal"}] = FORMAT_EACH(kruskal, runs);
+            table[{V, pV, "prim"}] = FORMAT_EACH(prim, runs);
+            table[{V, pV, "cc"}] = FORMAT_EACH(components, runs);
+            for (int i = 0, S = threads.size(); i < S; i++) {
+                auto boruvka = format_duration(1.0 * time_boruvka[i].count() / runs);
+                auto cc = format_duration(1.0 * time_cc[i].count() / runs);
+                table[{V, pV, format("boruvka-{}", threads[i])}] = boruvka;
+                table[{V, pV, format("cc-{}", threads[i])}] = cc;
+            }
+        }
+    }
+
+    print_time_table(table, "Minimum spanning forest / connected components");
 }
 
 int main() {
     RUN_SHORT(unit_test_min_spanning_forest());
+    RUN_BLOCK(stress_test_min_spanning_forest());
+    RUN_BLOCK(scaling_test_min_spanning_forest());
     return 0;
 }
@@ -130,20 +130,28 @@ struct mincost_circulation_dataset_test_t {
         }
 
         if (V <= 50'000'000) {
-            network_simplex<long, long> netw(V);
-            TIME_BLOCK(network) {
-                for (int e = 0; e < E; e++) {
-                    netw.add(g[e].node[0], g[e].node[1], g[e].lower, g[e].upper,
-                             g[e].cost);
+            using netw_t = network_simplex<long, long>;
+            for (auto rule : {netw_t::BLOCK_SEARCH, netw_t::CANDIDATE_LIST}) {
+                netw_t netw(V);
+                START_ACC(network);
+                ADD_TIME_BLOCK(network) {
+                    for (int e = 0; e < E; e++) {
+                        netw.add(g[e].node[0], g[e].node[1], g[e].lower, g[e].upper,
+                                 g[e].cost);
+                    }
+                    for (int u = 0; u < V; u++) {
+                        netw.add_supply(u, supply[u]);
+                    }
+                    netw_feasible = netw.mincost_circulation(rule);
+                    netw_cost = netw.get_circulation_cost();
                 }
-                for (int u = 0; u < V; u++) {
-                    netw.add_supply(u, supply[u]);
+                if (netw_feasible) {
+                    netw.verify();
                 }
-                netw_feasible = netw.mincost_circulation();
-                netw_cost = netw.get_circulation_cost();
-            }
-            if (netw_feasible) {
-                netw.verify();
+                double pivots_per_sec = netw.pivots / max(1e-9 * TIME_NS(network), 1e-9);
+                printcl("\t{}: {} pivots, {:.0f} pivots/s, {}\n",
+                        rule == netw_t::BLOCK_SEARCH ? "block" : "candidate",
+                        netw.pivots, pivots_per_sec, FORMAT_TIME(network));
             }
         }
 
@@ -225,10 +233,13 @@ void random_stress_test_mincost_circulation() {
             netw.add(u, v, lower[e], upper[e], cost[e]);
         }
 
+        auto netw2 = netw;
         bool feasible = netw.mincost_circulation();
+        bool feasible2 = netw2.mincost_circulation(netw2.CANDIDATE_LIST);
 
-        assert(feasible);
-        netw.verify();
+        assert(feasible && feasible2);
+        netw.verify(), netw2.verify();
+        assert(netw.get_circulation_cost() == netw2.get_circulation_cost());
     }
 }
 
@@ -254,7 +265,7 @@ void speed_test_mincost_circulation() {
         if (p >= 1.0)
             return;
 
-        START_ACC(network);
+        START_ACC2(network, candidate);
 
         LOOP_FOR_DURATION_TRACKED_RUNS (duration, now, runs) {
             print_time(now, duration, "speed test mincost circ. V,p,a={},{:.3f},{:.3f}",
@@ -276,10 +287,23 @@ void speed_test_mincost_circulation() {
                 ans[0] = netw.get_circulation_cost();
             }
 
-            // assert(ans[0] == ans[1]);
+            ADD_TIME_BLOCK(candidate) {
+                network_simplex<int, long, long> netw(V);
+                for (int e = 0; e < E; e++) {
+                    netw.add(g[e][0], g[e][1], lower[e], upper[e], cost[e]);
+                }
+                for (int u = 0; u < V; u++) {
+                    netw.add_supply(u, supply[u]);
+                }
+                netw.mincost_circulation(netw.CANDIDATE_LIST);
+                ans[1] = netw.get_circulation_cost();
+            }
+
+            assert(ans[0] == ans[1]);
         }
 
         table[{{V, alpha}, pV, "network"}] = FORMAT_EACH(network, runs);
+        table[{{V, alpha}, pV, "candidate"}] = FORMAT_EACH(candidate, runs);
     };
 
     for (int V : Vs) {
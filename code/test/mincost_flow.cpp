@@ -1,5 +1,7 @@
 #include "test_utils.hpp"
 #include "../flow/mincost_edmonds_karp.hpp"
+#include "../flow/mincost_push_relabel.hpp"
+#include "../flow/network_simplex.hpp"
 #include "../lib/graph_generator.hpp"
 
 const string DATASET_FILE = "datasets/mincost_flow.txt";
@@ -14,6 +16,27 @@ void add_edges(MCF& mcf, const edges_t& g, const Caps& caps, const Costs& costs)
     }
 }
 
+auto random_mincost_instance(int V, double p, int maxcap, int maxcost) {
+    auto [g, s, t] = random_geometric_flow_connected(V, p, p / 2, 0.0);
+    g.erase(remove_if(begin(g), end(g), [](auto uv) { return uv[0] == uv[1]; }), end(g));
+    auto cap = rands_unif<int>(g.size(), 1, maxcap);
+    auto cost = rands_unif<int>(g.size(), 0, maxcost);
+    return make_tuple(g, s, t, cap, cost);
+}
+
+// mincost circulation with F units from s to t on network simplex
+long simplex_cost(int V, const edges_t& g, const vector<int>& cap,
+                  const vector<int>& cost, int s, int t, long F) {
+    network_simplex<long, long> netw(V);
+    for (int e = 0, E = g.size(); e < E; e++) {
+        netw.add(g[e][0], g[e][1], 0, cap[e], cost[e]);
+    }
+    netw.add_supply(s, F), netw.add_demand(t, F);
+    bool feasible = netw.mincost_circulation();
+    assert(feasible);
+    return netw.get_circulation_cost();
+}
+
 } // namespace detail
 
 /**
@@ -156,8 +179,129 @@ void speed_test_mincost_flow() {
     print_time_table(table, "Mincost maxflow");
 }
 
+void stress_test_mincost_flow() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test mincost flow (runs={})", runs);
+
+        int V = intd(2, 40)(mt);
+        auto [g, s, t, cap, cost] = random_mincost_instance(V, 4.0 / V, 100, 50);
+        int E = g.size();
+
+        mincost_push_relabel<long, long> g1(V), g2(V);
+        add_edges(g1, g, cap, cost);
+        add_edges(g2, g, cap, cost);
+
+        for (int round = 0; round < 6; round++) {
+            if (round > 0) {
+                for (int k = intd(1, 5)(mt); k > 0 && E > 0; k--) {
+                    int e = intd(0, E - 1)(mt);
+                    if (boold(0.5)(mt)) {
+                        cost[e] = intd(0, 50)(mt);
+                        g1.set_cost(e, cost[e]), g2.set_cost(e, cost[e]);
+                    } else {
+                        cap[e] = intd(0, 100)(mt);
+                        g1.set_capacity(e, cap[e]), g2.set_capacity(e, cap[e]);
+                    }
+                }
+            }
+
+            mincost_edmonds_karp<int, int, long, long> mek(V);
+            mincost_edmonds_karp<int, int, long, long, radix_int_heap> radix(V);
+            mincost_edmonds_karp<int, int, long, long, bucket_int_heap> bucket(V);
+            for (int e = 0; e < E; e++) {
+                if (cap[e] > 0) {
+                    mek.add(g[e][0], g[e][1], cap[e], cost[e]);
+                    radix.add(g[e][0], g[e][1], cap[e], cost[e]);
+                    bucket.add(g[e][0], g[e][1], cap[e], cost[e]);
+                }
+            }
+            auto [F, ans] = mek.mincost_flow(s, t);
+            assert(ans == simplex_cost(V, g, cap, cost, s, t, F));
+            // one heap is reused by every dijkstra of the run
+            assert(radix.mincost_flow(s, t) == make_pair(F, ans));
+            assert(bucket.mincost_flow(s, t) == make_pair(F, ans));
+
+            g1.set_supply(s, F), g1.set_supply(t, -F);
+            g2.set_supply(s, F), g2.set_supply(t, -F);
+            long c1 = round == 0 ? g1.mincost_circulation() : g1.reoptimize();
+            long c2 = round == 0 ? g2.mincost_circulation(3) : g2.reoptimize(3);
+            assert(ans == c1 && ans == c2);
+
+            for (int e = 0; e < E; e++) {
+                assert(0 <= g1.get_flow(e) && g1.get_flow(e) <= cap[e]);
+            }
+            mincost_push_relabel<long, long> cold(V);
+            add_edges(cold, g, cap, cost);
+            cold.set_supply(s, F), cold.set_supply(t, -F);
+            assert(ans == cold.mincost_circulation());
+        }
+    }
+}
+
+void speed_test_cost_scaling() {
+    static vector<int> Vs = {300, 1000, 3000, 10000};
+    static vector<int> edits = {1, 10, 100};
+    const auto runtime = 40000ms / (Vs.size() * edits.size());
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (int K : edits) {
+            START_ACC4(edmonds, simplex, push, push_warm);
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (runtime, now, runs) {
+                print_time(now, runtime, "speed test cost scaling V={} K={}", V, K);
+
+                auto [g, s, t, cap, cost] =
+                    random_mincost_instance(V, 5.0 / V, 100'000, 10'000);
+                int E = g.size();
+
+                mincost_push_relabel<long, long> warm(V);
+                add_edges(warm, g, cap, cost);
+                mincost_edmonds_karp<int, int, long, long> mek0(V);
+                add_edges(mek0, g, cap, cost);
+                auto [F, c0] = mek0.mincost_flow(s, t);
+                warm.set_supply(s, F), warm.set_supply(t, -F);
+                assert(c0 == warm.mincost_circulation());
+
+                for (int k = 0; k < K; k++) {
+                    int e = intd(0, E - 1)(mt);
+                    cost[e] = intd(0, 10'000)(mt);
+                    warm.set_cost(e, cost[e]);
+                }
+                long ans;
+
+                ADD_TIME_BLOCK(edmonds) {
+                    mincost_edmonds_karp<int, int, long, long> mek(V);
+                    add_edges(mek, g, cap, cost);
+                    ans = mek.mincost_flow(s, t).second;
+                }
+                ADD_TIME_BLOCK(simplex) {
+                    assert(ans == simplex_cost(V, g, cap, cost, s, t, F));
+                }
+                ADD_TIME_BLOCK(push) {
+                    mincost_push_relabel<long, long> mf(V);
+                    add_edges(mf, g, cap, cost);
+                    mf.set_supply(s, F), mf.set_supply(t, -F);
+                    assert(ans == mf.mincost_circulation());
+                }
+                ADD_TIME_BLOCK(push_warm) { assert(ans == warm.reoptimize()); }
+            }
+
+            table[{V, K, "edmonds"}] = FORMAT_EACH(edmonds, runs);
+            table[{V, K, "simplex"}] = FORMAT_EACH(simplex, runs);
+            table[{V, K, "push"}] = FORMAT_EACH(push, runs);
+            table[{V, K, "push warm"}] = FORMAT_EACH(push_warm, runs);
+            table[{V, K, "warm x"}] = FORMAT_RATIO(push, push_warm);
+        }
+    }
+
+    print_time_table(table, "Cost scaling mincost flow (V, edits)");
+}
+
 int main() {
     RUN_BLOCK(dataset_test_mincost_flow());
+    RUN_BLOCK(stress_test_mincost_flow());
     RUN_BLOCK(speed_test_mincost_flow());
+    RUN_BLOCK(speed_test_cost_scaling());
     return 0;
 }
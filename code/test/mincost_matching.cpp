@@ -1,5 +1,6 @@
 #include "test_utils.hpp"
 #include "../lib/bipartite_matching.hpp"
+#include "../matching/dense_assignment.hpp"
 #include "../matching/mincost_hungarian.hpp"
 
 inline namespace detail {
@@ -12,6 +13,19 @@ void add_edges(MCBM& mcbm, const edges_t& g, const Costs& costs) {
     }
 }
 
+template <typename Dense>
+bool verify_assignment(const Dense& da, long cost) {
+    vector<bool> taken(da.W);
+    for (int u = 0; u < da.W; u++) {
+        int v = da.m[0][u];
+        if (v < 0 || v >= da.W || taken[v] || da.m[1][v] != u) {
+            return false;
+        }
+        taken[v] = true;
+    }
+    return cost == da.total_cost(false);
+}
+
 } // namespace detail
 
 void unit_test_mincost_hungarian() {
@@ -39,6 +53,35 @@ void unit_test_mincost_hungarian() {
     add_edges(mm3, g, cost);
     c = mm3.mincost_max_matching();
     assert(c == 407);
+
+    dense_assignment<int, long> da(3, 3);
+    add_edges(da, g, cost);
+    assert(da.lapjv() == 407 && da.auction() == 407 && da.auction(2) == 407);
+}
+
+void stress_test_dense_assignment() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test dense assignment (runs={})", runs);
+
+        int U = intd(1, 40)(mt), V = intd(1, 40)(mt);
+        int maxc = vector<int>{3, 100, 1'000'000}[intd(0, 2)(mt)];
+        mincost_hungarian<int, long> hung(U, V);
+        dense_assignment<int, long> da(U, V);
+        for (int u = 0; u < U; u++) {
+            for (int v = 0; v < V; v++) {
+                int c = intd(0, maxc)(mt);
+                hung.add(u, v, c), da.add(u, v, c);
+            }
+        }
+        if (U != V) {
+            hung.pad_complete(0);
+        }
+        long want = hung.mincost_max_matching();
+        assert(da.lapjv() == want && verify_assignment(da, want));
+        for (int T : {1, 3}) {
+            assert(da.auction(T) == want && verify_assignment(da, want));
+        }
+    }
 }
 
 void speed_test_mincost_matching() {
@@ -91,8 +134,54 @@ void speed_test_mincost_matching() {
     print_time_table(table, "Hungarian");
 }
 
+void speed_test_dense_assignment() {
+    static vector<int> sizes = {300, 1000, 3000};
+    static vector<int> maxcs = {100, 1'000'000};
+    map<tuple<int, int, string>, string> table;
+
+    auto run = [&](int n, int maxc) {
+        print("speed test dense assignment n={} maxc={}\n", n, maxc);
+        dense_assignment<int, long> da(n, n);
+        for (auto& c : da.cost) {
+            c = intd(0, maxc)(mt);
+        }
+        START_ACC5(hungarian, lapjv, auction1, auction4, auction8);
+        long want;
+        ADD_TIME_BLOCK(lapjv) { want = da.lapjv(); }
+        ADD_TIME_BLOCK(auction1) { assert(want == da.auction(1)); }
+        ADD_TIME_BLOCK(auction4) { assert(want == da.auction(4)); }
+        ADD_TIME_BLOCK(auction8) { assert(want == da.auction(8)); }
+        if (n <= 300) {
+            ADD_TIME_BLOCK(hungarian) {
+                mincost_hungarian<int, long> hung(n, n);
+                for (int u = 0; u < n; u++) {
+                    for (int v = 0; v < n; v++) {
+                        hung.add(u, v, da.cost[u * n + v]);
+                    }
+                }
+                assert(want == hung.mincost_max_matching());
+            }
+            table[{n, maxc, "hungarian"}] = FORMAT_TIME(hungarian);
+        }
+        table[{n, maxc, "lapjv"}] = FORMAT_TIME(lapjv);
+        table[{n, maxc, "auction"}] = FORMAT_TIME(auction1);
+        table[{n, maxc, "auction x4"}] = FORMAT_TIME(auction4);
+        table[{n, maxc, "auction x8"}] = FORMAT_TIME(auction8);
+    };
+
+    for (int n : sizes) {
+        for (int maxc : maxcs) {
+            run(n, maxc);
+        }
+    }
+
+    print_time_table(table, "Dense assignment");
+}
+
 int main() {
     RUN_SHORT(unit_test_mincost_hungarian());
+    RUN_BLOCK(stress_test_dense_assignment());
     RUN_BLOCK(speed_test_mincost_matching());
+    RUN_BLOCK(speed_test_dense_assignment());
     return 0;
 }
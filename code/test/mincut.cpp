@@ -1,5 +1,50 @@
 #include "test_utils.hpp"
 #include "../graphs/mincut.hpp"
+#include "../lib/graph_generator.hpp"
+
+inline namespace detail {
+
+long cut_weight(int V, const edges_t& g, const vector<long>& costs, const cut_t& cut) {
+    vector<bool> side(V);
+    for (int u : cut) {
+        side[u] = true;
+    }
+    long sum = 0;
+    for (int e = 0, E = g.size(); e < E; e++) {
+        sum += side[g[e][0]] != side[g[e][1]] ? costs[e] : 0;
+    }
+    return sum;
+}
+
+bool proper_cut(int V, const cut_t& cut) {
+    int S = set<int>(begin(cut), end(cut)).size();
+    return 0 < S && S < V && S == int(cut.size());
+}
+
+// k random clusters of V/k nodes in a row, consecutive ones joined by light edges
+auto clustered_cut_instance(int V, int k, int degree, int links) {
+    int n = V / k;
+    vector<edges_t> clusters(k);
+    for (auto& cluster : clusters) {
+        cluster = random_exact_undirected_connected(n, min(1L * n * degree / 2,
+                                                            1L * n * (n - 1) / 2));
+    }
+    auto g = merge_graphs_disjoint(clusters);
+    int E = g.size();
+    vector<long> costs(E);
+    for (auto& c : costs) {
+        c = intd(1, 100)(mt);
+    }
+    for (int i = 0; i + 1 < k; i++) {
+        for (int j = 0; j < links; j++) {
+            g.push_back({i * n + intd(0, n - 1)(mt), (i + 1) * n + intd(0, n - 1)(mt)});
+            costs.push_back(intd(1, 10)(mt));
+        }
+    }
+    return make_pair(g, costs);
+}
+
+} // namespace detail
 
 // clang-format off
 void unit_test_stoer_wagner() {
@@ -12,8 +57,13 @@ void unit_test_stoer_wagner() {
          {2, 6}, {3, 6}, {3, 7}, {4, 5}, {5, 6}, {6, 7}};
     cost = {2, 3, 3, 2, 2, 4, 2, 2, 2, 3, 1, 3};
     tie(ans, cut) = stoer_wagner(8, g, cost);
-    print("stoer_wagner 1 -- mincut: {}, ({})\n", ans, cut);
+    print("stoer_wagner 1 -- mincut: {}, ({})\n", ans, fmt::join(cut, " "));
     assert(ans == 4);
+    tie(ans, cut) = nagamochi_ibaraki(8, g, cost);
+    print("nagamochi_ibaraki 1 -- mincut: {}, ({})\n", ans, fmt::join(cut, " "));
+    assert(ans == 4 && cut_weight(8, g, cost, cut) == 4);
+    tie(ans, cut) = viecut(8, g, cost, 2, 0);
+    assert(ans >= 4 && cut_weight(8, g, cost, cut) == ans);
 
     tie(ans, cut) = stoer_wagner(5, {
         {0, 130, 17, 12, 240},
@@ -22,12 +72,113 @@ void unit_test_stoer_wagner() {
         {12, 29, 150, 0, 210},
         {240, 24, 32, 210, 0},
     });
-    print("stoer_wagner 2 -- mincut: {}, ({})\n", ans, cut);
+    print("stoer_wagner 2 -- mincut: {}, ({})\n", ans, fmt::join(cut, " "));
     assert(ans == 382);
+
+    // parallel edges 1-2 must be summed before the triangle test
+    g = {{0, 1}, {0, 2}, {0, 3}, {0, 4}, {3, 4}, {1, 5}, {2, 5}};
+    cost = {1, 1, 3, 2, 10, 10, 10};
+    for (int i = 0; i < 10; i++) {
+        g.push_back({1, 2}), cost.push_back(10);
+    }
+    assert(stoer_wagner(6, g, cost).first == 2);
+    for (bool reduce : {false, true}) {
+        tie(ans, cut) = nagamochi_ibaraki(6, g, cost, reduce);
+        assert(ans == 2 && cut_weight(6, g, cost, cut) == 2);
+    }
+    tie(ans, cut) = viecut(6, g, cost);
+    assert(ans == 2 && cut_weight(6, g, cost, cut) == 2);
 }
 // clang-format on
 
+void stress_test_mincut() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (8s, now, runs) {
+        print_time(now, 8s, "stress test mincut (runs={})", runs);
+
+        int V = intd(2, 40)(mt);
+        int E = intd(0, min(V * (V - 1) / 2, 5 * V))(mt);
+        auto g = random_exact_undirected(V, E);
+        for (int k = E ? intd(0, E)(mt) : 0; k > 0; k--) {
+            g.push_back(g[intd(0, E - 1)(mt)]); // parallel edges
+        }
+        E = g.size();
+        vector<long> costs(E);
+        int maxw = intd(1, 30)(mt);
+        for (auto& c : costs) {
+            c = intd(1, maxw)(mt);
+        }
+
+        vector<vector<long>> matrix(V, vector<long>(V));
+        for (int e = 0; e < E; e++) {
+            auto [u, v] = g[e];
+            matrix[u][v] += costs[e], matrix[v][u] += costs[e];
+        }
+        auto [exact, exact_cut] = stoer_wagner(V, matrix);
+        assert(exact == 0 || exact == stoer_wagner(V, g, costs).first); // needs connected
+
+        for (bool reduce : {false, true}) {
+            auto [ans, cut] = nagamochi_ibaraki(V, g, costs, reduce);
+            assert(ans == exact && proper_cut(V, cut));
+            assert(cut_weight(V, g, costs, cut) == ans);
+        }
+        for (int T : {1, 3}) {
+            for (int exact_size : {0, 10, 50}) {
+                auto [ans, cut] = viecut(V, g, costs, T, exact_size);
+                assert(ans >= exact && proper_cut(V, cut));
+                assert(cut_weight(V, g, costs, cut) == ans);
+                assert(exact_size < V || ans == exact);
+            }
+        }
+    }
+}
+
+void speed_test_mincut() {
+    map<tuple<string, int, string>, stringable> table;
+
+    auto run = [&](const string& name, int V, int k, int degree, bool with_sw,
+                   const vector<int>& threads) {
+        print("speed test mincut {} V={}\n", name, V);
+        auto [g, costs] = clustered_cut_instance(V, k, degree, 3);
+        V = V / k * k;
+        START_ACC3(sw, ni, ni_reduced);
+
+        long ans = 0;
+        ADD_TIME_BLOCK(ni) { ans = nagamochi_ibaraki(V, g, costs, false).first; }
+        ADD_TIME_BLOCK(ni_reduced) {
+            assert(ans == nagamochi_ibaraki(V, g, costs, true).first);
+        }
+        if (with_sw) {
+            ADD_TIME_BLOCK(sw) { assert(ans == stoer_wagner(V, g, costs).first); }
+            table[{name, V, "stoer-wagner"}] = FORMAT_TIME(sw);
+        }
+        table[{name, V, "E"}] = g.size();
+        table[{name, V, "mincut"}] = ans;
+        table[{name, V, "noi"}] = FORMAT_TIME(ni);
+        table[{name, V, "noi+pr"}] = FORMAT_TIME(ni_reduced);
+        for (int T : threads) {
+            START_ACC(vc);
+            long upper = 0;
+            ADD_TIME_BLOCK(vc) { upper = viecut(V, g, costs, T).first; }
+            table[{name, V, format("viecut x{}", T)}] = FORMAT_TIME(vc);
+            table[{name, V, format("viecut x{} excess", T)}] = upper - ans;
+        }
+    };
+
+    for (int V : {500, 2000}) {
+        run("random", V, 1, 10, true, {1});
+        run("2 clusters", V, 2, 10, true, {1});
+    }
+    for (int V : {100'000, 1'000'000}) {
+        run("random", V, 1, 10, false, {1, 4});
+        run("4 clusters", V, 4, 20, false, {1, 4});
+    }
+
+    print_time_table(table, "Minimum cut");
+}
+
 int main() {
     RUN_SHORT(unit_test_stoer_wagner());
+    RUN_BLOCK(stress_test_mincut());
+    RUN_BLOCK(speed_test_mincut());
     return 0;
 }
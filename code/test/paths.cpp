@@ -1,7 +1,161 @@
 #include "test_utils.hpp"
 #include "../graphs/shortest_paths.hpp"
+#include "../graphs/p2p_query_engine.hpp"
 #include "../lib/graph_generator.hpp"
 
+template <typename T>
+auto flatten(const vector<vector<T>>& mat) {
+    vector<T> flat;
+    for (const auto& row : mat) {
+        flat.insert(end(flat), begin(row), end(row));
+    }
+    return flat;
+}
+
+void stress_test_all_shortest_paths() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test all shortest paths (runs={})", runs);
+
+        int V = intd(1, 150)(mt);
+        double p = uniform_real_distribution<double>(0.0, 1.0)(mt);
+        auto g = random_uniform_directed(V, p);
+
+        // negative costs without negative cycles: reduced costs of random potentials
+        auto pi = rands_unif<int>(V, 0, 1000);
+        vector<vector<pair<int, long>>> adj(V);
+        for (auto [u, v] : g) {
+            adj[u].emplace_back(v, intd(0, 1000)(mt) + pi[u] - pi[v]);
+        }
+
+        int T = intd(1, 3)(mt);
+        auto d1 = flatten(floyd_warshall(adj));
+        auto d2 = floyd_warshall_blocked(adj, T);
+        auto d3 = johnsons(adj, T);
+        assert(d1 == d2 && d1 == d3);
+    }
+}
+
+void stress_test_delta_stepping() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test delta stepping (runs={})", runs);
+
+        int V = intd(1, 300)(mt);
+        double p = uniform_real_distribution<double>(0.0, 8.0 / V)(mt);
+        int maxw = intd(0, 1000)(mt);
+        auto g = random_uniform_directed(V, min(p, 1.0));
+
+        vector<vector<pair<int, long>>> adj(V);
+        for (auto [u, v] : g) {
+            adj[u].emplace_back(v, intd(0, maxw)(mt));
+        }
+
+        int s = intd(0, V - 1)(mt);
+        double delta = boold(0.5)(mt) ? 0.0 : intd(1, 2000)(mt);
+        auto d1 = dijkstra(s, adj);
+        auto d2 = delta_stepping(s, adj, 1, delta);
+        auto d3 = delta_stepping(s, adj, 3, delta);
+        assert(d1 == d2 && d1 == d3);
+    }
+}
+
+void stress_test_p2p_query_engine() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test p2p query engine (runs={})", runs);
+
+        int V = intd(1, 200)(mt);
+        bool undirected = boold(0.5)(mt);
+        int E = intd(V - 1, min(3L * V, 1L * V * (V - 1) / 2))(mt);
+        auto g = undirected ? random_exact_undirected_connected(V, E)
+                            : random_uniform_directed(V, min(4.0 / V, 1.0));
+
+        vector<vector<pair<int, long>>> adj(V);
+        for (auto [u, v] : g) {
+            int w = intd(0, 100)(mt);
+            adj[u].emplace_back(v, w);
+            if (undirected) {
+                adj[v].emplace_back(u, w);
+            }
+        }
+
+        p2p_query_engine<long> engine(adj);
+        if (undirected) {
+            engine.preprocess_landmarks(intd(1, 8)(mt));
+        }
+        for (int q = 0; q < 30; q++) {
+            int s = intd(0, V - 1)(mt), t = intd(0, V - 1)(mt);
+            auto dist = dijkstra(s, adj);
+            long ans = dist[t] >= numeric_limits<long>::max() / 2 ? engine.inf : dist[t];
+            assert(ans == engine.unidirectional(s, t));
+            assert(ans == engine.bidirectional(s, t));
+            if (undirected) {
+                assert(ans == engine.alt(s, t));
+            }
+        }
+    }
+}
+
+void speed_test_p2p_query_engine() {
+    constexpr int Q = 100'000, W = 100;
+    intd weightd(1, 10'000);
+    map<pair<string, string>, stringable> table;
+
+    auto run = [&](const string& name, int V, const edges_t& g) {
+        vector<vector<pair<int, long>>> adj(V);
+        for (auto [u, v] : g) {
+            int w = weightd(mt);
+            adj[u].emplace_back(v, w);
+            adj[v].emplace_back(u, w);
+        }
+        p2p_query_engine<long> engine(adj);
+        TIME_BLOCK(landmarks) { engine.preprocess_landmarks(16); }
+
+        vector<array<int, 2>> queries(Q);
+        for (auto& [s, t] : queries) {
+            s = intd(0, V - 1)(mt), t = intd(0, V - 1)(mt);
+        }
+        vector<long> ans(Q);
+
+        // the first method measured is alt over all queries, it records the answers
+        auto measure = [&](const string& method, int N, auto&& query) {
+            vector<double> latency(N);
+            long settled = 0;
+            for (int i = 0; i < N; i++) {
+                auto [s, t] = queries[i];
+                auto start = chrono::steady_clock::now();
+                long d = query(s, t);
+                latency[i] = (chrono::steady_clock::now() - start).count();
+                settled += engine.settled;
+                if (method == "alt") {
+                    ans[i] = d;
+                }
+                assert(ans[i] == d);
+            }
+            sort(begin(latency), end(latency));
+            string row = name + " " + method;
+            table[{row, "p50"}] = format_duration(latency[N / 2]);
+            table[{row, "p90"}] = format_duration(latency[N * 9 / 10]);
+            table[{row, "p99"}] = format_duration(latency[N * 99 / 100]);
+            if (method != "fresh dijkstra") {
+                table[{row, "settled"}] = settled / N;
+            }
+        };
+
+        auto uni = [&](int s, int t) { return engine.unidirectional(s, t); };
+        auto bi = [&](int s, int t) { return engine.bidirectional(s, t); };
+        auto alt = [&](int s, int t) { return engine.alt(s, t); };
+        auto fresh = [&](int s, int t) { return dijkstra(s, adj)[t]; };
+        measure("alt", Q, alt);
+        measure("bidirectional", Q / 10, bi);
+        measure("unidirectional", Q / 10, uni);
+        measure("fresh dijkstra", Q / 100, fresh);
+    };
+
+    run("grid", W * W, grid_graph(W, W));
+    run("random", W * W, random_exact_undirected_connected(W * W, 3 * W * W));
+
+    print_time_table(table, "Point to point queries");
+}
+
 void speed_test_positive_shortest_paths() {
     vector<int> Vs = {100, 1000, 5000, 15000};
     vector<int> Es = {2, 3, 5, 10};
@@ -10,7 +164,7 @@ void speed_test_positive_shortest_paths() {
     map<tuple<int, int, string>, string> table;
 
     auto run = [&](int V, int E) {
-        START_ACC3(dijkstra, spfa, bellman);
+        START_ACC4(dijkstra, spfa, bellman, delta);
 
         LOOP_FOR_DURATION_TRACKED_RUNS (runtime, now, runs) {
             print_time(now, runtime, "stress test paths V,E={},{}", V, V * E);
@@ -35,12 +189,17 @@ void speed_test_positive_shortest_paths() {
             auto d3 = bellman_ford(0, adj);
             ADD_TIME(bellman);
 
-            assert(d1 == d2 && d1 == d3);
+            START(delta);
+            auto d4 = delta_stepping(0, adj);
+            ADD_TIME(delta);
+
+            assert(d1 == d2 && d1 == d3 && d1 == d4);
         }
 
         table[{V, E, "dijkstra"}] = FORMAT_EACH(dijkstra, runs);
         table[{V, E, "spfa"}] = FORMAT_EACH(spfa, runs);
         table[{V, E, "bellman"}] = FORMAT_EACH(bellman, runs);
+        table[{V, E, "delta"}] = FORMAT_EACH(delta, runs);
     };
 
     for (int V : Vs) {
@@ -52,6 +211,57 @@ void speed_test_positive_shortest_paths() {
     print_time_table(table, "Shortest paths positive");
 }
 
+void speed_test_delta_stepping() {
+    vector<int> Vs = {250'000, 1'000'000};
+    vector<int> threads = {1, 2, 4, 8};
+    intd weightd(1, 10'000);
+    const auto runtime = 30000ms / (2 * Vs.size());
+    map<tuple<string, int, string>, stringable> table;
+
+    auto run = [&](const string& name, int V, const edges_t& g) {
+        vector<vector<pair<int, int>>> adj(V);
+        for (auto [u, v] : g) {
+            int w = weightd(mt);
+            adj[u].emplace_back(v, w);
+            adj[v].emplace_back(u, w);
+        }
+        START_ACC(dijkstra);
+        vector<chrono::nanoseconds> times(threads.size());
+
+        LOOP_FOR_DURATION_TRACKED_RUNS (runtime, now, runs) {
+            print_time(now, runtime, "speed test delta stepping {} V={}", name, V);
+            int s = intd(0, V - 1)(mt);
+
+            START(dijkstra);
+            auto d1 = dijkstra(s, adj);
+            ADD_TIME(dijkstra);
+
+            for (int i = 0, N = threads.size(); i < N; i++) {
+                START(delta);
+                auto d2 = delta_stepping(s, adj, threads[i]);
+                times[i] += CUR_TIME(delta);
+                assert(d1 == d2);
+            }
+        }
+
+        table[{name, V, "dijkstra"}] = FORMAT_EACH(dijkstra, runs);
+        for (int i = 0, N = threads.size(); i < N; i++) {
+            auto time_delta = times[i];
+            string T = format("T={}", threads[i]);
+            table[{name, V, "delta " + T}] = FORMAT_EACH(delta, runs);
+            table[{name, V, "x " + T}] = FORMAT_RATIO(dijkstra, delta);
+        }
+    };
+
+    for (int V : Vs) {
+        int W = sqrt(V);
+        run("grid", W * W, grid_graph(W, W));
+        run("random", V, random_exact_undirected_connected(V, 4 * V));
+    }
+
+    print_time_table(table, "Delta stepping");
+}
+
 void speed_test_all_positive_shortest_paths() {
     vector<int> Vs = {50, 100, 200, 400, 800};
     vector<int> Es = {2, 3, 5, 8, 12};
@@ -60,7 +270,7 @@ void speed_test_all_positive_shortest_paths() {
     map<tuple<int, int, string>, string> table;
 
     auto run = [&](int V, int E) {
-        START_ACC3(johnsons, floyd, dijkstra);
+        START_ACC4(johnsons, floyd, dijkstra, blocked);
 
         LOOP_FOR_DURATION_TRACKED_RUNS (runtime, now, runs) {
             print_time(now, runtime, "stress test all paths V,E={},{}", V, V * E);
@@ -85,12 +295,17 @@ void speed_test_all_positive_shortest_paths() {
             auto d3 = dijkstra_all(adj);
             ADD_TIME(dijkstra);
 
-            assert(d1 == d2);
+            START(blocked);
+            auto d4 = floyd_warshall_blocked(adj);
+            ADD_TIME(blocked);
+
+            assert(d1 == flatten(d2) && d1 == d3 && d1 == d4);
         }
 
         table[{V, E, "johnsons"}] = FORMAT_EACH(johnsons, runs);
         table[{V, E, "floyd"}] = FORMAT_EACH(floyd, runs);
         table[{V, E, "dijkstra"}] = FORMAT_EACH(dijkstra, runs);
+        table[{V, E, "blocked"}] = FORMAT_EACH(blocked, runs);
     };
 
     for (int V : Vs) {
@@ -102,8 +317,67 @@ void speed_test_all_positive_shortest_paths() {
     print_time_table(table, "Shortest paths positive");
 }
 
+void speed_test_parallel_all_shortest_paths() {
+    vector<int> Vs = {500, 1000, 2000};
+    vector<int> threads = {1, 4};
+    intd weightd(1, 10'000);
+    const auto runtime = 30000ms / (Vs.size() * threads.size());
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (int T : threads) {
+            START_ACC4(johnsons, floyd, dijkstra, blocked);
+
+            LOOP_FOR_DURATION_TRACKED_RUNS (runtime, now, runs) {
+                print_time(now, runtime, "speed test parallel all paths V={} T={}", V, T);
+                auto dg = random_exact_undirected_connected(V, 5 * V);
+
+                vector<vector<pair<int, long>>> adj(V);
+                for (auto [u, v] : dg) {
+                    int w = weightd(mt);
+                    adj[u].emplace_back(v, w);
+                    adj[v].emplace_back(u, w);
+                }
+
+                START(johnsons);
+                auto d1 = johnsons(adj, T);
+                ADD_TIME(johnsons);
+
+                START(dijkstra);
+                auto d3 = dijkstra_all(adj, T);
+                ADD_TIME(dijkstra);
+
+                START(blocked);
+                auto d4 = floyd_warshall_blocked(adj, T);
+                ADD_TIME(blocked);
+
+                if (V <= 1000 && T == 1) {
+                    START(floyd);
+                    auto d2 = floyd_warshall(adj);
+                    ADD_TIME(floyd);
+                    assert(d1 == flatten(d2));
+                }
+                assert(d1 == d3 && d1 == d4);
+            }
+
+            table[{V, T, "johnsons"}] = FORMAT_EACH(johnsons, runs);
+            table[{V, T, "floyd"}] = FORMAT_EACH(floyd, runs);
+            table[{V, T, "dijkstra"}] = FORMAT_EACH(dijkstra, runs);
+            table[{V, T, "blocked"}] = FORMAT_EACH(blocked, runs);
+        }
+    }
+
+    print_time_table(table, "All pairs shortest paths (V, threads)");
+}
+
 int main() {
+    RUN_BLOCK(stress_test_delta_stepping());
+    RUN_BLOCK(stress_test_all_shortest_paths());
+    RUN_BLOCK(stress_test_p2p_query_engine());
     RUN_SHORT(speed_test_positive_shortest_paths());
     RUN_SHORT(speed_test_all_positive_shortest_paths());
+    RUN_SHORT(speed_test_delta_stepping());
+    RUN_SHORT(speed_test_parallel_all_shortest_paths());
+    RUN_SHORT(speed_test_p2p_query_engine());
     return 0;
 }
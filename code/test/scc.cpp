@@ -1,15 +1,41 @@
 #include "test_utils.hpp"
 #include "../lib/graph_formats.hpp"
 #include "../graphs/scc.hpp"
+#include "../lib/graph_generator.hpp"
+
+inline namespace detail {
+
+auto component_sets(const scc_components& scc) {
+    vector<vector<int>> cset(scc.C);
+    for (int c = 0; c < scc.C; c++) {
+        cset[c].assign(begin(scc.nodes) + scc.off[c], begin(scc.nodes) + scc.off[c + 1]);
+    }
+    return cset;
+}
+
+// relabel components by their smallest node, to compare partitions
+auto canonical_cmap(const scc_components& scc) {
+    vector<int> first(scc.C, INT_MAX), canon(scc.cmap.size());
+    for (int u = 0, V = scc.cmap.size(); u < V; u++) {
+        first[scc.cmap[u]] = min(first[scc.cmap[u]], u);
+    }
+    for (int u = 0, V = scc.cmap.size(); u < V; u++) {
+        canon[u] = first[scc.cmap[u]];
+    }
+    return canon;
+}
+
+} // namespace detail
 
 void unit_test_scc() {
     // vertex 0 is completely disconnected
     const int V = 9;
     edges_t g = scan_edges("1,2 2,3 3,1 4,2 4,3 4,6 5,3 5,7 6,4 6,5 7,5 8,6 8,7 8,8");
     auto adj = make_adjacency_lists_directed(V, g);
-    auto [cset, cmap] = build_scc(adj);
-    auto [sccout, sccin] = condensate_scc(adj, cmap);
-    int C = cset.size();
+    auto scc = build_scc(adj);
+    auto cset = component_sets(scc);
+    auto [sccout, sccin] = condensate_scc(adj, scc.cmap);
+    int C = scc.C;
 
     print("components #1: {}\n", C);
 
@@ -35,7 +61,100 @@ void unit_test_scc() {
     assert(sccout[4] == vi({2, 3}) && sccin[4] == vi());
 }
 
+void unit_test_scc_long_chain() {
+    const int V = 1'000'000;
+    auto adj = make_adjacency_lists_directed(V, path_graph(V));
+    assert(build_scc(adj).C == V);
+    adj[V - 1].push_back(0);
+    assert(build_scc(adj).C == 1);
+}
+
+void stress_test_scc() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test scc (runs={})", runs);
+
+        int V = intd(1, 60)(mt);
+        double p = uniform_real_distribution<double>(0.0, min(3.0 / V, 1.0))(mt);
+        auto adj = make_adjacency_lists_directed(V, random_uniform_directed(V, p));
+
+        vector<bitset<60>> reach(V);
+        for (int u = 0; u < V; u++) {
+            reach[u][u] = true;
+            for (int v : adj[u]) {
+                reach[u][v] = true;
+            }
+        }
+        for (int k = 0; k < V; k++) {
+            for (int u = 0; u < V; u++) {
+                if (reach[u][k]) {
+                    reach[u] |= reach[k];
+                }
+            }
+        }
+
+        auto scc = build_scc(adj);
+        for (int u = 0; u < V; u++) {
+            for (int v = 0; v < V; v++) {
+                bool same = reach[u][v] && reach[v][u];
+                assert(same == (scc.cmap[u] == scc.cmap[v]));
+            }
+            for (int v : adj[u]) {
+                assert(scc.cmap[u] >= scc.cmap[v]); // reverse topological
+            }
+        }
+        for (int c = 0; c < scc.C; c++) {
+            for (int i = scc.off[c]; i < scc.off[c + 1]; i++) {
+                assert(scc.cmap[scc.nodes[i]] == c);
+            }
+        }
+
+        auto canon = canonical_cmap(scc);
+        for (int T : {1, 3}) {
+            for (int cutoff : {0, 20}) {
+                auto par = parallel_scc(adj, T, cutoff);
+                assert(par.C == scc.C && canonical_cmap(par) == canon);
+            }
+        }
+    }
+}
+
+void speed_test_scc() {
+    const vector<int> threads = {1, 2, 4, 8};
+    map<tuple<string, int, string>, stringable> table;
+
+    auto run = [&](const string& name, int V, const edges_t& g) {
+        print("speed test scc {} V={}\n", name, V);
+        auto adj = make_adjacency_lists_directed(V, g);
+        START_ACC(tarjan);
+        ADD_TIME_BLOCK(tarjan) {
+            auto scc = build_scc(adj);
+            table[{name, V, "components"}] = scc.C;
+        }
+        auto canon = canonical_cmap(build_scc(adj));
+        table[{name, V, "pearce"}] = FORMAT_TIME(tarjan);
+        for (int T : threads) {
+            START_ACC(parallel);
+            ADD_TIME_BLOCK(parallel) {
+                auto par = parallel_scc(adj, T);
+                assert(canonical_cmap(par) == canon);
+            }
+            table[{name, V, format("parallel x{}", T)}] = FORMAT_TIME(parallel);
+        }
+    };
+
+    for (int V : {100'000, 1'000'000}) {
+        run("sparse", V, random_exact_directed(V, V));
+        run("giant", V, random_exact_directed(V, 4 * V));
+        run("chain", V, path_graph(V));
+    }
+
+    print_time_table(table, "SCC");
+}
+
 int main() {
     RUN_SHORT(unit_test_scc());
+    RUN_SHORT(unit_test_scc_long_chain());
+    RUN_BLOCK(stress_test_scc());
+    RUN_BLOCK(speed_test_scc());
     return 0;
 }
@@ -15,6 +15,43 @@ bool trips_match(const vector<int>& a, vector<int> b) {
     return a == b;
 }
 
+long trip_cost(const vector<vector<int>>& dist, const vector<int>& path) {
+    int V = dist.size();
+    vector<bool> seen(V);
+    long cost = 0;
+    for (int i = 0; i < V; i++) {
+        assert(0 <= path[i] && path[i] < V && !seen[path[i]]);
+        seen[path[i]] = true, cost += dist[path[i]][path[(i + 1) % V]];
+    }
+    return cost;
+}
+
+long brute_force_tsp(const vector<vector<int>>& dist) {
+    int V = dist.size();
+    vector<int> path(V);
+    iota(begin(path), end(path), 0);
+    long best = LONG_MAX;
+    do {
+        best = min(best, trip_cost(dist, path));
+    } while (next_permutation(begin(path) + 1, end(path)));
+    return best;
+}
+
+auto random_tsp_matrix(int V, int maxc, bool symmetric) {
+    vector<vector<int>> dist(V, vector<int>(V, 0));
+    for (int u = 0; u < V; u++) {
+        for (int v = 0; v < V; v++) {
+            if (u != v && (!symmetric || u < v)) {
+                dist[u][v] = intd(0, maxc)(mt);
+            }
+            if (symmetric && u > v) {
+                dist[u][v] = dist[v][u];
+            }
+        }
+    }
+    return dist;
+}
+
 } // namespace detail
 
 struct exact_tsp_dataset_t {
@@ -41,11 +78,12 @@ struct exact_tsp_dataset_t {
     void run() const {
         vector<int> path;
         long optimum = tsp_held_karp(V, dist, &path);
+        assert(tsp_local_search(V, dist) >= ans);
 
         if (optimum != ans || !trips_match(path, ans_path)) {
             print(" exact tsp -- V={}\n", V);
-            print("   expected: {:>9} | trip: {}\n", ans, ans_path);
-            print("     actual: {:>9} | trip: {}\n", optimum, path);
+            print("   expected: {:>9} | trip: {}\n", ans, seq_to_string(ans_path));
+            print("     actual: {:>9} | trip: {}\n", optimum, seq_to_string(path));
         }
     }
 };
@@ -63,7 +101,65 @@ void dataset_test_exact_tsp() {
     }
 }
 
+void stress_test_exact_tsp() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (5s, now, runs) {
+        print_time(now, 5s, "stress test exact tsp (runs={})", runs);
+
+        int V = intd(1, 9)(mt);
+        int maxc = vector<int>{1, 10, 1000}[intd(0, 2)(mt)];
+        auto dist = random_tsp_matrix(V, maxc, boold(0.5)(mt));
+        long want = brute_force_tsp(dist);
+
+        for (int T : {1, 3}) {
+            vector<int> path;
+            long optimum = tsp_held_karp(V, dist, &path, T);
+            assert(optimum == want && trip_cost(dist, path) == want && path[0] == 0);
+            assert(tsp_held_karp(V, dist, nullptr, T) == want);
+        }
+        vector<int> path;
+        long upper = tsp_local_search(V, dist, &path);
+        assert(upper >= want && trip_cost(dist, path) == upper);
+    }
+}
+
+void speed_test_exact_tsp() {
+    static vector<int> Vs = {16, 18, 20, 22};
+    static vector<int> maxcs = {100, 10'000};
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : Vs) {
+        for (int maxc : maxcs) {
+            print("speed test exact tsp V={} maxc={}\n", V, maxc);
+            auto dist = random_tsp_matrix(V, maxc, true);
+
+            START_ACC4(local, held_karp, held_karp4, path);
+            long upper, optimum;
+            ADD_TIME_BLOCK(local) { upper = tsp_local_search(V, dist); }
+            ADD_TIME_BLOCK(held_karp) { optimum = tsp_held_karp(V, dist, nullptr); }
+            ADD_TIME_BLOCK(held_karp4) {
+                assert(optimum == tsp_held_karp(V, dist, nullptr, 4));
+            }
+            ADD_TIME_BLOCK(path) {
+                vector<int> trip;
+                assert(optimum == tsp_held_karp(V, dist, &trip));
+            }
+            assert(optimum <= upper);
+
+            table[{V, maxc, "local search"}] = FORMAT_TIME(local);
+            double gap = 100.0 * (upper - optimum) / max(optimum, 1L);
+            table[{V, maxc, "gap%"}] = format("{:.1f}", gap);
+            table[{V, maxc, "held-karp"}] = FORMAT_TIME(held_karp);
+            table[{V, maxc, "held-karp x4"}] = FORMAT_TIME(held_karp4);
+            table[{V, maxc, "with path"}] = FORMAT_TIME(path);
+        }
+    }
+
+    print_time_table(table, "Exact TSP");
+}
+
 int main() {
     RUN_BLOCK(dataset_test_exact_tsp());
+    RUN_BLOCK(stress_test_exact_tsp());
+    RUN_BLOCK(speed_test_exact_tsp());
     return 0;
 }
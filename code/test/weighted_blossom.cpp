@@ -0,0 +1,162 @@
+#include "test_utils.hpp"
+#include "../lib/general_matching.hpp"
+#include "../matching/weighted_blossom.hpp"
+
+inline namespace detail {
+
+// min cost perfect matching over subsets, nullopt if there is none
+optional<long> brute_force_perfect_matching(int V, const edges_t& g,
+                                            const vector<long>& cost) {
+    constexpr long inf = LONG_MAX / 2;
+    vector<vector<long>> best(V, vector<long>(V, inf));
+    for (int e = 0, E = g.size(); e < E; e++) {
+        auto [u, v] = g[e];
+        best[u][v] = best[v][u] = min(best[u][v], cost[e]);
+    }
+    vector<long> dp(1 << V, inf);
+    dp[0] = 0;
+    for (int mask = 1; mask < (1 << V); mask++) {
+        int u = __builtin_ctz(mask);
+        for (int v = u + 1; v < V; v++) {
+            int rest = mask ^ (1 << u) ^ (1 << v);
+            if ((mask >> v & 1) && best[u][v] < inf && dp[rest] < inf) {
+                dp[mask] = min(dp[mask], dp[rest] + best[u][v]);
+            }
+        }
+    }
+    return dp.back() < inf ? optional<long>(dp.back()) : nullopt;
+}
+
+template <typename Blossom>
+bool verify_perfect_matching(const Blossom& wb, const edges_t& g,
+                             const vector<long>& cost, long total) {
+    map<pair<int, int>, long> cheapest;
+    for (int e = 0, E = g.size(); e < E; e++) {
+        auto [u, v] = g[e];
+        auto key = minmax(u, v);
+        cheapest[key] = cheapest.count(key) ? min(cheapest[key], cost[e]) : cost[e];
+    }
+    long sum = 0;
+    for (int u = 0; u < wb.V; u++) {
+        int v = wb.mate[u];
+        if (v < 0 || v >= wb.V || v == u || wb.mate[v] != u) {
+            return false;
+        }
+        if (!cheapest.count(minmax(u, v))) {
+            return false;
+        }
+        sum += u < v ? cheapest[minmax(u, v)] : 0;
+    }
+    return sum == total;
+}
+
+auto run_blossom(int V, const edges_t& g, const vector<long>& cost) {
+    weighted_blossom<long> wb(V);
+    for (int e = 0, E = g.size(); e < E; e++) {
+        wb.add(g[e][0], g[e][1], cost[e]);
+    }
+    auto total = wb.mincost_perfect_matching();
+    return make_pair(total, move(wb));
+}
+
+} // namespace detail
+
+void unit_test_weighted_blossom() {
+    // the cheap edges form a 5-cycle, the optimum goes through its blossom
+    edges_t g = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}, {0, 5}, {2, 5}};
+    vector<long> cost = {1, 1, 1, 1, 1, 10, 7};
+    auto [total, wb] = run_blossom(6, g, cost);
+    assert(total == 9 && verify_perfect_matching(wb, g, cost, *total));
+
+    // odd number of vertices, mate is cleared
+    g = {{0, 1}, {1, 2}, {2, 0}}, cost = {1, 2, 3};
+    tie(total, wb) = run_blossom(3, g, cost);
+    assert(!total && wb.mate == vector<int>(3, -1));
+
+    // negative costs
+    g = {{0, 1}, {2, 3}, {0, 2}, {1, 3}}, cost = {-5, -5, -3, -8};
+    assert(run_blossom(4, g, cost).first == -11);
+
+    // a matching of cost -1 is not a failure
+    g = {{0, 1}}, cost = {-1};
+    assert(run_blossom(2, g, cost).first == -1);
+}
+
+void stress_test_weighted_blossom() {
+    LOOP_FOR_DURATION_TRACKED_RUNS (10s, now, runs) {
+        print_time(now, 10s, "stress test weighted blossom (runs={})", runs);
+
+        int V = 2 * intd(1, 7)(mt);
+        double p = reald(0.1, 1.0)(mt);
+        edges_t g;
+        if (boold(0.7)(mt)) {
+            // with M=V/2 the generator only joins even to odd vertices, so add odd cycles
+            g = random_general_matching(V, V / 2, p);
+            for (auto [u, v] : random_uniform_undirected(V, p / 2)) {
+                g.push_back({u, v});
+            }
+            general_matching_hide_topology(V, g);
+        } else {
+            g = random_uniform_undirected(V, p);
+        }
+        vector<long> cost;
+        if (int mode = intd(0, 4)(mt); mode < 3) {
+            long lo = vector<long>{0, 0, -1000}[mode];
+            long hi = vector<long>{3, 1'000'000'000, 1000}[mode];
+            cost = rands_unif<long>(g.size(), lo, hi);
+        } else if (mode == 3) {
+            // distances between random points, these nest blossoms more often
+            auto x = rands_unif<int>(V, 0, 1000), z = rands_unif<int>(V, 0, 1000);
+            for (auto [u, v] : g) {
+                cost.push_back(lround(hypot(x[u] - x[v], z[u] - z[v])));
+            }
+        } else {
+            // cheap edges inside clusters, odd clusters shrink into blossoms
+            auto cluster = rands_unif<int>(V, 0, V / 3);
+            for (auto [u, v] : g) {
+                bool inside = cluster[u] == cluster[v];
+                cost.push_back(inside ? intd(0, 10)(mt) : intd(50, 100)(mt));
+            }
+        }
+
+        auto want = brute_force_perfect_matching(V, g, cost);
+        auto [total, wb] = run_blossom(V, g, cost);
+        assert(total == want);
+        assert(!total || verify_perfect_matching(wb, g, cost, *total));
+    }
+}
+
+void speed_test_weighted_blossom() {
+    map<tuple<int, int, string>, stringable> table;
+
+    for (int V : {10'000, 100'000}) {
+        for (int degree : {2, 10}) {
+            for (long maxc : {100L, 1'000'000'000L}) {
+                print("speed test weighted blossom V={} E={}V c<={}\n", V, degree, maxc);
+                auto g = random_general_matching(V, V / 2, degree * V / 2);
+                for (auto [u, v] : random_exact_undirected(V, degree * V / 2)) {
+                    g.push_back({u, v});
+                }
+                general_matching_hide_topology(V, g);
+                auto cost = rands_unif<long>(g.size(), 0, maxc);
+
+                START_ACC(blossom);
+                ADD_TIME_BLOCK(blossom) {
+                    auto [total, wb] = run_blossom(V, g, cost);
+                    assert(total && verify_perfect_matching(wb, g, cost, *total));
+                }
+                auto name = format("maxc={}", maxc);
+                table[{V, degree, name}] = FORMAT_TIME(blossom);
+            }
+        }
+    }
+
+    print_time_table(table, "Weighted blossom");
+}
+
+int main() {
+    RUN_SHORT(unit_test_weighted_blossom());
+    RUN_BLOCK(stress_test_weighted_blossom());
+    RUN_BLOCK(speed_test_weighted_blossom());
+    return 0;
+}